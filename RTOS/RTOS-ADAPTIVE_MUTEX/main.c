@@ -0,0 +1,301 @@
+/**
+ * @file main.c
+ * @author Tushar Uttekar
+ *
+ * @brief
+ *
+ * This example demonstrates an adaptive mutex for short sections shared between the two cores of the ESP32, such as the
+ * Print_String of example 20. When the holder of a plain mutex runs on the other core the waiter still blocks, which costs a
+ * context switch on the way out and one more when it is woken, a lot more than the few microseconds the holder needs.
+ *
+ * ->The lock is a normal FreeRTOS mutex, the adaptive mutex only keeps a copy of the owner which is cheap to read.
+ * ->A task which finds the mutex taken spins while the owner is the task running on the other core, and takes the mutex as
+ *   soon as it is free. It stops spinning at once when the owner is preempted or blocks, or when the spin budget is used up.
+ * ->After the spin the task blocks on the mutex as usual, so the priority inheritance of the mutex works as before.
+ * ->The spin budget adapts, every acquisition after a spin pulls the budget towards twice the cycles it took, every spin which
+ *   ends in a block shrinks it, so a lock with long holds soon stops spinning and a lock with short holds keeps spinning.
+ *
+ * The benchmark runs two tasks, one on each core, which take the lock and hold it for 1 to 200 microseconds, with the plain mutex
+ * and the adaptive one, and prints the time per acquisition along with how many of them had to block.
+ *
+ * NOTE : The spin is only done for an owner on the other core, on the same core the owner can not make progress while the
+ *        waiter spins. The time to block is counted from the end of the spin.
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "xtensa/core-macros.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "esp_system.h"
+
+#define RTOS                    "FREERTOS"
+
+#define ADAPTIVE_SPIN_MIN       500         //Cycles, also the starting budget
+#define ADAPTIVE_SPIN_MAX       48000       //200 us at 240 MHz
+#define ADAPTIVE_CPU_MHZ        240         //CPU frequency of the default configuration, turns the hold times into cycles
+
+typedef struct
+{
+    SemaphoreHandle_t Handle;
+    volatile TaskHandle_t Owner;
+    volatile uint32_t SpinBudget;
+
+    //Written by the holder only
+    uint32_t Acquires;
+    uint32_t Spun;                          //Acquired during the spin
+    uint32_t Blocked;                       //Had to block on the mutex
+}AdaptiveMutex_t;
+
+/*---------------------------------------------- Adaptive mutex ----------------------------------------------*/
+
+static BaseType_t AdaptiveMutex_Create(AdaptiveMutex_t* Mutex)
+{
+    Mutex->Handle = xSemaphoreCreateMutex();
+    Mutex->Owner = NULL;
+    Mutex->SpinBudget = ADAPTIVE_SPIN_MIN;
+    Mutex->Acquires = 0;
+    Mutex->Spun = 0;
+    Mutex->Blocked = 0;
+
+    return (Mutex->Handle != NULL) ? pdPASS : pdFAIL;
+}
+
+/*True while Owner is the task which runs on the other core*/
+static inline BaseType_t AdaptiveMutex_OwnerRunning(TaskHandle_t Owner)
+{
+    return ((Owner != NULL) && (xTaskGetCurrentTaskHandleForCPU(!xPortGetCoreID()) == Owner)) ? pdTRUE : pdFALSE;
+}
+
+/*Spins while the owner runs on the other core, pdTRUE when the mutex has been taken during the spin*/
+static BaseType_t AdaptiveMutex_Spin(AdaptiveMutex_t* Mutex)
+{
+    uint32_t Start = XTHAL_GET_CCOUNT(), Budget = Mutex->SpinBudget, Spent;
+    int32_t Target;
+    TaskHandle_t Owner;
+
+    for(;;)
+    {
+        Owner = Mutex->Owner;
+        Spent = XTHAL_GET_CCOUNT() - Start;
+
+        //Only a free mutex is worth the kernel call, a mutex taken by someone else makes the try fail cheaply
+        if((Owner == NULL) && (xSemaphoreTake(Mutex->Handle,0) == pdTRUE))
+        {
+            Target = (int32_t)((2 * Spent) + ADAPTIVE_SPIN_MIN);
+            Target = (int32_t)Budget + ((Target - (int32_t)Budget) / 8);
+            Mutex->SpinBudget = (Target > ADAPTIVE_SPIN_MAX) ? ADAPTIVE_SPIN_MAX : (uint32_t)Target;
+            Mutex->Spun++;
+            return pdTRUE;
+        }
+
+        if(Spent >= Budget)
+        {
+            Mutex->SpinBudget = ((Budget - (Budget / 8)) < ADAPTIVE_SPIN_MIN) ? ADAPTIVE_SPIN_MIN : (Budget - (Budget / 8));
+            return pdFALSE;
+        }
+
+        //Owner between the take and the store of Owner reads as NULL, the failed try above covers that
+        if((Owner != NULL) && (AdaptiveMutex_OwnerRunning(Owner) == pdFALSE))
+        {
+            return pdFALSE;
+        }
+    }
+}
+
+static BaseType_t AdaptiveMutex_Take(AdaptiveMutex_t* Mutex, TickType_t Timeout)
+{
+    if(xSemaphoreTake(Mutex->Handle,0) != pdTRUE)
+    {
+        if(Timeout == 0)
+        {
+            return pdFAIL;
+        }
+
+        if(AdaptiveMutex_Spin(Mutex) == pdFALSE)
+        {
+            if(xSemaphoreTake(Mutex->Handle,Timeout) != pdTRUE)
+            {
+                return pdFAIL;
+            }
+
+            Mutex->Blocked++;
+        }
+    }
+
+    Mutex->Owner = xTaskGetCurrentTaskHandle();
+    Mutex->Acquires++;
+
+    return pdPASS;
+}
+
+static BaseType_t AdaptiveMutex_Give(AdaptiveMutex_t* Mutex)
+{
+    Mutex->Owner = NULL;
+
+    return xSemaphoreGive(Mutex->Handle);
+}
+
+/*---------------------------------------------- Benchmark ----------------------------------------------*/
+
+#define BENCH_ACQUIRES          2000        //Per task and run
+
+typedef enum
+{
+    BENCH_PLAIN = 0,
+    BENCH_ADAPTIVE
+}BenchMode_t;
+
+static const uint32_t Bench_HoldUs[] = {1,5,20,50,200};
+
+static SemaphoreHandle_t Bench_Plain;
+static AdaptiveMutex_t Bench_Adaptive;
+static volatile BenchMode_t Bench_Mode;
+static volatile uint32_t Bench_HoldCycles;
+static SemaphoreHandle_t Bench_Start, Bench_Done;
+static volatile uint32_t Bench_Shared;
+
+static inline void Bench_Busy(uint32_t Cycles)
+{
+    uint32_t Start = XTHAL_GET_CCOUNT();
+
+    while((XTHAL_GET_CCOUNT() - Start) < Cycles);
+}
+
+static void BenchWorker_Task(void* pvParameters)
+{
+    uint32_t Loop;
+
+    for(;;)
+    {
+        xSemaphoreTake(Bench_Start,portMAX_DELAY);
+
+        for(Loop = 0; Loop < BENCH_ACQUIRES; Loop++)
+        {
+            if(Bench_Mode == BENCH_PLAIN)
+            {
+                xSemaphoreTake(Bench_Plain,portMAX_DELAY);
+                Bench_Shared++;
+                Bench_Busy(Bench_HoldCycles);
+                xSemaphoreGive(Bench_Plain);
+            }
+            else
+            {
+                AdaptiveMutex_Take(&Bench_Adaptive,portMAX_DELAY);
+                Bench_Shared++;
+                Bench_Busy(Bench_HoldCycles);
+                AdaptiveMutex_Give(&Bench_Adaptive);
+            }
+
+            //Some work outside the lock, as long as the hold, so the two cores keep meeting at the lock
+            Bench_Busy(Bench_HoldCycles);
+        }
+
+        xSemaphoreGive(Bench_Done);
+    }
+}
+
+static void Benchmark_Run(void)
+{
+    static const char* const Modes[] = {"xSemaphoreCreateMutex","AdaptiveMutex"};
+    uint32_t Hold, Mode;
+    int64_t Start, Elapsed;
+
+    printf("%-22s %7s %12s %9s %9s %10s\r\n","Mutex","HoldUs","us/acquire","Blocked","Spun","Budget");
+
+    for(Hold = 0; Hold < (sizeof(Bench_HoldUs) / sizeof(Bench_HoldUs[0])); Hold++)
+    {
+        Bench_HoldCycles = Bench_HoldUs[Hold] * ADAPTIVE_CPU_MHZ;
+
+        for(Mode = BENCH_PLAIN; Mode <= BENCH_ADAPTIVE; Mode++)
+        {
+            Bench_Mode = (BenchMode_t)Mode;
+
+            //A fresh adaptive mutex for every hold time, so the budget is learnt from the start
+            if((Mode == BENCH_ADAPTIVE) && (AdaptiveMutex_Create(&Bench_Adaptive) == pdFAIL))
+            {
+                continue;
+            }
+
+            Start = esp_timer_get_time();
+            xSemaphoreGive(Bench_Start);
+            xSemaphoreGive(Bench_Start);
+            xSemaphoreTake(Bench_Done,portMAX_DELAY);
+            xSemaphoreTake(Bench_Done,portMAX_DELAY);
+            Elapsed = esp_timer_get_time() - Start;
+
+            if(Mode == BENCH_PLAIN)
+            {
+                printf("%-22s %7u %12.2f %9s %9s %10s\r\n",Modes[Mode],Bench_HoldUs[Hold],
+                       (double)Elapsed / (2 * BENCH_ACQUIRES),"-","-","-");
+            }
+            else
+            {
+                printf("%-22s %7u %12.2f %9u %9u %10u\r\n",Modes[Mode],Bench_HoldUs[Hold],
+                       (double)Elapsed / (2 * BENCH_ACQUIRES),Bench_Adaptive.Blocked,Bench_Adaptive.Spun,
+                       Bench_Adaptive.SpinBudget);
+                vSemaphoreDelete(Bench_Adaptive.Handle);
+            }
+        }
+    }
+
+    printf("\r\n");
+}
+
+/*---------------------------------------------- Example 20 ----------------------------------------------*/
+
+static AdaptiveMutex_t Print_Mutex;
+
+static void Print_String(const char* InputString)
+{
+    AdaptiveMutex_Take(&Print_Mutex,portMAX_DELAY);
+
+    printf("%s",InputString);
+
+    AdaptiveMutex_Give(&Print_Mutex);
+}
+
+static void Print_Task(void* pvParameters)
+{
+    char* StringToPrint;
+    const TickType_t BlockTime = 0x20;
+
+    StringToPrint = (char*) pvParameters;
+
+    for(;;)
+    {
+        Print_String(StringToPrint);
+        vTaskDelay((rand() % BlockTime));
+    }
+}
+
+void app_main(void)
+{
+    Bench_Plain = xSemaphoreCreateMutex();
+    Bench_Start = xSemaphoreCreateCounting(2,0);
+    Bench_Done = xSemaphoreCreateCounting(2,0);
+
+    if((Bench_Plain == NULL) || (Bench_Start == NULL) || (Bench_Done == NULL) || (AdaptiveMutex_Create(&Print_Mutex) == pdFAIL))
+    {
+        ESP_LOGE(RTOS,"Mutexes could not be created.\r\n");
+        return;
+    }
+
+    //One worker on each core at the same priority
+    xTaskCreatePinnedToCore(BenchWorker_Task,"Worker0",2048,NULL,5,NULL,0);
+    xTaskCreatePinnedToCore(BenchWorker_Task,"Worker1",2048,NULL,5,NULL,1);
+
+    Benchmark_Run();
+
+    //The two instances of example 20, on different cores so the adaptive mutex can spin
+    xTaskCreatePinnedToCore(Print_Task,"First String",2048,"First Symbols --->  ~!@#$%%^&*()_+\r\n",1,NULL,0);
+    xTaskCreatePinnedToCore(Print_Task,"Second String",2048,"Second Symbols --->  []|;',./?><:'{}\r\n",2,NULL,1);
+}
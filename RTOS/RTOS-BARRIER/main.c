@@ -0,0 +1,439 @@
+/**
+ * @file main.c
+ * @author Tushar Uttekar
+ *
+ * @brief
+ *
+ * This example demonstrates a reusable barrier for any number of participants, as a replacement of the xEventGroupSync of
+ * example 23 in which every task needs a bit of its own (at most 24 participants) and the last task to arrive wakes all the
+ * others inside one critical section of the event group.
+ *
+ * ->Sense reversal, the barrier has a sense which is flipped by the last participant of a phase, every participant waits for the
+ *   sense of its own phase, so the same barrier can be used again right away for the next phase.
+ * ->Combining tree, the participants are split into nodes of FanIn participants, the last one to arrive at a node goes on to
+ *   the parent node, the last one at the root flips the sense. On the way back every winner wakes the losers of the nodes it won,
+ *   so the wake ups are spread over many tasks and both cores instead of being done by one task. A FanIn of 0 gives a flat
+ *   barrier with a single node.
+ * ->A waiter spins BARRIER_SPIN times on the sense before it blocks on its task notification, a winner only notifies the waiters
+ *   which have gone to sleep, so there is no kernel call when all the participants arrive close together.
+ * ->Timeout, a participant which times out breaks the barrier and wakes everyone, the others return BARRIER_BROKEN and the
+ *   barrier has to be reset with Barrier_Init before it is used again.
+ *
+ * The benchmark at the start measures the time of one phase with 3 to 32 workers spread over both cores, for xEventGroupSync, the
+ * flat barrier and the tree barrier. After that the tasks of example 23 are synchronised with the barrier.
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "esp_system.h"
+
+#define RTOS                        "FREERTOS"
+
+#define BARRIER_MAX_PARTICIPANTS    64
+#define BARRIER_MAX_LEVELS          7
+#define BARRIER_SPIN                200
+
+typedef enum
+{
+    BARRIER_OK = 0,
+    BARRIER_SERIAL,                         //Returned to the one participant which completed the phase
+    BARRIER_TIMEOUT,
+    BARRIER_BROKEN
+}BarrierResult_t;
+
+typedef struct
+{
+    TaskHandle_t Task;
+    volatile uint32_t Sleeping;
+}BarrierSlot_t;
+
+typedef struct
+{
+    volatile uint32_t Count;
+    uint32_t Expected;
+    uint32_t FirstSlot;                     //Slots of this node in the Slots array of the barrier
+    int32_t Parent;                         //-1 for the root
+    uint32_t ParentSlot;
+}BarrierNode_t;
+
+typedef struct
+{
+    volatile uint32_t Sense;
+    volatile uint32_t Broken;
+    uint32_t Participants;
+    uint32_t FanIn;
+    uint32_t NodeCount;
+    uint32_t SlotCount;
+    BarrierNode_t Nodes[BARRIER_MAX_PARTICIPANTS];
+    BarrierSlot_t Slots[2 * BARRIER_MAX_PARTICIPANTS];
+}Barrier_t;
+
+/*---------------------------------------------- Barrier ----------------------------------------------*/
+
+/*Builds the tree level by level from the leaves, FanIn 0 or a FanIn not below Participants gives a single node*/
+static BaseType_t Barrier_Init(Barrier_t* Barrier, uint32_t Participants, uint32_t FanIn)
+{
+    uint32_t LevelStart = 0, LevelCount = Participants, Children, Loop;
+
+    if((Participants == 0) || (Participants > BARRIER_MAX_PARTICIPANTS) || (FanIn == 1))
+    {
+        return pdFAIL;
+    }
+
+    Barrier->Sense = 0;
+    Barrier->Broken = 0;
+    Barrier->Participants = Participants;
+    Barrier->FanIn = ((FanIn == 0) || (FanIn > Participants)) ? Participants : FanIn;
+    Barrier->NodeCount = 0;
+    Barrier->SlotCount = 0;
+
+    //LevelCount is the number of children of the level which is built, participants for the leaves
+    do
+    {
+        Children = LevelCount;
+        LevelCount = (Children + Barrier->FanIn - 1) / Barrier->FanIn;
+
+        for(Loop = 0; Loop < LevelCount; Loop++)
+        {
+            BarrierNode_t* Node = &Barrier->Nodes[Barrier->NodeCount + Loop];
+
+            Node->Count = 0;
+            Node->Expected = ((Loop + 1) * Barrier->FanIn <= Children) ? Barrier->FanIn : (Children % Barrier->FanIn);
+            Node->FirstSlot = Barrier->SlotCount;
+            Node->Parent = -1;
+            Barrier->SlotCount += Node->Expected;
+        }
+
+        //Links the nodes of the level below to the ones just built
+        if(Barrier->NodeCount != 0)
+        {
+            for(Loop = 0; Loop < Children; Loop++)
+            {
+                Barrier->Nodes[LevelStart + Loop].Parent = (int32_t)(Barrier->NodeCount + (Loop / Barrier->FanIn));
+                Barrier->Nodes[LevelStart + Loop].ParentSlot = Loop % Barrier->FanIn;
+            }
+        }
+
+        LevelStart = Barrier->NodeCount;
+        Barrier->NodeCount += LevelCount;
+    }while(LevelCount > 1);
+
+    for(Loop = 0; Loop < Barrier->SlotCount; Loop++)
+    {
+        Barrier->Slots[Loop].Task = NULL;
+        Barrier->Slots[Loop].Sleeping = 0;
+    }
+
+    return pdPASS;
+}
+
+static void Barrier_WakeSlot(BarrierSlot_t* Slot)
+{
+    if(__atomic_exchange_n(&Slot->Sleeping,0,__ATOMIC_SEQ_CST) != 0)
+    {
+        xTaskNotifyGive(Slot->Task);
+    }
+}
+
+/*Wakes every participant which is waiting, used when the barrier breaks*/
+static void Barrier_Break(Barrier_t* Barrier)
+{
+    uint32_t Loop;
+
+    __atomic_store_n(&Barrier->Broken,1,__ATOMIC_SEQ_CST);
+
+    for(Loop = 0; Loop < Barrier->SlotCount; Loop++)
+    {
+        if(Barrier->Slots[Loop].Task != NULL)
+        {
+            Barrier_WakeSlot(&Barrier->Slots[Loop]);
+        }
+    }
+}
+
+/*Waits until the sense of the barrier is MySense, returns pdFALSE on a timeout or when the barrier is broken*/
+static BaseType_t Barrier_Block(Barrier_t* Barrier, BarrierSlot_t* Slot, uint32_t MySense, TimeOut_t* TimeOut,
+                                TickType_t* Timeout)
+{
+    uint32_t Spin;
+
+    for(Spin = 0; Spin < BARRIER_SPIN; Spin++)
+    {
+        if(__atomic_load_n(&Barrier->Sense,__ATOMIC_ACQUIRE) == MySense)
+        {
+            return pdTRUE;
+        }
+    }
+
+    for(;;)
+    {
+        //Sleeping is raised before the sense is checked again, a winner which flips the sense after the check sees it
+        __atomic_store_n(&Slot->Sleeping,1,__ATOMIC_SEQ_CST);
+
+        if(__atomic_load_n(&Barrier->Sense,__ATOMIC_SEQ_CST) == MySense)
+        {
+            __atomic_store_n(&Slot->Sleeping,0,__ATOMIC_SEQ_CST);
+            return pdTRUE;
+        }
+
+        if((__atomic_load_n(&Barrier->Broken,__ATOMIC_SEQ_CST) != 0) || (xTaskCheckForTimeOut(TimeOut,Timeout) == pdTRUE))
+        {
+            __atomic_store_n(&Slot->Sleeping,0,__ATOMIC_SEQ_CST);
+            return pdFALSE;
+        }
+
+        //A notification left over from a previous phase only causes one more pass
+        ulTaskNotifyTake(pdTRUE,*Timeout);
+    }
+}
+
+/*Index is the number of the participant, 0 to Participants - 1, every participant has to use its own*/
+static BarrierResult_t Barrier_Wait(Barrier_t* Barrier, uint32_t Index, TickType_t Timeout)
+{
+    uint32_t Won[BARRIER_MAX_LEVELS], WonSlot[BARRIER_MAX_LEVELS], Levels = 0, Loop, MySense, NodeIndex, SlotIndex, Arrived;
+    BarrierNode_t* Node;
+    TimeOut_t TimeOut;
+    BaseType_t Released, Serial = pdFALSE;
+
+    if(__atomic_load_n(&Barrier->Broken,__ATOMIC_SEQ_CST) != 0)
+    {
+        return BARRIER_BROKEN;
+    }
+
+    //The sense can not flip before this participant has arrived, so it is safe to read it here
+    MySense = __atomic_load_n(&Barrier->Sense,__ATOMIC_ACQUIRE) ^ 1;
+    NodeIndex = Index / Barrier->FanIn;
+    SlotIndex = Barrier->Nodes[NodeIndex].FirstSlot + (Index % Barrier->FanIn);
+    vTaskSetTimeOutState(&TimeOut);
+
+    for(;;)
+    {
+        Node = &Barrier->Nodes[NodeIndex];
+
+        //The slot is filled before the arrival is counted, the winner of the node reads it after its own arrival
+        Barrier->Slots[SlotIndex].Task = xTaskGetCurrentTaskHandle();
+        Arrived = __atomic_add_fetch(&Node->Count,1,__ATOMIC_ACQ_REL);
+
+        if(Arrived < Node->Expected)
+        {
+            //Lost at this node, wait for the release and wake the losers of the nodes won below
+            Released = Barrier_Block(Barrier,&Barrier->Slots[SlotIndex],MySense,&TimeOut,&Timeout);
+
+            if(Released == pdFALSE)
+            {
+                if(__atomic_load_n(&Barrier->Broken,__ATOMIC_SEQ_CST) != 0)
+                {
+                    return BARRIER_BROKEN;
+                }
+
+                Barrier_Break(Barrier);
+                return BARRIER_TIMEOUT;
+            }
+
+            break;
+        }
+
+        //Last one at this node, the node is ready for the next phase before the climb goes on
+        __atomic_store_n(&Node->Count,0,__ATOMIC_RELAXED);
+        Won[Levels] = NodeIndex;
+        WonSlot[Levels++] = SlotIndex;
+
+        if(Node->Parent < 0)
+        {
+            __atomic_store_n(&Barrier->Sense,MySense,__ATOMIC_SEQ_CST);
+            Serial = pdTRUE;
+            break;
+        }
+
+        SlotIndex = Barrier->Nodes[Node->Parent].FirstSlot + Node->ParentSlot;
+        NodeIndex = (uint32_t)Node->Parent;
+    }
+
+    //Top down over the nodes won, every other participant of those nodes is woken by this one
+    while(Levels-- > 0)
+    {
+        Node = &Barrier->Nodes[Won[Levels]];
+
+        for(Loop = Node->FirstSlot; Loop < (Node->FirstSlot + Node->Expected); Loop++)
+        {
+            if(Loop != WonSlot[Levels])
+            {
+                Barrier_WakeSlot(&Barrier->Slots[Loop]);
+            }
+        }
+    }
+
+    return (Serial != pdFALSE) ? BARRIER_SERIAL : BARRIER_OK;
+}
+
+/*---------------------------------------------- Benchmark ----------------------------------------------*/
+
+typedef enum
+{
+    BENCH_EVENT_GROUP = 0,
+    BENCH_FLAT,
+    BENCH_TREE
+}BenchMode_t;
+
+#define BENCH_PHASES            2000
+#define BENCH_TREE_FANIN        4
+#define BENCH_EVENT_BITS        24              //Bits of an event group with 32 bit ticks, the top byte is used by the kernel
+
+static const uint32_t Bench_Workers[] = {3,8,16,24,32};
+
+static EventGroupHandle_t Bench_EventGroup;
+static Barrier_t Bench_Barrier, Sync_Barrier;
+static SemaphoreHandle_t Bench_Done;
+static volatile BenchMode_t Bench_Mode;
+static volatile uint32_t Bench_Count;
+static int64_t Bench_Start, Bench_End;
+
+static void BenchWorker_Task(void* pvParameters)
+{
+    uint32_t Index = (uint32_t)pvParameters, Phase;
+    const EventBits_t AllSyncBit = (EventBits_t)((1UL << Bench_Count) - 1);
+
+    for(Phase = 0; Phase < BENCH_PHASES; Phase++)
+    {
+        if(Bench_Mode == BENCH_EVENT_GROUP)
+        {
+            xEventGroupSync(Bench_EventGroup,(EventBits_t)(1UL << Index),AllSyncBit,portMAX_DELAY);
+        }
+        else
+        {
+            Barrier_Wait(&Bench_Barrier,Index,portMAX_DELAY);
+        }
+
+        //The first phase lines the workers up, the time is taken from its end to the end of the last one
+        if(Index == 0)
+        {
+            if(Phase == 0)
+            {
+                Bench_Start = esp_timer_get_time();
+            }
+            else if(Phase == (BENCH_PHASES - 1))
+            {
+                Bench_End = esp_timer_get_time();
+            }
+        }
+    }
+
+    xSemaphoreGive(Bench_Done);
+    vTaskDelete(NULL);
+}
+
+static void Benchmark_Run(void)
+{
+    static const char* const Modes[] = {"xEventGroupSync","Barrier flat","Barrier tree"};
+    uint32_t Workers, Mode, Loop;
+    char Name[configMAX_TASK_NAME_LEN];
+
+    printf("%-16s %8s %12s\r\n","Primitive","Workers","us/phase");
+
+    for(Workers = 0; Workers < (sizeof(Bench_Workers) / sizeof(Bench_Workers[0])); Workers++)
+    {
+        for(Mode = BENCH_EVENT_GROUP; Mode <= BENCH_TREE; Mode++)
+        {
+            Bench_Count = Bench_Workers[Workers];
+
+            if((Mode == BENCH_EVENT_GROUP) && (Bench_Count > BENCH_EVENT_BITS))
+            {
+                printf("%-16s %8u %12s\r\n",Modes[Mode],Bench_Count,"n/a");
+                continue;
+            }
+
+            Bench_Mode = (BenchMode_t)Mode;
+            xEventGroupClearBits(Bench_EventGroup,(EventBits_t)((1UL << BENCH_EVENT_BITS) - 1));
+            Barrier_Init(&Bench_Barrier,Bench_Count,(Mode == BENCH_TREE) ? BENCH_TREE_FANIN : 0);
+
+            //Same priority for every worker, spread over both cores
+            for(Loop = 0; Loop < Bench_Count; Loop++)
+            {
+                snprintf(Name,sizeof(Name),"Worker-%u",Loop);
+                xTaskCreatePinnedToCore(BenchWorker_Task,Name,2048,(void*)Loop,5,NULL,Loop & 1);
+            }
+
+            for(Loop = 0; Loop < Bench_Count; Loop++)
+            {
+                xSemaphoreTake(Bench_Done,portMAX_DELAY);
+            }
+
+            printf("%-16s %8u %12.2f\r\n",Modes[Mode],Bench_Count,
+                   (double)(Bench_End - Bench_Start) / (double)(BENCH_PHASES - 1));
+
+            //Lets the idle tasks free the stacks of the deleted workers
+            vTaskDelay(pdMS_TO_TICKS(50));
+        }
+    }
+}
+
+/*---------------------------------------------- Example 23 ----------------------------------------------*/
+
+static void Synchronous_Task(void* pvParameters)
+{
+    const TickType_t Max_Delay = pdMS_TO_TICKS(4000);
+    const TickType_t Min_Delay = pdMS_TO_TICKS(500);
+    TickType_t Delay_Time;
+    uint32_t Index = (uint32_t)pvParameters;
+    BarrierResult_t Result;
+
+    for(;;)
+    {
+        Delay_Time = (rand() % Max_Delay) + Min_Delay;
+        vTaskDelay(Delay_Time);
+
+        ESP_LOGI(RTOS,"%s reached synch point.\r\n",pcTaskGetTaskName(NULL));
+
+        //The longest delay is 4.5 seconds, a timeout of 5 seconds is never hit while all the tasks are alive
+        Result = Barrier_Wait(&Sync_Barrier,Index,pdMS_TO_TICKS(5000));
+
+        if(Result == BARRIER_SERIAL)
+        {
+            ESP_LOGI(RTOS,"%s exited synch point, last to arrive.\r\n",pcTaskGetTaskName(NULL));
+        }
+        else if(Result == BARRIER_OK)
+        {
+            ESP_LOGI(RTOS,"%s exited synch point.\r\n",pcTaskGetTaskName(NULL));
+        }
+        else
+        {
+            ESP_LOGE(RTOS,"%s barrier %s.\r\n",pcTaskGetTaskName(NULL),(Result == BARRIER_TIMEOUT) ? "timed out" : "broken");
+            vTaskDelete(NULL);
+        }
+    }
+}
+
+void app_main(void)
+{
+    Bench_EventGroup = xEventGroupCreate();
+    Bench_Done = xSemaphoreCreateCounting(BARRIER_MAX_PARTICIPANTS,0);
+
+    if((Bench_EventGroup == NULL) || (Bench_Done == NULL))
+    {
+        ESP_LOGE(RTOS,"Benchmark objects could not be created.\r\n");
+        return;
+    }
+
+    //app_main runs at priority 1, above it so that all the workers of a run are created before they are timed
+    vTaskPrioritySet(NULL,6);
+    Benchmark_Run();
+    vTaskPrioritySet(NULL,1);
+
+    //Three instances of the same task are synched as in example 23, without a bit for each of them
+    Barrier_Init(&Sync_Barrier,3,0);
+
+    xTaskCreate(Synchronous_Task,"Synching-1",2048,(void*)0,1,NULL);
+    xTaskCreate(Synchronous_Task,"Synching-2",2048,(void*)1,1,NULL);
+    xTaskCreate(Synchronous_Task,"Synching-3",2048,(void*)2,1,NULL);
+}
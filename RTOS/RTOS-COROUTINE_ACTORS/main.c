@@ -0,0 +1,582 @@
+/**
+ * @file main.c
+ * @author Tushar Uttekar
+ *
+ * @brief
+ *
+ * This example demonstrates a stackless coroutine (actor) runtime using which hundreds of small state machines can be run on
+ * one host task instead of creating a task with its own stack for each of them, as it was done for the Print_Task instances of
+ * example 20 and example 21 which just loop and delay with 2048 bytes of stack each.
+ *
+ * An actor is a function which is called again and again by the host task and which resumes from the point where it returned
+ * last time. The resume point is kept in the actor with the ACTOR_BEGIN/ACTOR_END macros (a switch over the line number), so an
+ * actor does not need a stack of its own, but it also means the local variables are not kept across a wait and everything which
+ * has to survive a wait is kept in the context of the actor.
+ *
+ * An actor can wait for:
+ * ->A delay in ticks with ACTOR_DELAY.
+ * ->A message in its mailbox with ACTOR_AWAIT_MESSAGE, the message is posted with Actor_Post from a task, an ISR or an actor.
+ * ->A notification with ACTOR_AWAIT_NOTIFY, given with Actor_Notify.
+ *
+ * The host task keeps the runnable actors in a FIFO and the delayed actors in a timing wheel indexed by the tick of their wake up,
+ * so both picking the next actor and waking the delayed ones are O(1) per actor.
+ *
+ * At the start the example prints the message rate of a ping-pong between two actors against a ping-pong between two tasks
+ * using task notifications, both measured before the print actors are started, and then the heap used by starting ACTOR_COUNT
+ * actors against the heap used by tasks with the stack of the Print_Task. The posts dropped on the full mailbox of the collector
+ * are printed along with the messages collected.
+ *
+ * NOTE : An actor must not call any blocking API as it would block the host task and every other actor with it.
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_system.h"
+
+#define RTOS                    "freertos"
+#define ACTOR_COUNT             300
+#define ACTOR_MAILBOX_SIZE      4
+#define ACTOR_WHEEL_SIZE        64
+#define ACTOR_WHEEL_MASK        (ACTOR_WHEEL_SIZE - 1)
+#define ACTOR_TASK_STACK        2048
+#define BENCHMARK_TIME          (pdMS_TO_TICKS(1000))
+#define MEASURE_TASKS           8
+#define STATS_PERIOD            (pdMS_TO_TICKS(5000))
+
+/*Values returned by the actor function to the host task*/
+typedef enum
+{
+    Actor_Waiting = 0,
+    Actor_Done
+}ActorResult_t;
+
+typedef enum
+{
+    Wait_None = 0,
+    Wait_Delay,
+    Wait_Message,
+    Wait_Notify
+}ActorWait_t;
+
+typedef struct Actor Actor_t;
+typedef ActorResult_t (*ActorFunction_t)(Actor_t* Actor);
+
+struct Actor
+{
+    Actor_t* Next;
+    ActorFunction_t Function;
+    void* Context;
+    uint16_t Line;
+    uint8_t Wait;
+    uint8_t Queued;
+    uint32_t WakeTick;
+    uint32_t Rounds;
+    uint32_t Notifications;
+    uint32_t Mailbox[ACTOR_MAILBOX_SIZE];
+    uint8_t MailHead;
+    uint8_t MailCount;
+};
+
+typedef struct
+{
+    Actor_t* ReadyHead;
+    Actor_t* ReadyTail;
+    Actor_t* Wheel[ACTOR_WHEEL_SIZE];
+    uint32_t Tick;
+    uint32_t Resumes;
+    TaskHandle_t Host;
+    portMUX_TYPE Lock;
+}ActorRuntime_t;
+
+/*---------------------------------------------- Actor macros ----------------------------------------------*/
+
+#define ACTOR_BEGIN(Actor)          switch((Actor)->Line) { case 0:
+
+#define ACTOR_END(Actor)            } (Actor)->Line = 0; return Actor_Done
+
+#define ACTOR_DELAY(Actor,Ticks)    do { (Actor)->Line = __LINE__; Actor_Delay((Actor),(Ticks)); return Actor_Waiting;  \
+                                         case __LINE__:; } while(0)
+
+#define ACTOR_YIELD(Actor)          ACTOR_DELAY(Actor,0)
+
+#define ACTOR_AWAIT_MESSAGE(Actor,Message)                                                                              \
+                                    do { (Actor)->Line = __LINE__; case __LINE__:                                       \
+                                         if(Actor_TakeMessage((Actor),(Message)) != pdPASS) { return Actor_Waiting; }   \
+                                    } while(0)
+
+#define ACTOR_AWAIT_NOTIFY(Actor)   do { (Actor)->Line = __LINE__; case __LINE__:                                       \
+                                         if(Actor_TakeNotify(Actor) != pdPASS) { return Actor_Waiting; }                \
+                                    } while(0)
+
+/*---------------------------------------------- Actor runtime ----------------------------------------------*/
+
+static ActorRuntime_t Runtime;
+
+/*Adds the actor at the end of the ready FIFO, called with the lock taken*/
+static void Actor_MakeReady(Actor_t* Actor)
+{
+    if(Actor->Queued == pdTRUE)
+    {
+        return;
+    }
+
+    Actor->Wait = Wait_None;
+    Actor->Queued = pdTRUE;
+    Actor->Next = NULL;
+
+    if(Runtime.ReadyTail != NULL)
+    {
+        Runtime.ReadyTail->Next = Actor;
+    }
+    else
+    {
+        Runtime.ReadyHead = Actor;
+    }
+    Runtime.ReadyTail = Actor;
+}
+
+void Actor_Init(Actor_t* Actor, ActorFunction_t Function, void* Context)
+{
+    memset(Actor,0,sizeof(Actor_t));
+    Actor->Function = Function;
+    Actor->Context = Context;
+
+    portENTER_CRITICAL(&Runtime.Lock);
+    Actor_MakeReady(Actor);
+    portEXIT_CRITICAL(&Runtime.Lock);
+
+    xTaskNotifyGive(Runtime.Host);
+}
+
+/*Places the actor in the wheel slot of its wake up tick, a delay of zero puts it back at the end of the ready FIFO*/
+static void Actor_Delay(Actor_t* Actor, uint32_t Ticks)
+{
+    uint32_t Slot;
+
+    portENTER_CRITICAL(&Runtime.Lock);
+
+    if(Ticks == 0)
+    {
+        Actor_MakeReady(Actor);
+    }
+    else
+    {
+        Actor->Wait = Wait_Delay;
+        Actor->WakeTick = Runtime.Tick + Ticks;
+        Actor->Rounds = (Ticks - 1) / ACTOR_WHEEL_SIZE;
+
+        Slot = Actor->WakeTick & ACTOR_WHEEL_MASK;
+        Actor->Next = Runtime.Wheel[Slot];
+        Runtime.Wheel[Slot] = Actor;
+    }
+
+    portEXIT_CRITICAL(&Runtime.Lock);
+}
+
+static BaseType_t Actor_TakeMessage(Actor_t* Actor, uint32_t* Message)
+{
+    BaseType_t xStatus = pdFAIL;
+
+    portENTER_CRITICAL(&Runtime.Lock);
+
+    if(Actor->MailCount != 0)
+    {
+        *Message = Actor->Mailbox[Actor->MailHead];
+        Actor->MailHead = (Actor->MailHead + 1) % ACTOR_MAILBOX_SIZE;
+        Actor->MailCount--;
+        xStatus = pdPASS;
+    }
+    else
+    {
+        Actor->Wait = Wait_Message;
+    }
+
+    portEXIT_CRITICAL(&Runtime.Lock);
+
+    return xStatus;
+}
+
+static BaseType_t Actor_TakeNotify(Actor_t* Actor)
+{
+    BaseType_t xStatus = pdFAIL;
+
+    portENTER_CRITICAL(&Runtime.Lock);
+
+    if(Actor->Notifications != 0)
+    {
+        Actor->Notifications--;
+        xStatus = pdPASS;
+    }
+    else
+    {
+        Actor->Wait = Wait_Notify;
+    }
+
+    portEXIT_CRITICAL(&Runtime.Lock);
+
+    return xStatus;
+}
+
+/*Posts a message to the mailbox of the actor, returns pdFAIL when the mailbox is full*/
+BaseType_t Actor_Post(Actor_t* Actor, uint32_t Message)
+{
+    BaseType_t xStatus = pdFAIL, Wake = pdFALSE;
+
+    portENTER_CRITICAL(&Runtime.Lock);
+
+    if(Actor->MailCount < ACTOR_MAILBOX_SIZE)
+    {
+        Actor->Mailbox[(Actor->MailHead + Actor->MailCount) % ACTOR_MAILBOX_SIZE] = Message;
+        Actor->MailCount++;
+        xStatus = pdPASS;
+
+        if(Actor->Wait == Wait_Message)
+        {
+            Actor_MakeReady(Actor);
+            Wake = pdTRUE;
+        }
+    }
+
+    portEXIT_CRITICAL(&Runtime.Lock);
+
+    //Waking the host task only when it is not the one posting
+    if((Wake == pdTRUE) && (xTaskGetCurrentTaskHandle() != Runtime.Host))
+    {
+        xTaskNotifyGive(Runtime.Host);
+    }
+
+    return xStatus;
+}
+
+BaseType_t Actor_PostFromISR(Actor_t* Actor, uint32_t Message, BaseType_t* pxHigherPriorityTaskWoken)
+{
+    BaseType_t xStatus = pdFAIL, Wake = pdFALSE;
+
+    portENTER_CRITICAL_ISR(&Runtime.Lock);
+
+    if(Actor->MailCount < ACTOR_MAILBOX_SIZE)
+    {
+        Actor->Mailbox[(Actor->MailHead + Actor->MailCount) % ACTOR_MAILBOX_SIZE] = Message;
+        Actor->MailCount++;
+        xStatus = pdPASS;
+
+        if(Actor->Wait == Wait_Message)
+        {
+            Actor_MakeReady(Actor);
+            Wake = pdTRUE;
+        }
+    }
+
+    portEXIT_CRITICAL_ISR(&Runtime.Lock);
+
+    if(Wake == pdTRUE)
+    {
+        vTaskNotifyGiveFromISR(Runtime.Host,pxHigherPriorityTaskWoken);
+    }
+
+    return xStatus;
+}
+
+void Actor_Notify(Actor_t* Actor)
+{
+    BaseType_t Wake = pdFALSE;
+
+    portENTER_CRITICAL(&Runtime.Lock);
+
+    Actor->Notifications++;
+    if(Actor->Wait == Wait_Notify)
+    {
+        Actor_MakeReady(Actor);
+        Wake = pdTRUE;
+    }
+
+    portEXIT_CRITICAL(&Runtime.Lock);
+
+    if((Wake == pdTRUE) && (xTaskGetCurrentTaskHandle() != Runtime.Host))
+    {
+        xTaskNotifyGive(Runtime.Host);
+    }
+}
+
+/*Moves the actors of the slot of the current tick whose delay is over to the ready FIFO, called with the lock taken*/
+static void Actor_ProcessTick(void)
+{
+    Actor_t *Actor, *Next, **Link;
+
+    Runtime.Tick++;
+    Link = &Runtime.Wheel[Runtime.Tick & ACTOR_WHEEL_MASK];
+
+    for(Actor = *Link; Actor != NULL; Actor = Next)
+    {
+        Next = Actor->Next;
+
+        if(Actor->Rounds != 0)
+        {
+            Actor->Rounds--;
+            Link = &Actor->Next;
+            continue;
+        }
+
+        *Link = Next;
+        Actor_MakeReady(Actor);
+    }
+}
+
+static void Actor_HostTask(void* pvParameters)
+{
+    Actor_t* Actor;
+    TickType_t LastTick, Now;
+    ActorResult_t Result;
+
+    LastTick = xTaskGetTickCount();
+
+    for(;;)
+    {
+        portENTER_CRITICAL(&Runtime.Lock);
+
+        //Catching up with the ticks which have passed since the last visit of the wheel
+        Now = xTaskGetTickCount();
+        while(LastTick != Now)
+        {
+            LastTick++;
+            Actor_ProcessTick();
+        }
+
+        Actor = Runtime.ReadyHead;
+        if(Actor != NULL)
+        {
+            Runtime.ReadyHead = Actor->Next;
+            if(Runtime.ReadyHead == NULL)
+            {
+                Runtime.ReadyTail = NULL;
+            }
+            Actor->Queued = pdFALSE;
+        }
+
+        portEXIT_CRITICAL(&Runtime.Lock);
+
+        if(Actor != NULL)
+        {
+            Runtime.Resumes++;
+            Result = Actor->Function(Actor);
+
+            if(Result == Actor_Done)
+            {
+                //Finished actors are simply not scheduled again
+                Actor->Wait = Wait_None;
+            }
+        }
+        else
+        {
+            //Nothing is ready, sleeping until the next tick or until an actor is made ready from outside
+            ulTaskNotifyTake(pdTRUE,1);
+        }
+    }
+}
+
+void Actor_StartRuntime(UBaseType_t Priority, BaseType_t Core)
+{
+    memset(&Runtime,0,sizeof(ActorRuntime_t));
+    vPortCPUInitializeMutex(&Runtime.Lock);
+
+    xTaskCreatePinnedToCore(Actor_HostTask,"ActorHost",ACTOR_TASK_STACK,NULL,Priority,&Runtime.Host,Core);
+}
+
+/*---------------------------------------------- Example actors ----------------------------------------------*/
+
+/*Context of the printing actors, kept outside the actor as the locals are lost across a wait*/
+typedef struct
+{
+    uint32_t Id;
+    uint32_t Loops;
+}PrintContext_t;
+
+typedef struct
+{
+    Actor_t* Peer;
+    uint32_t Message;
+    uint32_t Count;
+}PingContext_t;
+
+static Actor_t Print_Actors[ACTOR_COUNT];
+static PrintContext_t Print_Contexts[ACTOR_COUNT];
+static Actor_t Ping_Actor, Pong_Actor, Collector_Actor;
+static PingContext_t Ping_Context, Pong_Context;
+static volatile uint32_t Collected;
+static volatile uint32_t Dropped;
+static volatile BaseType_t PingPong_Running = pdTRUE;
+
+/*Same loop as the Print_Task of example 20 without the stack, the print is replaced with a message to the collector*/
+static ActorResult_t Print_Actor(Actor_t* Actor)
+{
+    PrintContext_t* Context = (PrintContext_t*) Actor->Context;
+
+    ACTOR_BEGIN(Actor);
+
+    for(;;)
+    {
+        Context->Loops++;
+
+        //The mailbox of the collector holds ACTOR_MAILBOX_SIZE messages, the rest are counted and dropped
+        if(Actor_Post(&Collector_Actor,Context->Id) != pdPASS)
+        {
+            Dropped++;
+        }
+
+        ACTOR_DELAY(Actor,(rand() % 0x20) + 1);
+    }
+
+    ACTOR_END(Actor);
+}
+
+static ActorResult_t Collector(Actor_t* Actor)
+{
+    static uint32_t Message;
+
+    ACTOR_BEGIN(Actor);
+
+    for(;;)
+    {
+        ACTOR_AWAIT_MESSAGE(Actor,&Message);
+        Collected++;
+    }
+
+    ACTOR_END(Actor);
+}
+
+static ActorResult_t PingPong(Actor_t* Actor)
+{
+    PingContext_t* Context = (PingContext_t*) Actor->Context;
+
+    ACTOR_BEGIN(Actor);
+
+    //The ping-pong keeps the host task busy, so it finishes once the measurement is over
+    while(PingPong_Running == pdTRUE)
+    {
+        ACTOR_AWAIT_NOTIFY(Actor);
+        Context->Count++;
+        Actor_Notify(Context->Peer);
+    }
+
+    ACTOR_END(Actor);
+}
+
+/*---------------------------------------------- Comparison with tasks ----------------------------------------------*/
+
+static TaskHandle_t PingTask_Handle, PongTask_Handle;
+static volatile uint32_t TaskPingPong_Count;
+
+static void TaskPingPong(void* pvParameters)
+{
+    TaskHandle_t* Peer = (TaskHandle_t*) pvParameters;
+
+    for(;;)
+    {
+        ulTaskNotifyTake(pdTRUE,portMAX_DELAY);
+        TaskPingPong_Count++;
+        xTaskNotifyGive(*Peer);
+    }
+}
+
+/*Task which only waits, measures what a task costs on the heap*/
+static void Idle_Task(void* pvParameters)
+{
+    for(;;)
+    {
+        vTaskDelay(portMAX_DELAY);
+    }
+}
+
+static void Benchmark_Task(void* pvParameters)
+{
+    TaskHandle_t Tasks[MEASURE_TASKS];
+    uint32_t ActorCount, TaskCount, Index, Created;
+    size_t FreeBefore, ActorHeap, TaskHeap;
+
+    //Ping-pong between two actors on the host task, before the print actors exist so nothing else is scheduled
+    Ping_Context.Peer = &Pong_Actor;
+    Pong_Context.Peer = &Ping_Actor;
+    Actor_Init(&Ping_Actor,PingPong,&Ping_Context);
+    Actor_Init(&Pong_Actor,PingPong,&Pong_Context);
+    Actor_Notify(&Ping_Actor);
+
+    vTaskDelay(BENCHMARK_TIME);
+    ActorCount = Ping_Context.Count + Pong_Context.Count;
+    PingPong_Running = pdFALSE;
+
+    //Same ping-pong between two tasks pinned on the same core as the host task
+    xTaskCreatePinnedToCore(TaskPingPong,"Ping",ACTOR_TASK_STACK,&PongTask_Handle,1,&PingTask_Handle,0);
+    xTaskCreatePinnedToCore(TaskPingPong,"Pong",ACTOR_TASK_STACK,&PingTask_Handle,1,&PongTask_Handle,0);
+    xTaskNotifyGive(PingTask_Handle);
+
+    vTaskDelay(BENCHMARK_TIME);
+    TaskCount = TaskPingPong_Count;
+
+    vTaskDelete(PingTask_Handle);
+    vTaskDelete(PongTask_Handle);
+
+    printf("Ping-pong in one second: actors %u, tasks %u\r\n",ActorCount,TaskCount);
+
+    //Heap used by the actors, they are statically allocated so only their static size should count
+    FreeBefore = esp_get_free_heap_size();
+
+    Actor_Init(&Collector_Actor,Collector,NULL);
+
+    for(Index = 0; Index < ACTOR_COUNT; Index++)
+    {
+        Print_Contexts[Index].Id = Index;
+        Actor_Init(&Print_Actors[Index],Print_Actor,&Print_Contexts[Index]);
+    }
+
+    ActorHeap = FreeBefore - esp_get_free_heap_size();
+
+    //The heap does not hold ACTOR_COUNT tasks with the stack of the Print_Task, a few are created and the cost is scaled
+    FreeBefore = esp_get_free_heap_size();
+
+    for(Created = 0; Created < MEASURE_TASKS; Created++)
+    {
+        if(xTaskCreatePinnedToCore(Idle_Task,"Measure",ACTOR_TASK_STACK,NULL,1,&Tasks[Created],0) != pdPASS)
+        {
+            break;
+        }
+    }
+
+    TaskHeap = FreeBefore - esp_get_free_heap_size();
+
+    for(Index = 0; Index < Created; Index++)
+    {
+        vTaskDelete(Tasks[Index]);
+    }
+
+    printf("Memory for %d actors: heap %u bytes, static %u bytes\r\n",ACTOR_COUNT,ActorHeap,
+           sizeof(Print_Actors) + sizeof(Print_Contexts));
+
+    if(Created != 0)
+    {
+        printf("Memory for %d tasks: heap %u bytes (%u bytes per task measured with %u tasks)\r\n",ACTOR_COUNT,
+               (TaskHeap / Created) * ACTOR_COUNT,TaskHeap / Created,Created);
+    }
+
+    for(;;)
+    {
+        vTaskDelay(STATS_PERIOD);
+        printf("Actor host: resumes %u, messages collected from the print actors %u, dropped %u\r\n",Runtime.Resumes,
+               Collected,Dropped);
+    }
+}
+
+void app_main(void)
+{
+    Actor_StartRuntime(1,0);
+
+    xTaskCreatePinnedToCore(Benchmark_Task,"Benchmark",3072,NULL,2,NULL,1);
+}
@@ -0,0 +1,259 @@
+/**
+ * @file freertos_cpp.hpp
+ * @author Tushar Uttekar
+ *
+ * @brief
+ *
+ * Header only C++17 layer over the FREERTOS API's in which the objects are typed and sized at compile time.
+ *
+ * ->Queue<T, N> and Mailbox<T> carry the type of the item, so there is no void* cast and no sizeof at run time.
+ * ->Task<StackBytes, F> and Timer<Callback, State> keep the callable in the type, so the call from the kernel into the
+ *   application is a direct call which the compiler can inline.
+ * ->Every object brings its own storage and is created through the static allocation API's, so nothing is taken from the heap.
+ *
+ * The objects have to be of static storage duration (global or static), since the kernel keeps using their storage for as long
+ * as the object exists. Deferred<T> keeps the storage of such an object while its construction is left to the application.
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/timers.h"
+
+namespace rtos
+{
+
+/*---------------------------------------------- Queue ----------------------------------------------*/
+
+template<typename T, std::size_t N>
+class Queue
+{
+    static_assert(N > 0, "Queue needs at least one item");
+    static_assert(std::is_trivially_copyable<T>::value, "Queue items are copied byte wise by the kernel");
+
+public:
+    static constexpr std::size_t Length = N;
+    static constexpr std::size_t StorageBytes = N * sizeof(T);
+
+    Queue() : Handle(xQueueCreateStatic(N,sizeof(T),Storage,&Control)) {}
+
+    Queue(const Queue&) = delete;
+    Queue& operator=(const Queue&) = delete;
+
+    bool SendToBack(const T& Item, TickType_t Timeout = 0) { return xQueueSendToBack(Handle,&Item,Timeout) == pdPASS; }
+    bool SendToFront(const T& Item, TickType_t Timeout = 0) { return xQueueSendToFront(Handle,&Item,Timeout) == pdPASS; }
+    bool Receive(T& Item, TickType_t Timeout = portMAX_DELAY) { return xQueueReceive(Handle,&Item,Timeout) == pdPASS; }
+    bool Peek(T& Item, TickType_t Timeout = 0) { return xQueuePeek(Handle,&Item,Timeout) == pdPASS; }
+
+    bool SendToBackFromISR(const T& Item, BaseType_t* pxHigherPriorityTaskWoken)
+    {
+        return xQueueSendToBackFromISR(Handle,&Item,pxHigherPriorityTaskWoken) == pdPASS;
+    }
+
+    bool ReceiveFromISR(T& Item, BaseType_t* pxHigherPriorityTaskWoken)
+    {
+        return xQueueReceiveFromISR(Handle,&Item,pxHigherPriorityTaskWoken) == pdPASS;
+    }
+
+    UBaseType_t MessagesWaiting() const { return uxQueueMessagesWaiting(Handle); }
+    UBaseType_t SpacesAvailable() const { return uxQueueSpacesAvailable(Handle); }
+    QueueHandle_t NativeHandle() const { return Handle; }
+
+protected:
+    StaticQueue_t Control;
+    alignas(T) uint8_t Storage[StorageBytes];
+    QueueHandle_t Handle;
+};
+
+/*A mailbox is a queue of length one which is overwritten by the sender and peeked by the receiver*/
+template<typename T>
+class Mailbox : public Queue<T,1>
+{
+public:
+    void Write(const T& Item) { xQueueOverwrite(this->Handle,&Item); }
+    bool Read(T& Item, TickType_t Timeout = 0) { return this->Peek(Item,Timeout); }
+};
+
+/*---------------------------------------------- Semaphores ----------------------------------------------*/
+
+class BinarySemaphore
+{
+public:
+    BinarySemaphore() : Handle(xSemaphoreCreateBinaryStatic(&Control)) {}
+
+    BinarySemaphore(const BinarySemaphore&) = delete;
+    BinarySemaphore& operator=(const BinarySemaphore&) = delete;
+
+    bool Take(TickType_t Timeout = portMAX_DELAY) { return xSemaphoreTake(Handle,Timeout) == pdPASS; }
+    bool Give() { return xSemaphoreGive(Handle) == pdPASS; }
+    bool GiveFromISR(BaseType_t* pxHigherPriorityTaskWoken) { return xSemaphoreGiveFromISR(Handle,pxHigherPriorityTaskWoken) == pdPASS; }
+    SemaphoreHandle_t NativeHandle() const { return Handle; }
+
+private:
+    StaticSemaphore_t Control;
+    SemaphoreHandle_t Handle;
+};
+
+class Mutex
+{
+public:
+    Mutex() : Handle(xSemaphoreCreateMutexStatic(&Control)) {}
+
+    Mutex(const Mutex&) = delete;
+    Mutex& operator=(const Mutex&) = delete;
+
+    bool Lock(TickType_t Timeout = portMAX_DELAY) { return xSemaphoreTake(Handle,Timeout) == pdPASS; }
+    void Unlock() { xSemaphoreGive(Handle); }
+    SemaphoreHandle_t NativeHandle() const { return Handle; }
+
+private:
+    StaticSemaphore_t Control;
+    SemaphoreHandle_t Handle;
+};
+
+/*Takes the mutex for the lifetime of the guard*/
+class LockGuard
+{
+public:
+    explicit LockGuard(Mutex& Owned) : Owned(Owned) { Owned.Lock(); }
+    ~LockGuard() { Owned.Unlock(); }
+
+    LockGuard(const LockGuard&) = delete;
+    LockGuard& operator=(const LockGuard&) = delete;
+
+private:
+    Mutex& Owned;
+};
+
+/*---------------------------------------------- Task ----------------------------------------------*/
+
+template<std::size_t StackBytes, typename F>
+class Task
+{
+    static_assert(StackBytes >= configMINIMAL_STACK_SIZE, "Stack is smaller than the minimal stack size");
+    static_assert((StackBytes % sizeof(StackType_t)) == 0, "Stack size has to be a multiple of the stack word");
+
+public:
+    static constexpr std::size_t Bytes = StackBytes;
+
+    explicit Task(F Function) : Function(std::move(Function)), Handle(nullptr) {}
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    /*The stack depth of the ESP-IDF port is given in bytes*/
+    TaskHandle_t Start(const char* Name, UBaseType_t Priority, BaseType_t Core = tskNO_AFFINITY)
+    {
+        Handle = xTaskCreateStaticPinnedToCore(&Task::Entry,Name,StackBytes,this,Priority,Stack,&Control,Core);
+        return Handle;
+    }
+
+    TaskHandle_t NativeHandle() const { return Handle; }
+
+private:
+    static void Entry(void* pvParameters)
+    {
+        Task* Self = static_cast<Task*>(pvParameters);
+
+        Self->Function();
+
+        //A task function is not allowed to return, so the task deletes itself once the callable is done
+        vTaskDelete(nullptr);
+    }
+
+    F Function;
+    TaskHandle_t Handle;
+    StaticTask_t Control;
+    StackType_t Stack[StackBytes / sizeof(StackType_t)];
+};
+
+/*Deduces the type of the callable, to be used as: static auto Sender = rtos::MakeTask<2048>([] { ... });*/
+template<std::size_t StackBytes, typename F>
+Task<StackBytes,F> MakeTask(F Function)
+{
+    return Task<StackBytes,F>(std::move(Function));
+}
+
+/*---------------------------------------------- Timer ----------------------------------------------*/
+
+struct NoState {};
+
+/**
+ * Software timer whose callback is a template parameter. The callback gets the native handle and a reference to the typed state
+ * of the timer instead of casting the timer ID, a timer without state gets the native handle only.
+ */
+template<auto Callback, typename StateType = NoState>
+class Timer
+{
+public:
+    Timer(const char* Name, TickType_t Period, bool AutoReload, StateType Initial = StateType())
+        : UserState(Initial),
+          Handle(xTimerCreateStatic(Name,Period,AutoReload ? pdTRUE : pdFALSE,this,&Timer::Dispatch,&Control))
+    {
+    }
+
+    Timer(const Timer&) = delete;
+    Timer& operator=(const Timer&) = delete;
+
+    bool Start(TickType_t Timeout = 0) { return xTimerStart(Handle,Timeout) == pdPASS; }
+    bool Stop(TickType_t Timeout = 0) { return xTimerStop(Handle,Timeout) == pdPASS; }
+    bool Reset(TickType_t Timeout = 0) { return xTimerReset(Handle,Timeout) == pdPASS; }
+    bool ChangePeriod(TickType_t Period, TickType_t Timeout = 0) { return xTimerChangePeriod(Handle,Period,Timeout) == pdPASS; }
+
+    StateType& State() { return UserState; }
+    TimerHandle_t NativeHandle() const { return Handle; }
+
+private:
+    static void Dispatch(TimerHandle_t Native)
+    {
+        if constexpr (std::is_same<StateType,NoState>::value)
+        {
+            Callback(Native);
+        }
+        else
+        {
+            Callback(Native,static_cast<Timer*>(pvTimerGetTimerID(Native))->UserState);
+        }
+    }
+
+    StateType UserState;
+    StaticTimer_t Control;
+    TimerHandle_t Handle;
+};
+
+/*---------------------------------------------- Deferred ----------------------------------------------*/
+
+/**
+ * Static storage for an object which is constructed by Construct at run time instead of before app_main, for objects which have
+ * to be created in a given order or after something has been measured. The object is never destroyed.
+ */
+template<typename T>
+class Deferred
+{
+public:
+    template<typename... Args>
+    T& Construct(Args&&... Arguments) { return *new (Storage) T(std::forward<Args>(Arguments)...); }
+
+    T& operator*() { return *Get(); }
+    T* operator->() { return Get(); }
+
+private:
+    T* Get() { return std::launder(reinterpret_cast<T*>(Storage)); }
+
+    alignas(T) unsigned char Storage[sizeof(T)];
+};
+
+}
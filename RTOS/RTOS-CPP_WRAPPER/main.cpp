@@ -0,0 +1,156 @@
+/**
+ * @file main.cpp
+ * @author Tushar Uttekar
+ *
+ * @brief
+ *
+ * This example demonstrates the typed C++ layer of freertos_cpp.hpp on the applications of example 11 and example 14.
+ *
+ * ->The queue of example 11 becomes rtos::Queue<QueueStruct, 3>, so the item type and the length are part of the type and the
+ *   storage is reserved at compile time instead of xQueueCreate(3, sizeof(QueueStruct)) taking it from the heap.
+ * ->The execution count which example 14 kept in the timer ID with a (void*) cast is the typed state of the timer.
+ * ->The tasks are lambdas whose stack size is a template parameter.
+ *
+ * The heap is checked before and after the creation of all the objects to show that nothing is taken from it, the queues and
+ * the timer are kept in rtos::Deferred so they are created in app_main after the first check, and the queue
+ * send/receive is timed through the wrapper and through the raw C calls to show that the wrapper does not cost anything.
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdio.h>
+#include "freertos_cpp.hpp"
+#include "xtensa/core-macros.h"
+#include "esp_log.h"
+#include "esp_system.h"
+
+#define RTOS                    "freertos"
+#define PERIODIC_TIMER_PERIOD   (pdMS_TO_TICKS(500))
+#define BENCHMARK_LOOPS         10000
+
+/*Define the source of the data which helps in identification*/
+typedef enum
+{
+    Source1 = 0,
+    Source2
+}DataSource;
+
+/*Structure which will be used for sending the data and sender's information along with it*/
+typedef struct
+{
+    int32_t DataVal;
+    DataSource Source;
+}QueueStruct;
+
+static const QueueStruct xSendStruct[2] = { {123 , Source1}, {456 , Source2} };
+
+//Constructed in app_main, after the heap has been sampled
+static rtos::Deferred<rtos::Queue<QueueStruct,3>> xQueue;
+static rtos::Deferred<rtos::Queue<int32_t,5>> BenchQueue;
+
+/*Same as the callback of example 14, the count is typed state of the timer instead of the timer ID*/
+static void PeriodicCallBack(TimerHandle_t Timer, uint32_t& Execution_Count)
+{
+    Execution_Count++;
+    ESP_LOGI(RTOS,"Periodic timer callback routine is executing for the %u time.\r\n",Execution_Count);
+
+    //Stopping the periodic timer after it has executed 10th time
+    if(Execution_Count == 10)
+    {
+        xTimerStop(Timer,0);
+    }
+}
+
+static rtos::Deferred<rtos::Timer<PeriodicCallBack,uint32_t>> Periodic_Timer;
+
+template<std::size_t Index>
+static void Sender()
+{
+    const TickType_t Timeout = pdMS_TO_TICKS(100);
+
+    for(;;)
+    {
+        //The item type is checked at compile time, passing anything other than QueueStruct does not compile
+        if(xQueue->SendToBack(xSendStruct[Index],Timeout) == false)
+        {
+            printf("Unable to send data to queue!!\r\n");
+        }
+    }
+}
+
+static auto Sender_I1 = rtos::MakeTask<2048>([] { Sender<0>(); });
+static auto Sender_I2 = rtos::MakeTask<2048>([] { Sender<1>(); });
+
+static auto Receiver = rtos::MakeTask<2048>([]
+{
+    QueueStruct ReceiveData;
+
+    for(;;)
+    {
+        if(xQueue->Receive(ReceiveData,0) == true)
+        {
+            printf("Received Data from source %d = %d\r\n",(ReceiveData.Source + 1),ReceiveData.DataVal);
+        }
+        else
+        {
+            printf("Unable to receive queue data!\r\n");
+        }
+    }
+});
+
+/*Times the same send and receive through the wrapper and through the raw API*/
+static void Benchmark()
+{
+    QueueHandle_t Raw = BenchQueue->NativeHandle();
+    uint32_t Start, WrapperCycles, RawCycles, Loop;
+    int32_t Value = 0;
+
+    Start = XTHAL_GET_CCOUNT();
+    for(Loop = 0; Loop < BENCHMARK_LOOPS; Loop++)
+    {
+        BenchQueue->SendToBack(Value,0);
+        BenchQueue->Receive(Value,0);
+    }
+    WrapperCycles = XTHAL_GET_CCOUNT() - Start;
+
+    Start = XTHAL_GET_CCOUNT();
+    for(Loop = 0; Loop < BENCHMARK_LOOPS; Loop++)
+    {
+        xQueueSendToBack(Raw,&Value,0);
+        xQueueReceive(Raw,&Value,0);
+    }
+    RawCycles = XTHAL_GET_CCOUNT() - Start;
+
+    printf("Send+receive cycles: wrapper %u, raw API %u\r\n",(WrapperCycles / BENCHMARK_LOOPS),(RawCycles / BENCHMARK_LOOPS));
+}
+
+extern "C" void app_main(void)
+{
+    size_t FreeBefore;
+
+    FreeBefore = esp_get_free_heap_size();
+
+    //The queues and the timer are created here so their creation is seen by the heap check, the tasks only bind their lambda
+    //before app_main and are created by Start
+    xQueue.Construct();
+    BenchQueue.Construct();
+    Periodic_Timer.Construct("PeriodicTimer",PERIODIC_TIMER_PERIOD,true,0);
+
+    Benchmark();
+
+    //Sender Task two independent instances and the receiver task, all the stacks are reserved at compile time
+    Sender_I1.Start("Sender_I1",2);
+    Sender_I2.Start("Sender_I2",2);
+    Receiver.Start("Receiver",1);
+
+    Periodic_Timer->Start();
+
+    printf("Static RAM: queue %u bytes, each task %u bytes, timer %u bytes\r\n",sizeof(*xQueue),sizeof(Sender_I1),
+           sizeof(*Periodic_Timer));
+
+    //Should be zero as all the objects are created through the static allocation API's
+    printf("Heap used by the objects: %u bytes\r\n",(FreeBefore - esp_get_free_heap_size()));
+}
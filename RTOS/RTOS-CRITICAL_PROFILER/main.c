@@ -0,0 +1,367 @@
+/**
+ * @file main.c
+ * @author Tushar Uttekar
+ *
+ * @brief
+ *
+ * This example demonstrates an opt in profiler for critical sections and their spinlocks. On the dual core ESP32 every
+ * portENTER_CRITICAL masks the interrupts of the core and then spins on a portMUX_TYPE, without any visibility of how long a
+ * core spins or how long it keeps its interrupts masked.
+ *
+ * A critical section which should be profiled is described by a CritSite_t for its lock, the code then uses CRIT_ENTER and
+ * CRIT_EXIT (CRIT_ENTER_ISR and CRIT_EXIT_ISR in interrupts) instead of portENTER_CRITICAL and portEXIT_CRITICAL.
+ * ->Spin, the cycles from masking the interrupts until the lock is taken, which is the time spent waiting on the other core.
+ * ->Hold, the cycles from taking the lock until it is released.
+ * ->Masked, spin plus hold, the window in which the interrupts of the core stay masked, the longest one is kept along with the
+ *   file and line of the CRIT_ENTER which opened it, so it can be tracked down in the code.
+ * ->The acquires are counted per core and the spin and hold times are collected in log2 histograms.
+ *
+ * CritProfiler_Dump prints every site which has been entered at least once, CritProfiler_Reset clears the statistics.
+ * With CRIT_PROFILING set to 0 the macros are the plain port macros and the profiler costs nothing.
+ *
+ * NOTE : Only the sites which use the macros are measured, the locks inside the kernel (queues, semaphores, event groups) are
+ *        not, the spin on them shows up as a longer hold of the site which calls the kernel. The bookkeeping is done while the
+ *        lock is still held but outside the measured window, so it is not part of the numbers but it adds some cycles to the
+ *        real window.
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/xtensa_api.h"
+#include "xtensa/core-macros.h"
+#include "esp_intr_alloc.h"
+#include "esp_log.h"
+#include "esp_system.h"
+
+#define CRIT_PROFILING          1
+#define CRIT_HIST_BUCKETS       16
+#define CRIT_HIST_SHIFT         5           //First bucket holds everything below 32 cycles
+#define CRIT_MAX_NESTING        4
+#define CRIT_CPU_MHZ            240         //CPU frequency of the default configuration, only used for printing
+
+#define SW_ISR_LEVEL_3          29
+
+typedef struct
+{
+    uint32_t Acquires[portNUM_PROCESSORS];
+    uint64_t SpinCycles;
+    uint32_t SpinMax;
+    uint64_t HoldCycles;
+    uint32_t HoldMax;
+    uint32_t MaskedMax;
+    const char* MaskedFile;                 //Location of the CRIT_ENTER of the longest masked window
+    int MaskedLine;
+    uint32_t SpinHistogram[CRIT_HIST_BUCKETS];
+    uint32_t HoldHistogram[CRIT_HIST_BUCKETS];
+}CritStats_t;
+
+typedef struct CritSite
+{
+    const char* Name;
+    portMUX_TYPE* Mux;
+    struct CritSite* Next;
+    volatile BaseType_t Registered;
+
+    //Per core state of the section which is open, only touched by the core itself with its interrupts masked
+    UBaseType_t Depth[portNUM_PROCESSORS];
+    UBaseType_t Mask[portNUM_PROCESSORS][CRIT_MAX_NESTING];
+    uint32_t Start[portNUM_PROCESSORS];
+    uint32_t Acquired[portNUM_PROCESSORS];
+    const char* File[portNUM_PROCESSORS];
+    int Line[portNUM_PROCESSORS];
+
+    CritStats_t Stats;                      //Protected by Mux
+}CritSite_t;
+
+#define CRIT_SITE_INIT(SiteName,SiteMux)    { .Name = (SiteName), .Mux = (SiteMux) }
+
+#if CRIT_PROFILING
+#define CRIT_ENTER(Site)        CritProfiler_Enter((Site),pdFALSE,__FILE__,__LINE__)
+#define CRIT_EXIT(Site)         CritProfiler_Exit((Site),pdFALSE)
+#define CRIT_ENTER_ISR(Site)    CritProfiler_Enter((Site),pdTRUE,__FILE__,__LINE__)
+#define CRIT_EXIT_ISR(Site)     CritProfiler_Exit((Site),pdTRUE)
+#else
+#define CRIT_ENTER(Site)        portENTER_CRITICAL((Site)->Mux)
+#define CRIT_EXIT(Site)         portEXIT_CRITICAL((Site)->Mux)
+#define CRIT_ENTER_ISR(Site)    portENTER_CRITICAL_ISR((Site)->Mux)
+#define CRIT_EXIT_ISR(Site)     portEXIT_CRITICAL_ISR((Site)->Mux)
+#endif
+
+static CritSite_t* Crit_Sites;
+static portMUX_TYPE Crit_RegistryLock = portMUX_INITIALIZER_UNLOCKED;
+
+/*---------------------------------------------- Critical section profiler ----------------------------------------------*/
+
+static inline uint32_t CritProfiler_Bucket(uint32_t Cycles)
+{
+    int32_t Bucket = (31 - __builtin_clz(Cycles | 1)) - (CRIT_HIST_SHIFT - 1);
+
+    if(Bucket < 0)
+    {
+        return 0;
+    }
+
+    return (Bucket >= CRIT_HIST_BUCKETS) ? (CRIT_HIST_BUCKETS - 1) : (uint32_t)Bucket;
+}
+
+static void CritProfiler_Register(CritSite_t* Site)
+{
+    portENTER_CRITICAL_SAFE(&Crit_RegistryLock);
+
+    if(Site->Registered == pdFALSE)
+    {
+        Site->Next = Crit_Sites;
+        Crit_Sites = Site;
+        Site->Registered = pdTRUE;
+    }
+
+    portEXIT_CRITICAL_SAFE(&Crit_RegistryLock);
+}
+
+static void CritProfiler_Enter(CritSite_t* Site, BaseType_t FromISR, const char* File, int Line)
+{
+    UBaseType_t Mask, Depth;
+    uint32_t Start;
+    BaseType_t Core;
+
+    //Masking first keeps the task on this core, so both cycle counts are read from the same counter
+    Mask = portSET_INTERRUPT_MASK_FROM_ISR();
+    Start = XTHAL_GET_CCOUNT();
+    Core = xPortGetCoreID();
+
+    if(Site->Registered == pdFALSE)
+    {
+        CritProfiler_Register(Site);
+    }
+
+    if(FromISR == pdTRUE)
+    {
+        portENTER_CRITICAL_ISR(Site->Mux);
+    }
+    else
+    {
+        portENTER_CRITICAL(Site->Mux);
+    }
+
+    Depth = Site->Depth[Core]++;
+    configASSERT(Depth < CRIT_MAX_NESTING);
+    Site->Mask[Core][Depth] = Mask;
+
+    //Only the outermost section of a recursive lock is measured
+    if(Depth == 0)
+    {
+        Site->Start[Core] = Start;
+        Site->Acquired[Core] = XTHAL_GET_CCOUNT();
+        Site->File[Core] = File;
+        Site->Line[Core] = Line;
+    }
+}
+
+static void CritProfiler_Exit(CritSite_t* Site, BaseType_t FromISR)
+{
+    uint32_t End = XTHAL_GET_CCOUNT(), Spin, Hold;
+    BaseType_t Core = xPortGetCoreID();
+    UBaseType_t Mask, Depth;
+    CritStats_t* Stats = &Site->Stats;
+
+    Depth = --Site->Depth[Core];
+    Mask = Site->Mask[Core][Depth];
+
+    if(Depth == 0)
+    {
+        Spin = Site->Acquired[Core] - Site->Start[Core];
+        Hold = End - Site->Acquired[Core];
+
+        Stats->Acquires[Core]++;
+        Stats->SpinCycles += Spin;
+        Stats->HoldCycles += Hold;
+        Stats->SpinHistogram[CritProfiler_Bucket(Spin)]++;
+        Stats->HoldHistogram[CritProfiler_Bucket(Hold)]++;
+
+        if(Spin > Stats->SpinMax)
+        {
+            Stats->SpinMax = Spin;
+        }
+
+        if(Hold > Stats->HoldMax)
+        {
+            Stats->HoldMax = Hold;
+        }
+
+        if((Spin + Hold) > Stats->MaskedMax)
+        {
+            Stats->MaskedMax = Spin + Hold;
+            Stats->MaskedFile = Site->File[Core];
+            Stats->MaskedLine = Site->Line[Core];
+        }
+    }
+
+    if(FromISR == pdTRUE)
+    {
+        portEXIT_CRITICAL_ISR(Site->Mux);
+    }
+    else
+    {
+        portEXIT_CRITICAL(Site->Mux);
+    }
+
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(Mask);
+}
+
+static void CritProfiler_PrintHistogram(const char* Title, const uint32_t* Histogram)
+{
+    uint32_t Loop;
+
+    printf("    %-5s",Title);
+
+    for(Loop = 0; Loop < CRIT_HIST_BUCKETS; Loop++)
+    {
+        if(Histogram[Loop] != 0)
+        {
+            printf(" %s%u:%u",(Loop == (CRIT_HIST_BUCKETS - 1)) ? ">=" : "<",
+                   (Loop == (CRIT_HIST_BUCKETS - 1)) ? (1U << (Loop + CRIT_HIST_SHIFT - 1)) : (1U << (Loop + CRIT_HIST_SHIFT)),
+                   Histogram[Loop]);
+        }
+    }
+
+    printf("\r\n");
+}
+
+static void CritProfiler_Dump(void)
+{
+    CritStats_t Stats;
+    CritSite_t* Site;
+    uint32_t Acquires;
+    UBaseType_t Core;
+
+    printf("Critical sections (cycles, %u MHz)\r\n",CRIT_CPU_MHZ);
+    printf("%-10s %8s %8s %8s %8s %8s %8s %10s  %s\r\n","Site","Core0","Core1","SpinAvg","SpinMax","HoldAvg","HoldMax",
+           "MaskedMax","at");
+
+    for(Site = Crit_Sites; Site != NULL; Site = Site->Next)
+    {
+        portENTER_CRITICAL(Site->Mux);
+        Stats = Site->Stats;
+        portEXIT_CRITICAL(Site->Mux);
+
+        for(Acquires = 0, Core = 0; Core < portNUM_PROCESSORS; Core++)
+        {
+            Acquires += Stats.Acquires[Core];
+        }
+
+        if(Acquires == 0)
+        {
+            continue;
+        }
+
+        printf("%-10s %8u %8u %8llu %8u %8llu %8u %7u us  %s:%d\r\n",Site->Name,Stats.Acquires[0],
+               Stats.Acquires[portNUM_PROCESSORS - 1],Stats.SpinCycles / Acquires,Stats.SpinMax,Stats.HoldCycles / Acquires,
+               Stats.HoldMax,Stats.MaskedMax / CRIT_CPU_MHZ,Stats.MaskedFile,Stats.MaskedLine);
+
+        CritProfiler_PrintHistogram("Spin",Stats.SpinHistogram);
+        CritProfiler_PrintHistogram("Hold",Stats.HoldHistogram);
+    }
+
+    printf("\r\n");
+}
+
+static void CritProfiler_Reset(void)
+{
+    CritSite_t* Site;
+
+    for(Site = Crit_Sites; Site != NULL; Site = Site->Next)
+    {
+        portENTER_CRITICAL(Site->Mux);
+        memset(&Site->Stats,0,sizeof(CritStats_t));
+        portEXIT_CRITICAL(Site->Mux);
+    }
+}
+
+/*---------------------------------------------- Instrumented application ----------------------------------------------*/
+
+static portMUX_TYPE Counter_Mux = portMUX_INITIALIZER_UNLOCKED;
+static portMUX_TYPE Log_Mux = portMUX_INITIALIZER_UNLOCKED;
+
+static CritSite_t Counter_Site = CRIT_SITE_INIT("Counter",&Counter_Mux);
+static CritSite_t Log_Site = CRIT_SITE_INIT("Log",&Log_Mux);
+
+static volatile uint32_t Shared_Counter;
+static char Shared_Log[8][64];
+static uint32_t Shared_LogIndex;
+
+/*Short section hammered from both cores, the spin time shows the contention*/
+static void Counter_Task(void* pvParameters)
+{
+    uint32_t Loop;
+
+    for(;;)
+    {
+        for(Loop = 0; Loop < 1000; Loop++)
+        {
+            CRIT_ENTER(&Counter_Site);
+            Shared_Counter++;
+            CRIT_EXIT(&Counter_Site);
+        }
+
+        vTaskDelay(1);
+    }
+}
+
+/*Formatting inside a critical section, the kind of code which eats the interrupt latency budget*/
+static void Logger_Task(void* pvParameters)
+{
+    uint32_t Value;
+
+    for(;;)
+    {
+        CRIT_ENTER(&Log_Site);
+        Value = Shared_Counter;
+        snprintf(Shared_Log[Shared_LogIndex++ & 7],sizeof(Shared_Log[0]),"Counter value %u at tick %u",Value,
+                 xTaskGetTickCount());
+        CRIT_EXIT(&Log_Site);
+
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+}
+
+static void Interrupt_Handler(void *arg)
+{
+    xt_set_intclear(1 << SW_ISR_LEVEL_3);
+
+    CRIT_ENTER_ISR(&Counter_Site);
+    Shared_Counter += 100;
+    CRIT_EXIT_ISR(&Counter_Site);
+}
+
+static void Interrupt_Generator(void* pvParameters)
+{
+    for(;;)
+    {
+        xt_set_intset(1 << SW_ISR_LEVEL_3);
+        vTaskDelay(pdMS_TO_TICKS(5));
+    }
+}
+
+void app_main(void)
+{
+    esp_intr_alloc(ETS_INTERNAL_SW1_INTR_SOURCE,0,Interrupt_Handler,NULL,NULL);
+
+    xTaskCreatePinnedToCore(Counter_Task,"Counter0",2048,NULL,2,NULL,0);
+    xTaskCreatePinnedToCore(Counter_Task,"Counter1",2048,NULL,2,NULL,1);
+    xTaskCreatePinnedToCore(Logger_Task,"Logger",3072,NULL,3,NULL,1);
+    xTaskCreatePinnedToCore(Interrupt_Generator,"Interrupt",2048,NULL,1,NULL,0);
+
+    for(;;)
+    {
+        vTaskDelay(pdMS_TO_TICKS(5000));
+        CritProfiler_Dump();
+        CritProfiler_Reset();
+    }
+}
@@ -0,0 +1,434 @@
+/**
+ * @file main.c
+ * @author Tushar Uttekar
+ *
+ * @brief
+ *
+ * This example demonstrates a supervisor for periodic tasks which detects deadline misses and overruns and applies a policy
+ * to them, instead of the vTaskDelayUntil loops of example 5, 6 and 8 which silently return at once after an overrun so the
+ * task drifts away from its period without any signal.
+ *
+ * ->Every periodic task is registered with its period, its relative deadline and an overrun policy, the supervisor task which
+ *   runs at the highest priority releases the jobs of all the tasks at their release times with a task notification.
+ * ->A job which completes (the task calls Periodic_Wait again) after its release time plus the deadline is a deadline miss.
+ * ->A job which is still running at the next release time is an overrun, it is detected by the supervisor at that release even
+ *   when the task never comes back, and the policy of the task is applied
+ *   SKIP      The release is dropped, the task keeps its phase and starts again at the following release.
+ *   CATCH_UP  The release is kept as pending and the job runs as soon as the previous one completes, up to
+ *             PERIODIC_MAX_CATCH_UP pending releases, after that the releases are dropped.
+ *   DEGRADE   The release is dropped and the degrade level of the task is raised, Periodic_Wait returns that level so the task
+ *             can shed work, after PERIODIC_RECOVER_JOBS jobs in time the level is lowered again.
+ * ->Every task has counters for releases, jobs, deadline misses, overruns, dropped and caught up releases, and all the events
+ *   are passed to a hook.
+ *
+ * NOTE : The hook is called from the supervisor (overruns, degrade) or from the periodic task (deadline misses), it has to be
+ *        short and must not block.
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "esp_system.h"
+
+#define RTOS                    "freertos"
+
+#define PERIODIC_MAX_TASKS      8
+#define PERIODIC_MAX_CATCH_UP   3
+#define PERIODIC_MAX_LEVEL      3
+#define PERIODIC_RECOVER_JOBS   10
+
+typedef enum
+{
+    PERIODIC_SKIP = 0,
+    PERIODIC_CATCH_UP,
+    PERIODIC_DEGRADE
+}PeriodicPolicy_t;
+
+typedef enum
+{
+    PERIODIC_EVENT_DEADLINE_MISS = 0,       //Job completed after its deadline
+    PERIODIC_EVENT_OVERRUN,                 //Job still running at the next release
+    PERIODIC_EVENT_DEGRADE,                 //Degrade level raised
+    PERIODIC_EVENT_RECOVER                  //Degrade level lowered
+}PeriodicEvent_t;
+
+typedef struct
+{
+    uint32_t Releases;
+    uint32_t Jobs;
+    uint32_t DeadlineMisses;
+    uint32_t Overruns;
+    uint32_t Dropped;
+    uint32_t CaughtUp;
+    TickType_t WorstLateness;               //Completion time after the deadline
+}PeriodicStats_t;
+
+typedef struct
+{
+    const char* Name;
+    TickType_t Period;
+    TickType_t Deadline;
+    PeriodicPolicy_t Policy;
+    TaskHandle_t Task;
+
+    //Shared between the supervisor and the task, protected by Periodic_Lock
+    TickType_t NextRelease;
+    TickType_t Release;                     //Release time of the current job
+    BaseType_t Completed;                   //pdTRUE while the task is waiting for its next release
+    BaseType_t Started;
+    UBaseType_t Pending;                    //Releases kept by the CATCH_UP policy
+    UBaseType_t Level;                      //Degrade level of the DEGRADE policy
+    UBaseType_t InTime;                     //Jobs in time since the last change of the level
+    PeriodicStats_t Stats;
+}Periodic_t;
+
+typedef void (*PeriodicHook_t)(const Periodic_t* Periodic, PeriodicEvent_t Event, TickType_t Lateness);
+
+static Periodic_t* Periodic_Tasks[PERIODIC_MAX_TASKS];
+static UBaseType_t Periodic_Count;
+static PeriodicHook_t Periodic_Hook;
+static TaskHandle_t Periodic_Supervisor;
+static portMUX_TYPE Periodic_Lock = portMUX_INITIALIZER_UNLOCKED;
+
+/*---------------------------------------------- Periodic task supervisor ----------------------------------------------*/
+
+static void Periodic_Emit(const Periodic_t* Periodic, PeriodicEvent_t Event, TickType_t Lateness)
+{
+    if(Periodic_Hook != NULL)
+    {
+        Periodic_Hook(Periodic,Event,Lateness);
+    }
+}
+
+/*Called by the supervisor at every release time of the task*/
+static void Periodic_Release(Periodic_t* Periodic, TickType_t Release)
+{
+    BaseType_t Released = pdFALSE, Degraded = pdFALSE;
+    TickType_t Lateness;
+
+    portENTER_CRITICAL(&Periodic_Lock);
+
+    if(Periodic->Completed == pdTRUE)
+    {
+        Periodic->Completed = pdFALSE;
+        Periodic->Release = Release;
+        Periodic->Stats.Releases++;
+        Released = pdTRUE;
+    }
+    else
+    {
+        Periodic->Stats.Overruns++;
+
+        if((Periodic->Policy == PERIODIC_CATCH_UP) && (Periodic->Pending < PERIODIC_MAX_CATCH_UP))
+        {
+            Periodic->Pending++;
+        }
+        else
+        {
+            Periodic->Stats.Dropped++;
+        }
+
+        if((Periodic->Policy == PERIODIC_DEGRADE) && (Periodic->Level < PERIODIC_MAX_LEVEL))
+        {
+            Periodic->Level++;
+            Periodic->InTime = 0;
+            Degraded = pdTRUE;
+        }
+    }
+
+    Lateness = Release - Periodic->Release;
+
+    portEXIT_CRITICAL(&Periodic_Lock);
+
+    if(Released == pdTRUE)
+    {
+        xTaskNotifyGive(Periodic->Task);
+    }
+    else
+    {
+        Periodic_Emit(Periodic,PERIODIC_EVENT_OVERRUN,Lateness);
+
+        if(Degraded == pdTRUE)
+        {
+            Periodic_Emit(Periodic,PERIODIC_EVENT_DEGRADE,Lateness);
+        }
+    }
+}
+
+static void Periodic_SupervisorTask(void* pvParameters)
+{
+    TickType_t Now, Sleep;
+    UBaseType_t Loop, Count;
+
+    for(;;)
+    {
+        Now = xTaskGetTickCount();
+        Sleep = portMAX_DELAY;
+
+        //The entries below the count are complete once the count is read under the lock, Periodic_Create appends under it
+        portENTER_CRITICAL(&Periodic_Lock);
+        Count = Periodic_Count;
+        portEXIT_CRITICAL(&Periodic_Lock);
+
+        for(Loop = 0; Loop < Count; Loop++)
+        {
+            //Releases every time which has passed, also the ones missed when the supervisor itself was late
+            while((int32_t)(Now - Periodic_Tasks[Loop]->NextRelease) >= 0)
+            {
+                Periodic_Release(Periodic_Tasks[Loop],Periodic_Tasks[Loop]->NextRelease);
+                Periodic_Tasks[Loop]->NextRelease += Periodic_Tasks[Loop]->Period;
+            }
+
+            if((TickType_t)(Periodic_Tasks[Loop]->NextRelease - Now) < Sleep)
+            {
+                Sleep = Periodic_Tasks[Loop]->NextRelease - Now;
+            }
+        }
+
+        //Woken up early by Periodic_Create when a new task is added
+        ulTaskNotifyTake(pdTRUE,Sleep);
+    }
+}
+
+/*Called by the periodic task at the top of its loop, completes the previous job and blocks until the next release, returns the
+  degrade level which the job should run with*/
+static UBaseType_t Periodic_Wait(Periodic_t* Periodic)
+{
+    TickType_t Now = xTaskGetTickCount(), Lateness = 0;
+    BaseType_t Missed = pdFALSE, Recovered = pdFALSE, CatchUp = pdFALSE;
+    UBaseType_t Level;
+
+    portENTER_CRITICAL(&Periodic_Lock);
+
+    if(Periodic->Started == pdTRUE)
+    {
+        Periodic->Stats.Jobs++;
+
+        if((Now - Periodic->Release) > Periodic->Deadline)
+        {
+            Lateness = Now - Periodic->Release - Periodic->Deadline;
+            Periodic->Stats.DeadlineMisses++;
+            Periodic->InTime = 0;
+            Missed = pdTRUE;
+
+            if(Lateness > Periodic->Stats.WorstLateness)
+            {
+                Periodic->Stats.WorstLateness = Lateness;
+            }
+        }
+        else if((Periodic->Level > 0) && (++Periodic->InTime >= PERIODIC_RECOVER_JOBS))
+        {
+            Periodic->Level--;
+            Periodic->InTime = 0;
+            Recovered = pdTRUE;
+        }
+    }
+
+    Periodic->Started = pdTRUE;
+
+    if(Periodic->Pending > 0)
+    {
+        //The job of the kept release runs at once, its deadline is still counted from the release time it belongs to
+        Periodic->Pending--;
+        Periodic->Release += Periodic->Period;
+        Periodic->Stats.CaughtUp++;
+        Periodic->Stats.Releases++;
+        CatchUp = pdTRUE;
+    }
+    else
+    {
+        Periodic->Completed = pdTRUE;
+    }
+
+    portEXIT_CRITICAL(&Periodic_Lock);
+
+    if(Missed == pdTRUE)
+    {
+        Periodic_Emit(Periodic,PERIODIC_EVENT_DEADLINE_MISS,Lateness);
+    }
+
+    if(Recovered == pdTRUE)
+    {
+        Periodic_Emit(Periodic,PERIODIC_EVENT_RECOVER,0);
+    }
+
+    if(CatchUp == pdFALSE)
+    {
+        ulTaskNotifyTake(pdTRUE,portMAX_DELAY);
+    }
+
+    portENTER_CRITICAL(&Periodic_Lock);
+    Level = Periodic->Level;
+    portEXIT_CRITICAL(&Periodic_Lock);
+
+    return Level;
+}
+
+/*Creates the supervisor on the first call*/
+static BaseType_t Periodic_Create(Periodic_t* Periodic, const char* Name, TaskFunction_t Function, TickType_t Period,
+                                  TickType_t Deadline, PeriodicPolicy_t Policy, UBaseType_t Priority)
+{
+    BaseType_t xStatus;
+
+    if((Periodic_Count >= PERIODIC_MAX_TASKS) || (Period == 0) || (Deadline == 0) || (Deadline > Period))
+    {
+        return pdFAIL;
+    }
+
+    if(Periodic_Supervisor == NULL)
+    {
+        xStatus = xTaskCreate(Periodic_SupervisorTask,"Supervisor",2048,NULL,configMAX_PRIORITIES - 1,&Periodic_Supervisor);
+
+        if(xStatus != pdPASS)
+        {
+            return pdFAIL;
+        }
+    }
+
+    Periodic->Name = Name;
+    Periodic->Period = Period;
+    Periodic->Deadline = Deadline;
+    Periodic->Policy = Policy;
+    Periodic->Completed = pdTRUE;
+    Periodic->Started = pdFALSE;
+    Periodic->Pending = 0;
+    Periodic->Level = 0;
+    Periodic->InTime = 0;
+    Periodic->Stats = (PeriodicStats_t){0};
+
+    xStatus = xTaskCreate(Function,Name,2048,Periodic,Priority,&Periodic->Task);
+
+    if(xStatus == pdPASS)
+    {
+        portENTER_CRITICAL(&Periodic_Lock);
+
+        //A create running at the same time may have taken the last entry after the check above
+        if(Periodic_Count < PERIODIC_MAX_TASKS)
+        {
+            Periodic->NextRelease = xTaskGetTickCount() + Period;
+            Periodic_Tasks[Periodic_Count] = Periodic;
+            Periodic_Count++;
+        }
+        else
+        {
+            xStatus = pdFAIL;
+        }
+
+        portEXIT_CRITICAL(&Periodic_Lock);
+
+        if(xStatus == pdPASS)
+        {
+            xTaskNotifyGive(Periodic_Supervisor);
+        }
+        else
+        {
+            vTaskDelete(Periodic->Task);
+        }
+    }
+
+    return xStatus;
+}
+
+static void Periodic_SetHook(PeriodicHook_t Hook)
+{
+    Periodic_Hook = Hook;
+}
+
+static void Periodic_PrintStats(void)
+{
+    static const char* const Policies[] = {"SKIP","CATCH_UP","DEGRADE"};
+    PeriodicStats_t Stats;
+    UBaseType_t Loop, Level, Count;
+
+    printf("%-10s %-9s %8s %8s %8s %8s %8s %8s %6s %5s\r\n","Task","Policy","Release","Jobs","DlMiss","Overrun","Dropped",
+           "CatchUp","Worst","Level");
+
+    portENTER_CRITICAL(&Periodic_Lock);
+    Count = Periodic_Count;
+    portEXIT_CRITICAL(&Periodic_Lock);
+
+    for(Loop = 0; Loop < Count; Loop++)
+    {
+        portENTER_CRITICAL(&Periodic_Lock);
+        Stats = Periodic_Tasks[Loop]->Stats;
+        Level = Periodic_Tasks[Loop]->Level;
+        portEXIT_CRITICAL(&Periodic_Lock);
+
+        printf("%-10s %-9s %8u %8u %8u %8u %8u %8u %6u %5u\r\n",Periodic_Tasks[Loop]->Name,
+               Policies[Periodic_Tasks[Loop]->Policy],Stats.Releases,Stats.Jobs,Stats.DeadlineMisses,Stats.Overruns,
+               Stats.Dropped,Stats.CaughtUp,Stats.WorstLateness,Level);
+    }
+
+    printf("\r\n");
+}
+
+/*---------------------------------------------- Control loops ----------------------------------------------*/
+
+static volatile BaseType_t Overload = pdFALSE;
+
+/*Busy work which simulates the computation of the control loop*/
+static void Control_Work(uint32_t Microseconds)
+{
+    int64_t Start = esp_timer_get_time();
+
+    while((esp_timer_get_time() - Start) < Microseconds);
+}
+
+static void Control_Task(void* pvParameters)
+{
+    Periodic_t* Periodic = (Periodic_t*) pvParameters;
+    UBaseType_t Level;
+    uint32_t Work;
+
+    for(;;)
+    {
+        Level = Periodic_Wait(Periodic);
+
+        //20 ms of work normally, 70 ms during the overload, every degrade level halves the optional part of the work
+        Work = (Overload == pdTRUE) ? 70000 : 20000;
+        Work = 10000 + ((Work - 10000) >> Level);
+
+        Control_Work(Work);
+    }
+}
+
+static void Supervisor_Hook(const Periodic_t* Periodic, PeriodicEvent_t Event, TickType_t Lateness)
+{
+    if(Event == PERIODIC_EVENT_DEGRADE)
+    {
+        ESP_LOGW(RTOS,"%s degraded to level %u\r\n",Periodic->Name,Periodic->Level);
+    }
+    else if(Event == PERIODIC_EVENT_RECOVER)
+    {
+        ESP_LOGI(RTOS,"%s recovered to level %u\r\n",Periodic->Name,Periodic->Level);
+    }
+}
+
+static Periodic_t Control_Skip, Control_CatchUp, Control_Degrade;
+
+void app_main(void)
+{
+    Periodic_SetHook(Supervisor_Hook);
+
+    //Same period, deadline and load for all three loops, only the policy differs
+    Periodic_Create(&Control_Skip,"Skip",Control_Task,pdMS_TO_TICKS(50),pdMS_TO_TICKS(40),PERIODIC_SKIP,2);
+    Periodic_Create(&Control_CatchUp,"CatchUp",Control_Task,pdMS_TO_TICKS(50),pdMS_TO_TICKS(40),PERIODIC_CATCH_UP,2);
+    Periodic_Create(&Control_Degrade,"Degrade",Control_Task,pdMS_TO_TICKS(50),pdMS_TO_TICKS(40),PERIODIC_DEGRADE,2);
+
+    for(;;)
+    {
+        vTaskDelay(pdMS_TO_TICKS(3000));
+        Overload = pdTRUE;
+        printf("Overload started\r\n");
+        vTaskDelay(pdMS_TO_TICKS(1000));
+        Overload = pdFALSE;
+        Periodic_PrintStats();
+    }
+}
@@ -0,0 +1,422 @@
+/**
+ * @file main.c
+ * @author Tushar Uttekar
+ *
+ * @brief
+ *
+ * This example demonstrates event flags which an interrupt sets directly, without the hop through the timer daemon which
+ * xEventGroupSetBitsFromISR takes in example 22. The stock call only posts a command to the daemon's queue, the waiting task is
+ * unblocked when the daemon gets to run, so the latency depends on the priority of the daemon and on everything above it.
+ *
+ * ->The flags are one 32 bit word which is changed with atomic operations, the waiters are kept in a table of
+ *   ISR_FLAGS_MAX_WAITERS slots.
+ * ->A waiter claims a free slot, writes its task, mask and mode into it and arms it, then checks the flags once more before it
+ *   blocks on its task notification, so a set which happens in between is never missed.
+ * ->IsrFlags_SetFromISR sets the bits and walks the table once, every armed waiter whose condition is met is moved from ARMED
+ *   to WOKEN with a compare and swap and notified with vTaskNotifyGiveFromISR. There is no lock, and the time in the interrupt
+ *   is bounded by the size of the table.
+ *
+ * The benchmark at the start measures the cycles from the interrupt to the waiting task running, for the stock event group and
+ * for these flags, once on an idle core and once from inside the busy window of a task between the priority of the daemon and
+ * the waiter, so the daemon can not run until the busy task is done. After that the tasks of example 22 run on the flags, with
+ * the ISR bit set directly from the interrupt.
+ *
+ * NOTE : The waiting uses the task notification, a task which waits on these flags can not use its notification for something
+ *        else at the same time. The benchmark runs on the target as there is no host port in this project.
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/event_groups.h"
+#include "freertos/portmacro.h"
+#include "freertos/xtensa_api.h"
+#include "xtensa/core-macros.h"
+#include "esp_intr_alloc.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "esp_system.h"
+
+#define SW_ISR_LEVEL_3          29
+#define FIRST_BIT_SET           (1 << 0)
+#define SECOND_BIT_SET          (1 << 1)
+#define ISR_BIT_SET             (1 << 2)
+
+#define ISR_FLAGS_MAX_WAITERS   8
+
+typedef enum
+{
+    WAITER_FREE = 0,
+    WAITER_CLAIMED,                         //Being filled in by the waiter, ignored by the setters
+    WAITER_ARMED,
+    WAITER_WOKEN
+}WaiterState_t;
+
+typedef struct
+{
+    volatile uint32_t State;
+    TaskHandle_t Task;
+    uint32_t Mask;
+    BaseType_t WaitAll;
+}IsrWaiter_t;
+
+typedef struct
+{
+    volatile uint32_t Bits;
+    IsrWaiter_t Waiters[ISR_FLAGS_MAX_WAITERS];
+}IsrFlags_t;
+
+/*---------------------------------------------- Direct ISR event flags ----------------------------------------------*/
+
+static inline BaseType_t IsrFlags_Satisfied(uint32_t Bits, uint32_t Mask, BaseType_t WaitAll)
+{
+    return (WaitAll == pdTRUE) ? ((Bits & Mask) == Mask) : ((Bits & Mask) != 0);
+}
+
+static void IsrFlags_Init(IsrFlags_t* Flags)
+{
+    UBaseType_t Loop;
+
+    Flags->Bits = 0;
+
+    for(Loop = 0; Loop < ISR_FLAGS_MAX_WAITERS; Loop++)
+    {
+        Flags->Waiters[Loop].State = WAITER_FREE;
+    }
+}
+
+/*Bounded walk over the waiter table, every armed waiter whose condition is met by Bits is notified*/
+static inline void IsrFlags_Wake(IsrFlags_t* Flags, uint32_t Bits, BaseType_t FromISR, BaseType_t* pxHigherPriorityTaskWoken)
+{
+    IsrWaiter_t* Waiter;
+    uint32_t Expected;
+    UBaseType_t Loop;
+
+    for(Loop = 0; Loop < ISR_FLAGS_MAX_WAITERS; Loop++)
+    {
+        Waiter = &Flags->Waiters[Loop];
+
+        if((__atomic_load_n(&Waiter->State,__ATOMIC_SEQ_CST) != WAITER_ARMED) ||
+           (IsrFlags_Satisfied(Bits,Waiter->Mask,Waiter->WaitAll) == pdFALSE))
+        {
+            continue;
+        }
+
+        //Only one setter wins the waiter, the others see it WOKEN and leave it alone
+        Expected = WAITER_ARMED;
+
+        if(__atomic_compare_exchange_n(&Waiter->State,&Expected,WAITER_WOKEN,pdFALSE,__ATOMIC_SEQ_CST,__ATOMIC_SEQ_CST))
+        {
+            if(FromISR == pdTRUE)
+            {
+                vTaskNotifyGiveFromISR(Waiter->Task,pxHigherPriorityTaskWoken);
+            }
+            else
+            {
+                xTaskNotifyGive(Waiter->Task);
+            }
+        }
+    }
+}
+
+static uint32_t IsrFlags_SetFromISR(IsrFlags_t* Flags, uint32_t SetBits, BaseType_t* pxHigherPriorityTaskWoken)
+{
+    uint32_t Bits = __atomic_or_fetch(&Flags->Bits,SetBits,__ATOMIC_SEQ_CST);
+
+    IsrFlags_Wake(Flags,Bits,pdTRUE,pxHigherPriorityTaskWoken);
+
+    return Bits;
+}
+
+static uint32_t IsrFlags_Set(IsrFlags_t* Flags, uint32_t SetBits)
+{
+    uint32_t Bits = __atomic_or_fetch(&Flags->Bits,SetBits,__ATOMIC_SEQ_CST);
+
+    IsrFlags_Wake(Flags,Bits,pdFALSE,NULL);
+
+    return Bits;
+}
+
+static uint32_t IsrFlags_Clear(IsrFlags_t* Flags, uint32_t ClearBits)
+{
+    return __atomic_fetch_and(&Flags->Bits,~ClearBits,__ATOMIC_SEQ_CST);
+}
+
+/*Returns the bits at the time the condition was met, or the current bits after a timeout (check them against the Mask)*/
+static uint32_t IsrFlags_Wait(IsrFlags_t* Flags, uint32_t Mask, BaseType_t ClearOnExit, BaseType_t WaitAll, TickType_t Timeout)
+{
+    IsrWaiter_t* Waiter = NULL;
+    TimeOut_t TimeOut;
+    uint32_t Bits, Expected;
+    UBaseType_t Loop;
+
+    Bits = __atomic_load_n(&Flags->Bits,__ATOMIC_SEQ_CST);
+
+    if((IsrFlags_Satisfied(Bits,Mask,WaitAll) == pdTRUE) || (Timeout == 0))
+    {
+        if((ClearOnExit == pdTRUE) && (IsrFlags_Satisfied(Bits,Mask,WaitAll) == pdTRUE))
+        {
+            Bits = IsrFlags_Clear(Flags,Mask);
+        }
+
+        return Bits;
+    }
+
+    for(Loop = 0; (Loop < ISR_FLAGS_MAX_WAITERS) && (Waiter == NULL); Loop++)
+    {
+        Expected = WAITER_FREE;
+
+        if(__atomic_compare_exchange_n(&Flags->Waiters[Loop].State,&Expected,WAITER_CLAIMED,pdFALSE,__ATOMIC_SEQ_CST,
+                                       __ATOMIC_SEQ_CST))
+        {
+            Waiter = &Flags->Waiters[Loop];
+        }
+    }
+
+    configASSERT(Waiter != NULL);
+
+    if(Waiter == NULL)
+    {
+        return Bits;
+    }
+
+    Waiter->Task = xTaskGetCurrentTaskHandle();
+    Waiter->Mask = Mask;
+    Waiter->WaitAll = WaitAll;
+    vTaskSetTimeOutState(&TimeOut);
+
+    for(;;)
+    {
+        //Armed before the flags are checked again, a setter which comes after the check sees the waiter
+        __atomic_store_n(&Waiter->State,WAITER_ARMED,__ATOMIC_SEQ_CST);
+        Bits = __atomic_load_n(&Flags->Bits,__ATOMIC_SEQ_CST);
+
+        if(IsrFlags_Satisfied(Bits,Mask,WaitAll) == pdTRUE)
+        {
+            break;
+        }
+
+        if(xTaskCheckForTimeOut(&TimeOut,&Timeout) == pdTRUE)
+        {
+            break;
+        }
+
+        //A notification left over from a setter which lost the race with the check above only causes one more pass
+        ulTaskNotifyTake(pdTRUE,Timeout);
+    }
+
+    __atomic_store_n(&Waiter->State,WAITER_FREE,__ATOMIC_SEQ_CST);
+
+    if((ClearOnExit == pdTRUE) && (IsrFlags_Satisfied(Bits,Mask,WaitAll) == pdTRUE))
+    {
+        Bits = IsrFlags_Clear(Flags,Mask);
+    }
+
+    return Bits;
+}
+
+/*---------------------------------------------- Latency benchmark ----------------------------------------------*/
+
+typedef enum
+{
+    BENCH_STOCK = 0,
+    BENCH_DIRECT,
+    BENCH_DONE                              //Benchmark finished, the interrupt sets the flags of the example 22 tasks
+}BenchPath_t;
+
+typedef struct
+{
+    uint32_t Samples;
+    uint64_t Cycles;
+    uint32_t Min;
+    uint32_t Max;
+}BenchStats_t;
+
+#define BENCH_SAMPLES           200
+
+static EventGroupHandle_t EventGroup_Handle;
+static IsrFlags_t IsrFlags, AppFlags;
+static volatile BenchPath_t Bench_Path;
+static volatile uint32_t Bench_Stamp;
+static volatile BaseType_t Bench_Load;
+static BenchStats_t Bench_Stats[2];
+
+static void Bench_Record(BenchPath_t Path)
+{
+    uint32_t Cycles = XTHAL_GET_CCOUNT() - Bench_Stamp;
+    BenchStats_t* Stats = &Bench_Stats[Path];
+
+    Stats->Samples++;
+    Stats->Cycles += Cycles;
+    Stats->Min = (Cycles < Stats->Min) ? Cycles : Stats->Min;
+    Stats->Max = (Cycles > Stats->Max) ? Cycles : Stats->Max;
+}
+
+static void Interrupt_Handler(void* arg)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    xt_set_intclear(1 << SW_ISR_LEVEL_3);
+
+    Bench_Stamp = XTHAL_GET_CCOUNT();
+
+    if(Bench_Path == BENCH_STOCK)
+    {
+        //Posts a command to the timer daemon, the waiter runs after the daemon has processed it
+        xEventGroupSetBitsFromISR(EventGroup_Handle,ISR_BIT_SET,&xHigherPriorityTaskWoken);
+    }
+    else if(Bench_Path == BENCH_DIRECT)
+    {
+        IsrFlags_SetFromISR(&IsrFlags,ISR_BIT_SET,&xHigherPriorityTaskWoken);
+    }
+    else
+    {
+        IsrFlags_SetFromISR(&AppFlags,ISR_BIT_SET,&xHigherPriorityTaskWoken);
+    }
+
+    portYIELD_FROM_ISR();
+}
+
+static void StockWaiter_Task(void* pvParameters)
+{
+    for(;;)
+    {
+        xEventGroupWaitBits(EventGroup_Handle,ISR_BIT_SET,pdTRUE,pdTRUE,portMAX_DELAY);
+        Bench_Record(BENCH_STOCK);
+    }
+}
+
+static void DirectWaiter_Task(void* pvParameters)
+{
+    for(;;)
+    {
+        if((IsrFlags_Wait(&IsrFlags,ISR_BIT_SET,pdTRUE,pdTRUE,portMAX_DELAY) & ISR_BIT_SET) != 0)
+        {
+            Bench_Record(BENCH_DIRECT);
+        }
+    }
+}
+
+/*Busy task above the timer daemon and below the waiters, raises the interrupt in the middle of its busy window so the daemon
+  is kept from running while the interrupt is handled*/
+static void Load_Task(void* pvParameters)
+{
+    int64_t Start;
+
+    for(;;)
+    {
+        if(Bench_Load == pdTRUE)
+        {
+            Start = esp_timer_get_time();
+            while((esp_timer_get_time() - Start) < 1000);
+
+            if(Bench_Load == pdTRUE)
+            {
+                xt_set_intset(1 << SW_ISR_LEVEL_3);
+            }
+
+            while((esp_timer_get_time() - Start) < 2000);
+        }
+
+        vTaskDelay(1);
+    }
+}
+
+static void Benchmark_Task(void* pvParameters)
+{
+    static const char* const Paths[] = {"xEventGroupSetBitsFromISR","IsrFlags_SetFromISR"};
+    uint32_t Path, Load, Loop;
+    BenchStats_t* Stats;
+
+    printf("%-26s %-5s %8s %8s %8s %8s\r\n","Path","Load","Samples","MinCyc","AvgCyc","MaxCyc");
+
+    for(Load = 0; Load < 2; Load++)
+    {
+        for(Path = BENCH_STOCK; Path <= BENCH_DIRECT; Path++)
+        {
+            Stats = &Bench_Stats[Path];
+            *Stats = (BenchStats_t){.Min = UINT32_MAX};
+            Bench_Path = (BenchPath_t)Path;
+
+            if(Load == 0)
+            {
+                for(Loop = 0; Loop < BENCH_SAMPLES; Loop++)
+                {
+                    xt_set_intset(1 << SW_ISR_LEVEL_3);
+                    vTaskDelay(pdMS_TO_TICKS(10) + (esp_random() & 1));
+                }
+            }
+            else
+            {
+                //The interrupts come from the load task, one per tick while it is busy
+                Bench_Load = pdTRUE;
+
+                while(Stats->Samples < BENCH_SAMPLES)
+                {
+                    vTaskDelay(pdMS_TO_TICKS(10));
+                }
+
+                //The last interrupt raised may still be on its way to the waiter
+                Bench_Load = pdFALSE;
+                vTaskDelay(pdMS_TO_TICKS(20));
+            }
+
+            printf("%-26s %-5s %8u %8u %8llu %8u\r\n",Paths[Path],(Load != 0) ? "busy" : "idle",Stats->Samples,
+                   Stats->Min,(Stats->Samples != 0) ? (Stats->Cycles / Stats->Samples) : 0,Stats->Max);
+        }
+    }
+
+    Bench_Load = pdFALSE;
+    Bench_Path = BENCH_DONE;
+
+    //Continues as the writing task and the interrupt generator of example 22
+    for(;;)
+    {
+        vTaskDelay(pdMS_TO_TICKS(200));
+        printf("Setting the BIT 1-\t From the Bit Writting Task.\r\n");
+        IsrFlags_Set(&AppFlags,FIRST_BIT_SET);
+
+        vTaskDelay(pdMS_TO_TICKS(100));
+        xt_set_intset(1 << SW_ISR_LEVEL_3);
+
+        vTaskDelay(pdMS_TO_TICKS(100));
+        printf("Setting the BIT 2-\t From the Bit Writting Task.\r\n");
+        IsrFlags_Set(&AppFlags,SECOND_BIT_SET);
+    }
+}
+
+static void EventBitRead_Task(void* pvParameters)
+{
+    uint32_t EventGroupBit;
+
+    for(;;)
+    {
+        EventGroupBit = IsrFlags_Wait(&AppFlags,FIRST_BIT_SET | SECOND_BIT_SET | ISR_BIT_SET,pdTRUE,pdTRUE,portMAX_DELAY);
+
+        if((EventGroupBit & ISR_BIT_SET) != 0)
+        {
+            printf("All bits were set, ISR bit included-\t From the Bit Reading Task.\r\n");
+        }
+    }
+}
+
+void app_main(void)
+{
+    EventGroup_Handle = xEventGroupCreate();
+    IsrFlags_Init(&IsrFlags);
+    IsrFlags_Init(&AppFlags);
+
+    //Everything on core 0, the interrupt is allocated on the core which calls esp_intr_alloc and the cycle counter is per core
+    xTaskCreatePinnedToCore(StockWaiter_Task,"StockWaiter",2048,NULL,6,NULL,0);
+    xTaskCreatePinnedToCore(DirectWaiter_Task,"DirectWaiter",2048,NULL,6,NULL,0);
+    xTaskCreatePinnedToCore(Load_Task,"Load",2048,NULL,4,NULL,0);
+    xTaskCreatePinnedToCore(Benchmark_Task,"Benchmark",3072,NULL,2,NULL,0);
+    xTaskCreatePinnedToCore(EventBitRead_Task,"Event_Read",2048,NULL,3,NULL,0);
+
+    esp_intr_alloc(ETS_INTERNAL_SW1_INTR_SOURCE,0,Interrupt_Handler,NULL,NULL);
+}
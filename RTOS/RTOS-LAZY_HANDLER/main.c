@@ -0,0 +1,444 @@
+/**
+ * @file main.c
+ * @author Tushar Uttekar
+ *
+ * @brief
+ *
+ * This example demonstrates handlers which are created on demand. The app_main of the examples creates every task at boot with
+ * its full stack, the Handler of example 16 and 24 included, even when the interrupt behind it never fires. With many fault
+ * and maintenance handlers that are idle almost all the time most of the RAM is stacks which are never used.
+ *
+ * A handler is described by a LazyHandler_t and registered with LazyHandler_Register, which only puts it into the registry.
+ * ->The first event posted to the handler asks the spawner task to create the task of the handler, with its stack.
+ * ->Events are kept in a small ring inside the handler, so the events which come while the task is being created are not lost,
+ *   LazyHandler_Post and LazyHandler_PostFromISR never block.
+ * ->With an IdleTimeoutMs the task deletes itself when no event has come for that long and the handler is dormant again, the next
+ *   event creates it again. With 0 the task stays once it has been created.
+ * ->LazyHandler_Report prints the handlers, how often they were created, the latency of the first event (posted until the handler
+ *   runs) and what has been saved against creating everything at boot, the RAM of the stacks and the task control blocks which
+ *   are not resident and the boot time, from the average time of the creations which have been done.
+ *
+ * The example registers 64 fault handlers which see a fault now and then, the Handler of example 16 fed by the software
+ * interrupt every 500 ms as before, and a maintenance handler which runs every 10 seconds and is torn down in between.
+ *
+ * NOTE : The task of a handler is created by the spawner, so a handler which is dormant sees its first event a task creation
+ *        later than an eager one, the first event latency of the report shows how much.
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/portmacro.h"
+#include "freertos/xtensa_api.h"
+#include "xtensa/core-macros.h"
+#include "esp_intr_alloc.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "esp_system.h"
+
+#define RTOS                    "FREERTOS"
+#define SW_ISR_LEVEL_3          29
+
+#define LAZY_MAX_HANDLERS       80
+#define LAZY_EVENTS             8           //Events kept for a handler until its task takes them
+#define LAZY_SPAWNER_PRIORITY   10
+#define LAZY_TCB_BYTES          sizeof(StaticTask_t)    //Size of a task control block of this port, for the report
+
+typedef enum
+{
+    LAZY_DORMANT = 0,
+    LAZY_CREATING,
+    LAZY_RUNNING
+}LazyState_t;
+
+typedef void (*LazyFunction_t)(void* Arg, uint32_t Event);
+
+typedef struct
+{
+    const char* Name;
+    LazyFunction_t Function;
+    void* Arg;
+    uint32_t StackSize;
+    UBaseType_t Priority;
+    BaseType_t Core;
+    uint32_t IdleTimeoutMs;                 //0 keeps the task once it has been created
+
+    //State of the handler, protected by Lock
+    portMUX_TYPE Lock;
+    volatile LazyState_t State;
+    TaskHandle_t Task;
+    uint32_t Events[LAZY_EVENTS];
+    uint32_t Head;
+    uint32_t Count;
+    int64_t PostedAt;                       //First event of a creation
+
+    //Statistics
+    uint32_t Posted;
+    uint32_t Dropped;
+    uint32_t Creations;
+    uint32_t Failures;
+    uint32_t FirstLatencyMaxUs;
+    uint64_t FirstLatencyUs;
+}LazyHandler_t;
+
+#define LAZY_HANDLER_INIT(HandlerName,HandlerFunction,HandlerArg,Stack,HandlerPriority,HandlerCore,IdleMs)    \
+    { .Name = (HandlerName), .Function = (HandlerFunction), .Arg = (HandlerArg), .StackSize = (Stack),         \
+      .Priority = (HandlerPriority), .Core = (HandlerCore), .IdleTimeoutMs = (IdleMs),                          \
+      .Lock = portMUX_INITIALIZER_UNLOCKED }
+
+static LazyHandler_t* Lazy_Handlers[LAZY_MAX_HANDLERS];
+static uint32_t Lazy_HandlerCount;
+static QueueHandle_t Lazy_SpawnQueue;
+static uint64_t Lazy_CreateUs;
+static uint32_t Lazy_CreateCount;
+
+/*---------------------------------------------- Lazy handlers ----------------------------------------------*/
+
+static BaseType_t LazyHandler_Register(LazyHandler_t* Handler)
+{
+    if(Lazy_HandlerCount == LAZY_MAX_HANDLERS)
+    {
+        return pdFAIL;
+    }
+
+    Handler->State = LAZY_DORMANT;
+    Lazy_Handlers[Lazy_HandlerCount++] = Handler;
+
+    return pdPASS;
+}
+
+/*Puts the event into the ring, returns what the caller has to do to get it handled and the task to notify*/
+static LazyState_t LazyHandler_Push(LazyHandler_t* Handler, uint32_t Event, TaskHandle_t* Task)
+{
+    LazyState_t State;
+
+    portENTER_CRITICAL_SAFE(&Handler->Lock);
+
+    Handler->Posted++;
+
+    if(Handler->Count == LAZY_EVENTS)
+    {
+        Handler->Dropped++;
+    }
+    else
+    {
+        Handler->Events[(Handler->Head + Handler->Count++) % LAZY_EVENTS] = Event;
+    }
+
+    //The dormant state is left here, so only one post asks the spawner for the task
+    State = Handler->State;
+    *Task = Handler->Task;
+
+    if(State == LAZY_DORMANT)
+    {
+        Handler->State = LAZY_CREATING;
+        Handler->PostedAt = esp_timer_get_time();
+    }
+
+    portEXIT_CRITICAL_SAFE(&Handler->Lock);
+
+    return State;
+}
+
+static BaseType_t LazyHandler_Post(LazyHandler_t* Handler, uint32_t Event)
+{
+    TaskHandle_t Task;
+    LazyState_t State = LazyHandler_Push(Handler,Event,&Task);
+
+    if(State == LAZY_DORMANT)
+    {
+        return xQueueSendToBack(Lazy_SpawnQueue,&Handler,portMAX_DELAY);
+    }
+
+    if(State == LAZY_RUNNING)
+    {
+        xTaskNotifyGive(Task);
+    }
+
+    return pdPASS;
+}
+
+static BaseType_t LazyHandler_PostFromISR(LazyHandler_t* Handler, uint32_t Event, BaseType_t* pxHigherPriorityTaskWoken)
+{
+    TaskHandle_t Task;
+    LazyState_t State = LazyHandler_Push(Handler,Event,&Task);
+
+    if(State == LAZY_DORMANT)
+    {
+        return xQueueSendToBackFromISR(Lazy_SpawnQueue,&Handler,pxHigherPriorityTaskWoken);
+    }
+
+    if(State == LAZY_RUNNING)
+    {
+        vTaskNotifyGiveFromISR(Task,pxHigherPriorityTaskWoken);
+    }
+
+    return pdPASS;
+}
+
+static void LazyHandler_Task(void* pvParameters)
+{
+    LazyHandler_t* Handler = (LazyHandler_t*)pvParameters;
+    TickType_t Idle = (Handler->IdleTimeoutMs != 0) ? pdMS_TO_TICKS(Handler->IdleTimeoutMs) : portMAX_DELAY;
+    uint32_t Event, Latency;
+    BaseType_t Available, Dormant;
+
+    //The events of the creation are in the ring already, the first one is handled right away
+    Latency = (uint32_t)(esp_timer_get_time() - Handler->PostedAt);
+
+    portENTER_CRITICAL(&Handler->Lock);
+    Handler->FirstLatencyUs += Latency;
+    Handler->FirstLatencyMaxUs = (Latency > Handler->FirstLatencyMaxUs) ? Latency : Handler->FirstLatencyMaxUs;
+    portEXIT_CRITICAL(&Handler->Lock);
+
+    for(;;)
+    {
+        portENTER_CRITICAL(&Handler->Lock);
+
+        Available = (Handler->Count != 0) ? pdTRUE : pdFALSE;
+
+        if(Available == pdTRUE)
+        {
+            Event = Handler->Events[Handler->Head];
+            Handler->Head = (Handler->Head + 1) % LAZY_EVENTS;
+            Handler->Count--;
+        }
+
+        portEXIT_CRITICAL(&Handler->Lock);
+
+        if(Available == pdTRUE)
+        {
+            Handler->Function(Handler->Arg,Event);
+            continue;
+        }
+
+        if(ulTaskNotifyTake(pdTRUE,Idle) != 0)
+        {
+            continue;
+        }
+
+        //Idle for the whole timeout, the handler goes dormant unless an event has slipped in
+        portENTER_CRITICAL(&Handler->Lock);
+
+        Dormant = ((Handler->Count == 0) && (Handler->State == LAZY_RUNNING)) ? pdTRUE : pdFALSE;
+
+        if(Dormant == pdTRUE)
+        {
+            Handler->State = LAZY_DORMANT;
+            Handler->Task = NULL;
+        }
+
+        portEXIT_CRITICAL(&Handler->Lock);
+
+        //The next post may already be creating a new task, this one must not touch the handler any more
+        if(Dormant == pdTRUE)
+        {
+            vTaskDelete(NULL);
+        }
+    }
+}
+
+/*Creates the tasks of the handlers which have seen their first event*/
+static void LazySpawner_Task(void* pvParameters)
+{
+    LazyHandler_t* Handler;
+    TaskHandle_t Task;
+    int64_t Start;
+    BaseType_t xStatus;
+
+    for(;;)
+    {
+        xQueueReceive(Lazy_SpawnQueue,&Handler,portMAX_DELAY);
+
+        Start = esp_timer_get_time();
+
+        xStatus = xTaskCreatePinnedToCore(LazyHandler_Task,Handler->Name,Handler->StackSize,Handler,Handler->Priority,&Task,
+                                          Handler->Core);
+
+        portENTER_CRITICAL(&Handler->Lock);
+
+        if(xStatus == pdPASS)
+        {
+            Handler->Task = Task;
+            Handler->State = LAZY_RUNNING;
+            Handler->Creations++;
+        }
+        else
+        {
+            //Back to dormant with the events kept, the next post tries again
+            Handler->State = LAZY_DORMANT;
+            Handler->Failures++;
+        }
+
+        portEXIT_CRITICAL(&Handler->Lock);
+
+        if(xStatus == pdPASS)
+        {
+            Lazy_CreateUs += (uint64_t)(esp_timer_get_time() - Start);
+            Lazy_CreateCount++;
+
+            //The posts made before the state was running did not notify, the task may already sleep with events in the ring
+            xTaskNotifyGive(Task);
+        }
+        else
+        {
+            ESP_LOGE(RTOS,"Handler %s could not be created.\r\n",Handler->Name);
+        }
+    }
+}
+
+static BaseType_t LazyHandler_Init(void)
+{
+    Lazy_SpawnQueue = xQueueCreate(LAZY_MAX_HANDLERS,sizeof(LazyHandler_t*));
+
+    if(Lazy_SpawnQueue == NULL)
+    {
+        return pdFAIL;
+    }
+
+    return xTaskCreate(LazySpawner_Task,"Spawner",2048,NULL,LAZY_SPAWNER_PRIORITY,NULL);
+}
+
+static void LazyHandler_Report(void)
+{
+    uint32_t Loop, Resident = 0, Created = 0, EagerBytes = 0, ResidentBytes = 0, CreateUs;
+    LazyHandler_t* Handler;
+
+    printf("%-12s %-8s %8s %8s %8s %10s %10s\r\n","Handler","State","Posted","Dropped","Created","FirstAvgUs","FirstMaxUs");
+
+    for(Loop = 0; Loop < Lazy_HandlerCount; Loop++)
+    {
+        Handler = Lazy_Handlers[Loop];
+        EagerBytes += Handler->StackSize + LAZY_TCB_BYTES;
+
+        if(Handler->State != LAZY_DORMANT)
+        {
+            Resident++;
+            ResidentBytes += Handler->StackSize + LAZY_TCB_BYTES;
+        }
+
+        if(Handler->Creations == 0)
+        {
+            continue;
+        }
+
+        Created++;
+
+        printf("%-12s %-8s %8u %8u %8u %10llu %10u\r\n",Handler->Name,
+               (Handler->State == LAZY_RUNNING) ? "running" : ((Handler->State == LAZY_CREATING) ? "creating" : "dormant"),
+               Handler->Posted,Handler->Dropped,Handler->Creations,Handler->FirstLatencyUs / Handler->Creations,
+               Handler->FirstLatencyMaxUs);
+    }
+
+    CreateUs = (Lazy_CreateCount != 0) ? (uint32_t)(Lazy_CreateUs / Lazy_CreateCount) : 0;
+
+    printf("%u handlers, %u resident, %u never used, %u created in total, %u us per creation\r\n",Lazy_HandlerCount,
+           Resident,Lazy_HandlerCount - Created,Lazy_CreateCount,CreateUs);
+    printf("Stacks and TCBs resident %u bytes, eager %u bytes, saved %u bytes, boot time saved about %u us\r\n\r\n",
+           ResidentBytes,EagerBytes,EagerBytes - ResidentBytes,Lazy_HandlerCount * CreateUs);
+}
+
+/*---------------------------------------------- Handlers ----------------------------------------------*/
+
+#define FAULT_HANDLERS          64
+
+static char Fault_Names[FAULT_HANDLERS][configMAX_TASK_NAME_LEN];
+static LazyHandler_t Fault_Handlers[FAULT_HANDLERS];
+
+static void Fault_Function(void* Arg, uint32_t Event)
+{
+    ESP_LOGW(RTOS,"%s handling fault code %u.\r\n",pcTaskGetTaskName(NULL),Event);
+}
+
+static void Ex16_Function(void* Arg, uint32_t Event)
+{
+    printf("Handler Function is executing after the interrupt %u!!!!\r\n",Event);
+}
+
+static void Maintenance_Function(void* Arg, uint32_t Event)
+{
+    ESP_LOGI(RTOS,"Maintenance run %u, free heap %u bytes.\r\n",Event,esp_get_free_heap_size());
+}
+
+static LazyHandler_t Ex16_Handler = LAZY_HANDLER_INIT("Handler",Ex16_Function,NULL,2048,3,tskNO_AFFINITY,0);
+static LazyHandler_t Maintenance_Handler = LAZY_HANDLER_INIT("Maintenance",Maintenance_Function,NULL,3072,1,tskNO_AFFINITY,
+                                                             3000);
+
+static void Interrupt_Handler(void *arg)
+{
+    static uint32_t Interrupts;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    xt_set_intclear(1 << SW_ISR_LEVEL_3);
+
+    //The first interrupt finds the handler dormant, its task is created by the spawner
+    LazyHandler_PostFromISR(&Ex16_Handler,++Interrupts,&xHigherPriorityTaskWoken);
+
+    portYIELD_FROM_ISR();
+}
+
+static void Periodic_Function(void* pvParameters)
+{
+    uint32_t Round = 0;
+
+    for(;;)
+    {
+        vTaskDelay(pdMS_TO_TICKS(500));
+        Round++;
+
+        xt_set_intset(1 << SW_ISR_LEVEL_3);
+
+        //A fault on one of the first eight handlers every two seconds, the others never see one
+        if((Round % 4) == 0)
+        {
+            LazyHandler_Post(&Fault_Handlers[rand() % 8],Round);
+        }
+
+        if((Round % 20) == 0)
+        {
+            LazyHandler_Post(&Maintenance_Handler,Round / 20);
+        }
+
+        if((Round % 10) == 0)
+        {
+            LazyHandler_Report();
+        }
+    }
+}
+
+void app_main(void)
+{
+    uint32_t Loop, FreeBefore = esp_get_free_heap_size();
+    int64_t Start = esp_timer_get_time();
+
+    if(LazyHandler_Init() == pdFAIL)
+    {
+        ESP_LOGE(RTOS,"Spawner could not be created.\r\n");
+        return;
+    }
+
+    for(Loop = 0; Loop < FAULT_HANDLERS; Loop++)
+    {
+        snprintf(Fault_Names[Loop],sizeof(Fault_Names[Loop]),"Fault-%02u",Loop);
+        Fault_Handlers[Loop] = (LazyHandler_t)LAZY_HANDLER_INIT(Fault_Names[Loop],Fault_Function,NULL,2048,4,tskNO_AFFINITY,1000);
+        LazyHandler_Register(&Fault_Handlers[Loop]);
+    }
+
+    LazyHandler_Register(&Ex16_Handler);
+    LazyHandler_Register(&Maintenance_Handler);
+
+    ESP_LOGI(RTOS,"%u handlers registered in %lld us, %u bytes of heap used.\r\n",Lazy_HandlerCount,
+             esp_timer_get_time() - Start,FreeBefore - esp_get_free_heap_size());
+
+    esp_intr_alloc(ETS_INTERNAL_SW1_INTR_SOURCE,0,Interrupt_Handler,NULL,NULL);
+
+    //On the core of app_main, where the software interrupt is allocated
+    xTaskCreatePinnedToCore(Periodic_Function,"Periodic",3072,NULL,2,NULL,xPortGetCoreID());
+}
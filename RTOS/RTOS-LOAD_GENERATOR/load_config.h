@@ -0,0 +1,90 @@
+/**
+ * @file load_config.h
+ * @author Tushar Uttekar
+ *
+ * @brief
+ *
+ * Scenarios which are run by the load generator one after the other, this is the only file which has to be edited for a new
+ * stress test of a kernel configuration.
+ *
+ * ->A channel is the primitive between the producers and the consumers, a queue (fixed item size of MaxSize) or a message
+ *   buffer (every message has a random size between MinSize and MaxSize). MinSize can not be below sizeof(LoadHeader_t).
+ * ->A producer entry creates Instances tasks which send Rate messages per second each into Channel, with a constant interval,
+ *   exponential intervals (Poisson arrivals) or in bursts of Burst messages with the same average rate.
+ * ->A consumer entry creates Instances tasks which receive from Channel and spend WorkUs of busy work on every message.
+ * ->Core is 0, 1 or tskNO_AFFINITY.
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#pragma once
+
+/*Example 10, two senders into a queue of five items and one receiver above them*/
+static const LoadChannel_t Ex10_Channels[] =
+{
+    {.Name = "Queue",   .Primitive = LOAD_QUEUE, .Length = 5, .MinSize = 16, .MaxSize = 16},
+};
+
+static const LoadProducer_t Ex10_Producers[] =
+{
+    {.Name = "Sender",   .Instances = 2, .Priority = 1, .Core = tskNO_AFFINITY, .Channel = 0, .Rate = 200,
+     .Distribution = LOAD_CONSTANT},
+};
+
+static const LoadConsumer_t Ex10_Consumers[] =
+{
+    {.Name = "Receiver", .Instances = 1, .Priority = 2, .Core = tskNO_AFFINITY, .Channel = 0, .WorkUs = 0},
+};
+
+/*Fan in from eight Poisson sources on both cores into two workers*/
+static const LoadChannel_t FanIn_Channels[] =
+{
+    {.Name = "Queue",   .Primitive = LOAD_QUEUE, .Length = 32, .MinSize = 32, .MaxSize = 32},
+};
+
+static const LoadProducer_t FanIn_Producers[] =
+{
+    {.Name = "Sensor0",  .Instances = 4, .Priority = 3, .Core = 0, .Channel = 0, .Rate = 500, .Distribution = LOAD_POISSON},
+    {.Name = "Sensor1",  .Instances = 4, .Priority = 3, .Core = 1, .Channel = 0, .Rate = 500, .Distribution = LOAD_POISSON},
+};
+
+static const LoadConsumer_t FanIn_Consumers[] =
+{
+    {.Name = "Worker",   .Instances = 2, .Priority = 2, .Core = tskNO_AFFINITY, .Channel = 0, .WorkUs = 50},
+};
+
+/*Bursty variable size messages through a message buffer next to a constant control stream on a queue*/
+static const LoadChannel_t Burst_Channels[] =
+{
+    {.Name = "MsgBuf",  .Primitive = LOAD_MESSAGE_BUFFER, .Length = 32, .MinSize = 16, .MaxSize = 128},
+    {.Name = "Control", .Primitive = LOAD_QUEUE,          .Length = 8,  .MinSize = 16, .MaxSize = 16},
+};
+
+static const LoadProducer_t Burst_Producers[] =
+{
+    {.Name = "Burst",    .Instances = 4, .Priority = 2, .Core = tskNO_AFFINITY, .Channel = 0, .Rate = 2000,
+     .Distribution = LOAD_BURSTY, .Burst = 16},
+    {.Name = "Control",  .Instances = 1, .Priority = 4, .Core = 1, .Channel = 1, .Rate = 100, .Distribution = LOAD_CONSTANT},
+};
+
+static const LoadConsumer_t Burst_Consumers[] =
+{
+    {.Name = "Drain",    .Instances = 2, .Priority = 3, .Core = tskNO_AFFINITY, .Channel = 0, .WorkUs = 20},
+    {.Name = "Loop",     .Instances = 1, .Priority = 5, .Core = 1, .Channel = 1, .WorkUs = 200},
+};
+
+#define LOAD_SCENARIO(ScenarioName,Duration,Prefix)                                                             \
+    {.Name = (ScenarioName), .DurationMs = (Duration),                                                          \
+     .Channels = Prefix##_Channels, .ChannelCount = sizeof(Prefix##_Channels) / sizeof(LoadChannel_t),          \
+     .Producers = Prefix##_Producers, .ProducerCount = sizeof(Prefix##_Producers) / sizeof(LoadProducer_t),     \
+     .Consumers = Prefix##_Consumers, .ConsumerCount = sizeof(Prefix##_Consumers) / sizeof(LoadConsumer_t)}
+
+static const LoadScenario_t Load_Scenarios[] =
+{
+    LOAD_SCENARIO("Example10",  5000,   Ex10),
+    LOAD_SCENARIO("FanIn",      10000,  FanIn),
+    LOAD_SCENARIO("Bursty",     10000,  Burst),
+};
@@ -0,0 +1,651 @@
+/**
+ * @file main.c
+ * @author Tushar Uttekar
+ *
+ * @brief
+ *
+ * This example is a configurable synthetic load generator which generalises the fixed topologies of the examples (two senders
+ * in example 10 and 11, two queues in example 12, three synchronised tasks in example 23) into scenarios described in
+ * load_config.h, so a kernel configuration can be stress tested the same way before every release.
+ *
+ * For every scenario the generator
+ * ->Creates the channels (queues or message buffers), the producer tasks and the consumer tasks with their priorities and cores.
+ * ->Lets the producers send at their rate with a constant, Poisson or bursty distribution, a message which does not fit in the
+ *   channel is dropped instead of blocking the producer, so an overloaded channel shows up as drops and not as a lower rate.
+ * ->Stamps every message with the time at which it is sent, the consumers put the latency of every message in a log2 histogram
+ *   with four sub buckets per power of two (an error below 25%) from which the percentiles are read.
+ * ->Runs for the duration of the scenario and reports the sent, dropped and received messages, the throughput, the latency
+ *   percentiles and the CPU usage of both cores.
+ *
+ * NOTE : The CPU usage is taken from the run time counter of the idle tasks, it needs configUSE_TRACE_FACILITY and
+ *        configGENERATE_RUN_TIME_STATS (CONFIG_FREERTOS_USE_TRACE_FACILITY and CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS in
+ *        menuconfig). The scenarios run on the target as there is no POSIX port in this project.
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/message_buffer.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "esp_system.h"
+
+#define RTOS                    "freertos"
+
+#define LOAD_MAX_CHANNELS       4
+#define LOAD_MAX_WORKERS        32
+#define LOAD_MAX_MESSAGE        256
+#define LOAD_HIST_BUCKETS       124
+#define LOAD_POLL_TICKS         pdMS_TO_TICKS(10)
+#define LOAD_RUNNER_PRIORITY    (configMAX_PRIORITIES - 2)
+
+typedef enum
+{
+    LOAD_QUEUE = 0,
+    LOAD_MESSAGE_BUFFER
+}LoadPrimitive_t;
+
+typedef enum
+{
+    LOAD_CONSTANT = 0,
+    LOAD_POISSON,
+    LOAD_BURSTY
+}LoadDistribution_t;
+
+typedef struct
+{
+    const char* Name;
+    LoadPrimitive_t Primitive;
+    uint32_t Length;                        //Messages which fit in the channel
+    uint32_t MinSize;
+    uint32_t MaxSize;
+}LoadChannel_t;
+
+typedef struct
+{
+    const char* Name;
+    uint32_t Instances;
+    UBaseType_t Priority;
+    BaseType_t Core;
+    uint32_t Channel;
+    uint32_t Rate;                          //Messages per second of every instance
+    LoadDistribution_t Distribution;
+    uint32_t Burst;                         //Messages per burst, LOAD_BURSTY only
+}LoadProducer_t;
+
+typedef struct
+{
+    const char* Name;
+    uint32_t Instances;
+    UBaseType_t Priority;
+    BaseType_t Core;
+    uint32_t Channel;
+    uint32_t WorkUs;                        //Busy work for every message received
+}LoadConsumer_t;
+
+typedef struct
+{
+    const char* Name;
+    uint32_t DurationMs;
+    const LoadChannel_t* Channels;
+    uint32_t ChannelCount;
+    const LoadProducer_t* Producers;
+    uint32_t ProducerCount;
+    const LoadConsumer_t* Consumers;
+    uint32_t ConsumerCount;
+}LoadScenario_t;
+
+/*Start of every message*/
+typedef struct
+{
+    int64_t Timestamp;
+    uint32_t Producer;
+    uint32_t Sequence;
+}LoadHeader_t;
+
+#include "load_config.h"
+
+typedef struct
+{
+    const LoadChannel_t* Config;
+    QueueHandle_t Queue;
+    MessageBufferHandle_t Buffer;
+    SemaphoreHandle_t WriteLock;            //Message buffers allow only one writer and one reader at a time
+    SemaphoreHandle_t ReadLock;
+    uint32_t Writers;
+    uint32_t Readers;
+}LoadChannelRun_t;
+
+typedef struct
+{
+    const LoadProducer_t* Producer;         //One of the two is set
+    const LoadConsumer_t* Consumer;
+    uint32_t Id;
+    LoadChannelRun_t* Channel;
+    uint32_t Sent;
+    uint32_t Dropped;
+    uint32_t Received;
+    uint64_t Bytes;
+    uint64_t LatencyUs;
+    uint32_t LatencyMaxUs;
+    uint32_t Histogram[LOAD_HIST_BUCKETS];
+}LoadWorker_t;
+
+static LoadChannelRun_t Load_Channels[LOAD_MAX_CHANNELS];
+static LoadWorker_t Load_Workers[LOAD_MAX_WORKERS];
+static volatile BaseType_t Load_Running;
+static SemaphoreHandle_t Load_Finished;
+
+/*---------------------------------------------- Latency histogram ----------------------------------------------*/
+
+/*Values below 4 have their own bucket, above that every power of two is split in four sub buckets*/
+static uint32_t Load_Bucket(uint32_t Us)
+{
+    uint32_t Msb;
+
+    if(Us < 4)
+    {
+        return Us;
+    }
+
+    Msb = 31 - __builtin_clz(Us);
+
+    return ((Msb - 1) * 4) + ((Us >> (Msb - 2)) & 3);
+}
+
+/*Upper bound of the values in the bucket*/
+static uint32_t Load_BucketLimit(uint32_t Bucket)
+{
+    uint32_t Msb;
+
+    if(Bucket < 4)
+    {
+        return Bucket;
+    }
+
+    Msb = (Bucket / 4) + 1;
+
+    return ((4 + (Bucket % 4) + 1) << (Msb - 2)) - 1;
+}
+
+static uint32_t Load_Percentile(const uint32_t* Histogram, uint32_t Count, uint32_t PerMille)
+{
+    uint32_t Loop, Sum = 0, Target = (uint32_t)(((uint64_t)Count * PerMille + 999) / 1000);
+
+    for(Loop = 0; Loop < LOAD_HIST_BUCKETS; Loop++)
+    {
+        Sum += Histogram[Loop];
+
+        if((Sum >= Target) && (Sum != 0))
+        {
+            return Load_BucketLimit(Loop);
+        }
+    }
+
+    return 0;
+}
+
+/*---------------------------------------------- Channels ----------------------------------------------*/
+
+static BaseType_t Load_ChannelCreate(LoadChannelRun_t* Channel, const LoadChannel_t* Config)
+{
+    Channel->Config = Config;
+
+    if(Config->Primitive == LOAD_QUEUE)
+    {
+        Channel->Queue = xQueueCreate(Config->Length,Config->MaxSize);
+        return (Channel->Queue != NULL) ? pdPASS : pdFAIL;
+    }
+
+    //Every message in the buffer carries its length in front of it
+    Channel->Buffer = xMessageBufferCreate(Config->Length * (Config->MaxSize + sizeof(size_t)));
+
+    if(Channel->Writers > 1)
+    {
+        Channel->WriteLock = xSemaphoreCreateMutex();
+    }
+
+    if(Channel->Readers > 1)
+    {
+        Channel->ReadLock = xSemaphoreCreateMutex();
+    }
+
+    return ((Channel->Buffer != NULL) && ((Channel->Writers <= 1) || (Channel->WriteLock != NULL)) &&
+            ((Channel->Readers <= 1) || (Channel->ReadLock != NULL))) ? pdPASS : pdFAIL;
+}
+
+static void Load_ChannelDelete(LoadChannelRun_t* Channel)
+{
+    if(Channel->Queue != NULL)
+    {
+        vQueueDelete(Channel->Queue);
+    }
+
+    if(Channel->Buffer != NULL)
+    {
+        vMessageBufferDelete(Channel->Buffer);
+    }
+
+    if(Channel->WriteLock != NULL)
+    {
+        vSemaphoreDelete(Channel->WriteLock);
+    }
+
+    if(Channel->ReadLock != NULL)
+    {
+        vSemaphoreDelete(Channel->ReadLock);
+    }
+
+    memset(Channel,0,sizeof(LoadChannelRun_t));
+}
+
+/*Never blocks on a full channel, returns pdFAIL when the message was dropped*/
+static BaseType_t Load_ChannelSend(LoadChannelRun_t* Channel, const void* Message, uint32_t Size)
+{
+    size_t Sent;
+
+    if(Channel->Queue != NULL)
+    {
+        return xQueueSendToBack(Channel->Queue,Message,0);
+    }
+
+    if(Channel->WriteLock != NULL)
+    {
+        xSemaphoreTake(Channel->WriteLock,portMAX_DELAY);
+    }
+
+    Sent = xMessageBufferSend(Channel->Buffer,Message,Size,0);
+
+    if(Channel->WriteLock != NULL)
+    {
+        xSemaphoreGive(Channel->WriteLock);
+    }
+
+    return (Sent == Size) ? pdPASS : pdFAIL;
+}
+
+/*Returns the size of the message received or 0 after LOAD_POLL_TICKS*/
+static uint32_t Load_ChannelReceive(LoadChannelRun_t* Channel, void* Message)
+{
+    size_t Received = 0;
+
+    if(Channel->Queue != NULL)
+    {
+        return (xQueueReceive(Channel->Queue,Message,LOAD_POLL_TICKS) == pdPASS) ? Channel->Config->MaxSize : 0;
+    }
+
+    if((Channel->ReadLock == NULL) || (xSemaphoreTake(Channel->ReadLock,LOAD_POLL_TICKS) == pdPASS))
+    {
+        Received = xMessageBufferReceive(Channel->Buffer,Message,LOAD_MAX_MESSAGE,LOAD_POLL_TICKS);
+
+        if(Channel->ReadLock != NULL)
+        {
+            xSemaphoreGive(Channel->ReadLock);
+        }
+    }
+
+    return (uint32_t)Received;
+}
+
+/*---------------------------------------------- Producers and consumers ----------------------------------------------*/
+
+/*Microseconds until the next message*/
+static int64_t Load_NextInterval(const LoadProducer_t* Producer, uint32_t* BurstLeft)
+{
+    const float Mean = 1000000.0f / (float)Producer->Rate;
+    float Uniform;
+
+    switch(Producer->Distribution)
+    {
+        case LOAD_POISSON:
+            //Exponential intervals, Uniform is in (0, 1] so the logarithm is finite
+            Uniform = ((float)(esp_random() >> 8) + 1.0f) / 16777216.0f;
+            return (int64_t)(-logf(Uniform) * Mean);
+
+        case LOAD_BURSTY:
+            if(--(*BurstLeft) > 0)
+            {
+                return 0;
+            }
+
+            *BurstLeft = (Producer->Burst != 0) ? Producer->Burst : 1;
+            return (int64_t)(Mean * (float)(*BurstLeft));
+
+        default:
+            return (int64_t)Mean;
+    }
+}
+
+static void Load_ProducerTask(void* pvParameters)
+{
+    LoadWorker_t* Worker = (LoadWorker_t*) pvParameters;
+    const LoadChannel_t* Channel = Worker->Channel->Config;
+    uint32_t Message[LOAD_MAX_MESSAGE / sizeof(uint32_t)];
+    LoadHeader_t* Header = (LoadHeader_t*) Message;
+    uint32_t BurstLeft = 1, Size;
+    int64_t Now, NextDue;
+    TickType_t Delay;
+
+    memset(Message,0xA5,sizeof(Message));
+    Header->Producer = Worker->Id;
+    Header->Sequence = 0;
+    NextDue = esp_timer_get_time();
+
+    while(Load_Running == pdTRUE)
+    {
+        Now = esp_timer_get_time();
+
+        //Sends every message which is due, rates above the tick rate are sent in batches once per tick
+        while((NextDue <= Now) && (Load_Running == pdTRUE))
+        {
+            Size = Channel->MinSize;
+
+            if(Channel->MaxSize > Channel->MinSize)
+            {
+                Size += esp_random() % (Channel->MaxSize - Channel->MinSize + 1);
+            }
+
+            Header->Timestamp = esp_timer_get_time();
+
+            if(Load_ChannelSend(Worker->Channel,Message,Size) == pdPASS)
+            {
+                Worker->Sent++;
+            }
+            else
+            {
+                Worker->Dropped++;
+            }
+
+            Header->Sequence++;
+            NextDue += Load_NextInterval(Worker->Producer,&BurstLeft);
+        }
+
+        Delay = (TickType_t)((NextDue - Now) / (portTICK_PERIOD_MS * 1000));
+        vTaskDelay((Delay > 0) ? Delay : 1);
+    }
+
+    xSemaphoreGive(Load_Finished);
+    vTaskDelete(NULL);
+}
+
+static void Load_ConsumerTask(void* pvParameters)
+{
+    LoadWorker_t* Worker = (LoadWorker_t*) pvParameters;
+    uint32_t Message[LOAD_MAX_MESSAGE / sizeof(uint32_t)];
+    const LoadHeader_t* Header = (const LoadHeader_t*) Message;
+    uint32_t Size, Latency;
+    int64_t Now;
+
+    while(Load_Running == pdTRUE)
+    {
+        Size = Load_ChannelReceive(Worker->Channel,Message);
+
+        if(Size == 0)
+        {
+            continue;
+        }
+
+        Now = esp_timer_get_time();
+        Latency = (uint32_t)(Now - Header->Timestamp);
+
+        Worker->Received++;
+        Worker->Bytes += Size;
+        Worker->LatencyUs += Latency;
+        Worker->Histogram[Load_Bucket(Latency)]++;
+
+        if(Latency > Worker->LatencyMaxUs)
+        {
+            Worker->LatencyMaxUs = Latency;
+        }
+
+        while((esp_timer_get_time() - Now) < Worker->Consumer->WorkUs);
+    }
+
+    xSemaphoreGive(Load_Finished);
+    vTaskDelete(NULL);
+}
+
+/*---------------------------------------------- Scenario runner ----------------------------------------------*/
+
+#if (configUSE_TRACE_FACILITY == 1) && (configGENERATE_RUN_TIME_STATS == 1)
+static void Load_CpuSnapshot(uint32_t* Idle, uint32_t* Total)
+{
+    static TaskStatus_t Tasks[LOAD_MAX_WORKERS + 16];
+    UBaseType_t Count, Loop, Core;
+
+    Count = uxTaskGetSystemState(Tasks,LOAD_MAX_WORKERS + 16,Total);
+
+    for(Core = 0; Core < portNUM_PROCESSORS; Core++)
+    {
+        Idle[Core] = 0;
+
+        for(Loop = 0; Loop < Count; Loop++)
+        {
+            if(Tasks[Loop].xHandle == xTaskGetIdleTaskHandleForCPU(Core))
+            {
+                Idle[Core] = Tasks[Loop].ulRunTimeCounter;
+            }
+        }
+    }
+}
+#endif
+
+static uint32_t Load_CreateWorkers(const LoadScenario_t* Scenario)
+{
+    uint32_t Entry, Instance, Workers = 0;
+    BaseType_t xStatus;
+
+    //Consumers first so the first messages find someone waiting for them
+    for(Entry = 0; Entry < Scenario->ConsumerCount; Entry++)
+    {
+        for(Instance = 0; Instance < Scenario->Consumers[Entry].Instances; Instance++, Workers++)
+        {
+            Load_Workers[Workers].Consumer = &Scenario->Consumers[Entry];
+            Load_Workers[Workers].Id = Workers;
+            Load_Workers[Workers].Channel = &Load_Channels[Scenario->Consumers[Entry].Channel];
+
+            xStatus = xTaskCreatePinnedToCore(Load_ConsumerTask,Scenario->Consumers[Entry].Name,3072,&Load_Workers[Workers],
+                                              Scenario->Consumers[Entry].Priority,NULL,Scenario->Consumers[Entry].Core);
+
+            if(xStatus != pdPASS)
+            {
+                return Workers;
+            }
+        }
+    }
+
+    for(Entry = 0; Entry < Scenario->ProducerCount; Entry++)
+    {
+        for(Instance = 0; Instance < Scenario->Producers[Entry].Instances; Instance++, Workers++)
+        {
+            Load_Workers[Workers].Producer = &Scenario->Producers[Entry];
+            Load_Workers[Workers].Id = Workers;
+            Load_Workers[Workers].Channel = &Load_Channels[Scenario->Producers[Entry].Channel];
+
+            xStatus = xTaskCreatePinnedToCore(Load_ProducerTask,Scenario->Producers[Entry].Name,3072,&Load_Workers[Workers],
+                                              Scenario->Producers[Entry].Priority,NULL,Scenario->Producers[Entry].Core);
+
+            if(xStatus != pdPASS)
+            {
+                return Workers;
+            }
+        }
+    }
+
+    return Workers;
+}
+
+static void Load_Report(const LoadScenario_t* Scenario, uint32_t Workers, int64_t ElapsedUs)
+{
+    static uint32_t Histogram[LOAD_HIST_BUCKETS];
+    uint32_t Sent = 0, Dropped = 0, Received = 0, MaxUs = 0, Loop, Bucket;
+    uint64_t Bytes = 0, LatencyUs = 0;
+
+    memset(Histogram,0,sizeof(Histogram));
+
+    for(Loop = 0; Loop < Workers; Loop++)
+    {
+        Sent += Load_Workers[Loop].Sent;
+        Dropped += Load_Workers[Loop].Dropped;
+        Received += Load_Workers[Loop].Received;
+        Bytes += Load_Workers[Loop].Bytes;
+        LatencyUs += Load_Workers[Loop].LatencyUs;
+        MaxUs = (Load_Workers[Loop].LatencyMaxUs > MaxUs) ? Load_Workers[Loop].LatencyMaxUs : MaxUs;
+
+        for(Bucket = 0; Bucket < LOAD_HIST_BUCKETS; Bucket++)
+        {
+            Histogram[Bucket] += Load_Workers[Loop].Histogram[Bucket];
+        }
+    }
+
+    printf("Scenario %s, %u tasks, %lld ms\r\n",Scenario->Name,Workers,ElapsedUs / 1000);
+    printf("  Messages  sent %u  dropped %u  received %u  in flight %u\r\n",Sent,Dropped,Received,Sent - Received);
+    printf("  Throughput  %lld msg/s  %lld byte/s\r\n",((int64_t)Received * 1000000LL) / ElapsedUs,
+           ((int64_t)Bytes * 1000000LL) / ElapsedUs);
+    printf("  Latency us  avg %llu  p50 %u  p90 %u  p99 %u  p99.9 %u  max %u\r\n",
+           (Received != 0) ? (LatencyUs / Received) : 0,Load_Percentile(Histogram,Received,500),
+           Load_Percentile(Histogram,Received,900),Load_Percentile(Histogram,Received,990),
+           Load_Percentile(Histogram,Received,999),MaxUs);
+}
+
+static BaseType_t Load_RunScenario(const LoadScenario_t* Scenario)
+{
+    uint32_t Loop, Workers, Instances = 0;
+    int64_t Start;
+#if (configUSE_TRACE_FACILITY == 1) && (configGENERATE_RUN_TIME_STATS == 1)
+    uint32_t IdleStart[portNUM_PROCESSORS], IdleEnd[portNUM_PROCESSORS], TotalStart, TotalEnd;
+#endif
+
+    if(Scenario->ChannelCount > LOAD_MAX_CHANNELS)
+    {
+        return pdFAIL;
+    }
+
+    memset(Load_Channels,0,sizeof(Load_Channels));
+    memset(Load_Workers,0,sizeof(Load_Workers));
+
+    //The workers are checked against the channels of the scenario before their counts are added to them
+    for(Loop = 0; Loop < Scenario->ProducerCount; Loop++)
+    {
+        if(Scenario->Producers[Loop].Channel >= Scenario->ChannelCount)
+        {
+            return pdFAIL;
+        }
+
+        Load_Channels[Scenario->Producers[Loop].Channel].Writers += Scenario->Producers[Loop].Instances;
+        Instances += Scenario->Producers[Loop].Instances;
+    }
+
+    for(Loop = 0; Loop < Scenario->ConsumerCount; Loop++)
+    {
+        if(Scenario->Consumers[Loop].Channel >= Scenario->ChannelCount)
+        {
+            return pdFAIL;
+        }
+
+        Load_Channels[Scenario->Consumers[Loop].Channel].Readers += Scenario->Consumers[Loop].Instances;
+        Instances += Scenario->Consumers[Loop].Instances;
+    }
+
+    if(Instances > LOAD_MAX_WORKERS)
+    {
+        return pdFAIL;
+    }
+
+    for(Loop = 0; Loop < Scenario->ChannelCount; Loop++)
+    {
+        if((Scenario->Channels[Loop].MinSize < sizeof(LoadHeader_t)) || (Scenario->Channels[Loop].MaxSize > LOAD_MAX_MESSAGE) ||
+           (Load_ChannelCreate(&Load_Channels[Loop],&Scenario->Channels[Loop]) != pdPASS))
+        {
+            while(Loop-- > 0)
+            {
+                Load_ChannelDelete(&Load_Channels[Loop]);
+            }
+
+            return pdFAIL;
+        }
+    }
+
+#if (configUSE_TRACE_FACILITY == 1) && (configGENERATE_RUN_TIME_STATS == 1)
+    Load_CpuSnapshot(IdleStart,&TotalStart);
+#endif
+
+    Load_Running = pdTRUE;
+    Start = esp_timer_get_time();
+    Workers = Load_CreateWorkers(Scenario);
+
+    vTaskDelay(pdMS_TO_TICKS(Scenario->DurationMs));
+
+    Load_Running = pdFALSE;
+    Start = esp_timer_get_time() - Start;
+
+    for(Loop = 0; Loop < Workers; Loop++)
+    {
+        xSemaphoreTake(Load_Finished,portMAX_DELAY);
+    }
+
+#if (configUSE_TRACE_FACILITY == 1) && (configGENERATE_RUN_TIME_STATS == 1)
+    Load_CpuSnapshot(IdleEnd,&TotalEnd);
+#endif
+
+    Load_Report(Scenario,Workers,Start);
+
+#if (configUSE_TRACE_FACILITY == 1) && (configGENERATE_RUN_TIME_STATS == 1)
+    //The total run time counts for one core, so the share of the idle task is the idle part of its core
+    for(Loop = 0; Loop < portNUM_PROCESSORS; Loop++)
+    {
+        printf("  CPU%u  %u%% busy\r\n",Loop,
+               100 - (uint32_t)(((uint64_t)(IdleEnd[Loop] - IdleStart[Loop]) * 100) / (TotalEnd - TotalStart)));
+    }
+#else
+    printf("  CPU usage needs configUSE_TRACE_FACILITY and configGENERATE_RUN_TIME_STATS\r\n");
+#endif
+
+    printf("\r\n");
+
+    for(Loop = 0; Loop < Scenario->ChannelCount; Loop++)
+    {
+        Load_ChannelDelete(&Load_Channels[Loop]);
+    }
+
+    //Lets the idle tasks free the workers before the next scenario
+    vTaskDelay(pdMS_TO_TICKS(100));
+
+    return (Workers == Instances) ? pdPASS : pdFAIL;
+}
+
+static void Load_Runner(void* pvParameters)
+{
+    uint32_t Loop;
+
+    for(Loop = 0; Loop < (sizeof(Load_Scenarios) / sizeof(Load_Scenarios[0])); Loop++)
+    {
+        if(Load_RunScenario(&Load_Scenarios[Loop]) != pdPASS)
+        {
+            ESP_LOGE(RTOS,"Scenario %s could not be set up completely\r\n",Load_Scenarios[Loop].Name);
+        }
+    }
+
+    printf("All scenarios done\r\n");
+    vTaskDelete(NULL);
+}
+
+void app_main(void)
+{
+    Load_Finished = xSemaphoreCreateCounting(LOAD_MAX_WORKERS,0);
+
+    if(Load_Finished != NULL)
+    {
+        //Above every worker so the scenario is stopped on time
+        xTaskCreate(Load_Runner,"LoadRunner",4096,NULL,LOAD_RUNNER_PRIORITY,NULL);
+    }
+}
@@ -0,0 +1,415 @@
+/**
+ * @file main.c
+ * @author Tushar Uttekar
+ *
+ * @brief
+ *
+ * This example demonstrates a lock free multi producer single consumer (MPSC) queue for workloads with many senders on both
+ * cores, where every xQueueSendToBack of example 10 and 11 has to take the spinlock of the queue and the senders spend most of
+ * their time spinning on it.
+ *
+ * The queue is a bounded ring in the style of D. Vyukov in which every cell carries a sequence number.
+ * ->A producer claims a position with a compare and swap on EnqueuePos, copies its item into the cell and then publishes the
+ *   cell by storing the next sequence number, so producers only contend on one atomic word and never on a lock.
+ * ->The consumer checks the sequence number of the cell at DequeuePos, when the cell is published it copies the item and
+ *   hands the cell back to the producers by advancing its sequence number by the length of the ring.
+ * ->Mpsc_SendFromISR is the same code path as Mpsc_Send, an interrupt which preempts a producer in the middle of an enqueue
+ *   just claims the next position.
+ * ->The consumer blocks on a task notification, it raises the Waiting flag before it sleeps and a producer only notifies it
+ *   when it finds the flag raised, so the kernel is not entered at all while the consumer is busy.
+ *
+ * The benchmark at the start scales the producers from 1 to 16, split over both cores, and compares the throughput of the MPSC
+ * queue with xQueueSendToBack on a FreeRTOS queue of the same length, the order of the items of every producer is checked.
+ *
+ * NOTE : The atomics are compiled to the S32C1I instruction of the ESP32 which works only on internal RAM, the queue must not be
+ *        placed in the external PSRAM. The benchmark runs on the target as there is no POSIX port in this project.
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/event_groups.h"
+#include "freertos/xtensa_api.h"
+#include "esp_intr_alloc.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "esp_system.h"
+
+#define RTOS                    "freertos"
+#define SW_ISR_LEVEL_3          29
+
+#define MPSC_ALIGN(Size)        (((Size) + 3) & ~3)
+#define MPSC_CELL_SIZE(Item)    (sizeof(uint32_t) + MPSC_ALIGN(Item))
+
+typedef struct
+{
+    uint32_t Sequence;
+    uint8_t Data[];
+}MpscCell_t;
+
+typedef struct
+{
+    uint8_t* Cells;
+    uint32_t Mask;                          //Length - 1, the length is a power of two
+    uint32_t CellSize;
+    uint32_t ItemSize;
+    volatile uint32_t EnqueuePos;           //Shared by all the producers
+    uint32_t Padding[7];                    //Keeps the two positions in different cache lines on targets which have them
+    volatile uint32_t DequeuePos;           //Consumer only
+    volatile uint32_t Waiting;              //Consumer is blocked or about to block
+    TaskHandle_t Consumer;
+}Mpsc_t;
+
+/*---------------------------------------------- MPSC queue ----------------------------------------------*/
+
+/*Storage must hold Length * MPSC_CELL_SIZE(ItemSize) bytes, Length has to be a power of two*/
+static BaseType_t Mpsc_Init(Mpsc_t* Queue, void* Storage, uint32_t Length, uint32_t ItemSize)
+{
+    uint32_t Loop;
+
+    if((Length < 2) || ((Length & (Length - 1)) != 0) || (Storage == NULL))
+    {
+        return pdFAIL;
+    }
+
+    memset(Queue,0,sizeof(Mpsc_t));
+    Queue->Cells = (uint8_t*) Storage;
+    Queue->Mask = Length - 1;
+    Queue->CellSize = MPSC_CELL_SIZE(ItemSize);
+    Queue->ItemSize = ItemSize;
+
+    for(Loop = 0; Loop < Length; Loop++)
+    {
+        ((MpscCell_t*)&Queue->Cells[Loop * Queue->CellSize])->Sequence = Loop;
+    }
+
+    return pdPASS;
+}
+
+static inline MpscCell_t* Mpsc_Cell(Mpsc_t* Queue, uint32_t Position)
+{
+    return (MpscCell_t*)&Queue->Cells[(Position & Queue->Mask) * Queue->CellSize];
+}
+
+/*Claims a cell and publishes the item, returns pdFALSE when the queue is full, never blocks*/
+static BaseType_t Mpsc_Enqueue(Mpsc_t* Queue, const void* Item)
+{
+    MpscCell_t* Cell;
+    uint32_t Position, Sequence;
+    int32_t Difference;
+
+    Position = __atomic_load_n(&Queue->EnqueuePos,__ATOMIC_RELAXED);
+
+    for(;;)
+    {
+        Cell = Mpsc_Cell(Queue,Position);
+        Sequence = __atomic_load_n(&Cell->Sequence,__ATOMIC_ACQUIRE);
+        Difference = (int32_t)(Sequence - Position);
+
+        if(Difference == 0)
+        {
+            //The cell is free for this position, on failure Position is reloaded with the current value
+            if(__atomic_compare_exchange_n(&Queue->EnqueuePos,&Position,Position + 1,pdTRUE,__ATOMIC_RELAXED,
+                                           __ATOMIC_RELAXED))
+            {
+                break;
+            }
+        }
+        else if(Difference < 0)
+        {
+            //The consumer has not freed the cell of the previous round yet
+            return pdFALSE;
+        }
+        else
+        {
+            Position = __atomic_load_n(&Queue->EnqueuePos,__ATOMIC_RELAXED);
+        }
+    }
+
+    memcpy(Cell->Data,Item,Queue->ItemSize);
+    __atomic_store_n(&Cell->Sequence,Position + 1,__ATOMIC_RELEASE);
+
+    return pdTRUE;
+}
+
+/*Consumer only, returns pdFALSE when the next cell is not published yet*/
+static BaseType_t Mpsc_Dequeue(Mpsc_t* Queue, void* Item)
+{
+    uint32_t Position = Queue->DequeuePos;
+    MpscCell_t* Cell = Mpsc_Cell(Queue,Position);
+
+    if(__atomic_load_n(&Cell->Sequence,__ATOMIC_ACQUIRE) != (Position + 1))
+    {
+        return pdFALSE;
+    }
+
+    memcpy(Item,Cell->Data,Queue->ItemSize);
+    __atomic_store_n(&Cell->Sequence,Position + Queue->Mask + 1,__ATOMIC_RELEASE);
+    Queue->DequeuePos = Position + 1;
+
+    return pdTRUE;
+}
+
+static BaseType_t Mpsc_Send(Mpsc_t* Queue, const void* Item)
+{
+    if(Mpsc_Enqueue(Queue,Item) == pdFALSE)
+    {
+        return errQUEUE_FULL;
+    }
+
+    //Only enters the kernel when the consumer is waiting for data
+    if(__atomic_exchange_n(&Queue->Waiting,0,__ATOMIC_SEQ_CST) != 0)
+    {
+        xTaskNotifyGive(Queue->Consumer);
+    }
+
+    return pdPASS;
+}
+
+static BaseType_t Mpsc_SendFromISR(Mpsc_t* Queue, const void* Item, BaseType_t* pxHigherPriorityTaskWoken)
+{
+    if(Mpsc_Enqueue(Queue,Item) == pdFALSE)
+    {
+        return errQUEUE_FULL;
+    }
+
+    if(__atomic_exchange_n(&Queue->Waiting,0,__ATOMIC_SEQ_CST) != 0)
+    {
+        vTaskNotifyGiveFromISR(Queue->Consumer,pxHigherPriorityTaskWoken);
+    }
+
+    return pdPASS;
+}
+
+/*Only one task may receive from the queue*/
+static BaseType_t Mpsc_Receive(Mpsc_t* Queue, void* Item, TickType_t Timeout)
+{
+    TimeOut_t TimeOut;
+
+    Queue->Consumer = xTaskGetCurrentTaskHandle();
+    vTaskSetTimeOutState(&TimeOut);
+
+    for(;;)
+    {
+        if(Mpsc_Dequeue(Queue,Item) == pdTRUE)
+        {
+            return pdPASS;
+        }
+
+        //The flag is raised before the queue is checked again, a producer which publishes after the check sees the flag
+        __atomic_store_n(&Queue->Waiting,1,__ATOMIC_SEQ_CST);
+
+        if(Mpsc_Dequeue(Queue,Item) == pdTRUE)
+        {
+            //A producer may have taken the flag already, its notification only causes one more pass of this loop later
+            __atomic_store_n(&Queue->Waiting,0,__ATOMIC_SEQ_CST);
+            return pdPASS;
+        }
+
+        if(xTaskCheckForTimeOut(&TimeOut,&Timeout) == pdTRUE)
+        {
+            __atomic_store_n(&Queue->Waiting,0,__ATOMIC_SEQ_CST);
+            return pdFAIL;
+        }
+
+        ulTaskNotifyTake(pdTRUE,Timeout);
+    }
+}
+
+/*---------------------------------------------- Benchmark ----------------------------------------------*/
+
+#define BENCH_LENGTH            64
+#define BENCH_ITEMS             4000
+#define BENCH_MAX_PRODUCERS     16
+#define BENCH_START_BIT         (1 << 0)
+
+typedef enum
+{
+    BENCH_FREERTOS_QUEUE = 0,
+    BENCH_MPSC_QUEUE
+}BenchKind_t;
+
+static uint8_t Bench_Storage[BENCH_LENGTH * MPSC_CELL_SIZE(sizeof(uint32_t))];
+static Mpsc_t Bench_Mpsc;
+static QueueHandle_t Bench_Queue;
+static EventGroupHandle_t Bench_Start;
+static BenchKind_t Bench_Kind;
+
+static void Bench_Producer(void* pvParameters)
+{
+    uint32_t Producer = (uint32_t) pvParameters, Loop, Item;
+
+    xEventGroupWaitBits(Bench_Start,BENCH_START_BIT,pdFALSE,pdTRUE,portMAX_DELAY);
+
+    for(Loop = 0; Loop < BENCH_ITEMS; Loop++)
+    {
+        Item = (Producer << 24) | Loop;
+
+        if(Bench_Kind == BENCH_FREERTOS_QUEUE)
+        {
+            xQueueSendToBack(Bench_Queue,&Item,portMAX_DELAY);
+        }
+        else
+        {
+            //The MPSC queue never blocks a producer, a full queue gives the core to the other tasks
+            while(Mpsc_Send(&Bench_Mpsc,&Item) != pdPASS)
+            {
+                taskYIELD();
+            }
+        }
+    }
+
+    vTaskDelete(NULL);
+}
+
+/*Runs one configuration with the calling task as the consumer, returns the time in microseconds*/
+static int64_t Bench_Run(BenchKind_t Kind, uint32_t Producers, uint32_t* OrderErrors)
+{
+    uint32_t Next[BENCH_MAX_PRODUCERS] = {0};
+    uint32_t Loop, Item, Producer;
+    int64_t Start;
+
+    Bench_Kind = Kind;
+    *OrderErrors = 0;
+    xEventGroupClearBits(Bench_Start,BENCH_START_BIT);
+
+    for(Loop = 0; Loop < Producers; Loop++)
+    {
+        xTaskCreatePinnedToCore(Bench_Producer,"Producer",2048,(void*)Loop,4,NULL,Loop & 1);
+    }
+
+    Start = esp_timer_get_time();
+    xEventGroupSetBits(Bench_Start,BENCH_START_BIT);
+
+    for(Loop = 0; Loop < (Producers * BENCH_ITEMS); Loop++)
+    {
+        if(Kind == BENCH_FREERTOS_QUEUE)
+        {
+            xQueueReceive(Bench_Queue,&Item,portMAX_DELAY);
+        }
+        else
+        {
+            Mpsc_Receive(&Bench_Mpsc,&Item,portMAX_DELAY);
+        }
+
+        //The items of one producer have to arrive in the order in which they were sent
+        Producer = Item >> 24;
+
+        if((Producer >= Producers) || ((Item & 0xFFFFFF) != Next[Producer]))
+        {
+            (*OrderErrors)++;
+        }
+        else
+        {
+            Next[Producer]++;
+        }
+    }
+
+    Start = esp_timer_get_time() - Start;
+
+    //Lets the idle task free the deleted producers
+    vTaskDelay(pdMS_TO_TICKS(20));
+
+    return Start;
+}
+
+static void Benchmark_Task(void* pvParameters)
+{
+    static const uint32_t Producers[] = {1, 2, 4, 8, 16};
+    uint32_t Loop, QueueErrors, MpscErrors;
+    int64_t QueueUs, MpscUs;
+
+    printf("Producers   Queue items/s   MPSC items/s   Speedup   Order errors\r\n");
+
+    for(Loop = 0; Loop < (sizeof(Producers) / sizeof(Producers[0])); Loop++)
+    {
+        QueueUs = Bench_Run(BENCH_FREERTOS_QUEUE,Producers[Loop],&QueueErrors);
+        MpscUs = Bench_Run(BENCH_MPSC_QUEUE,Producers[Loop],&MpscErrors);
+
+        printf("%9u %15lld %14lld %8.2fx %7u/%u\r\n",Producers[Loop],
+               ((int64_t)Producers[Loop] * BENCH_ITEMS * 1000000LL) / QueueUs,
+               ((int64_t)Producers[Loop] * BENCH_ITEMS * 1000000LL) / MpscUs,(double)QueueUs / (double)MpscUs,
+               QueueErrors,MpscErrors);
+    }
+
+    vTaskDelete(NULL);
+}
+
+/*---------------------------------------------- Interrupt producer ----------------------------------------------*/
+
+static uint8_t Event_Storage[16 * MPSC_CELL_SIZE(sizeof(uint32_t))];
+static Mpsc_t Event_Mpsc;
+
+static void Interrupt_Handler(void *arg)
+{
+    static uint32_t Count = 0;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    uint32_t Item;
+
+    xt_set_intclear(1 << SW_ISR_LEVEL_3);
+
+    Item = 0x80000000 | Count++;
+    Mpsc_SendFromISR(&Event_Mpsc,&Item,&xHigherPriorityTaskWoken);
+
+    portYIELD_FROM_ISR();
+}
+
+static void Event_Sender(void* pvParameters)
+{
+    uint32_t Item = 0;
+
+    for(;;)
+    {
+        Mpsc_Send(&Event_Mpsc,&Item);
+        Item++;
+
+        //Every second item comes from the interrupt
+        xt_set_intset(1 << SW_ISR_LEVEL_3);
+        vTaskDelay(pdMS_TO_TICKS(500));
+    }
+}
+
+static void Event_Receiver(void* pvParameters)
+{
+    uint32_t Item;
+
+    for(;;)
+    {
+        if(Mpsc_Receive(&Event_Mpsc,&Item,pdMS_TO_TICKS(1000)) == pdPASS)
+        {
+            printf("Received %s item %u\r\n",(Item & 0x80000000) ? "ISR" : "task",Item & 0x7FFFFFFF);
+        }
+        else
+        {
+            printf("Unable to receive queue data!\r\n");
+        }
+    }
+}
+
+void app_main(void)
+{
+    Bench_Queue = xQueueCreate(BENCH_LENGTH,sizeof(uint32_t));
+    Bench_Start = xEventGroupCreate();
+
+    if((Bench_Queue == NULL) || (Bench_Start == NULL) ||
+       (Mpsc_Init(&Bench_Mpsc,Bench_Storage,BENCH_LENGTH,sizeof(uint32_t)) != pdPASS))
+    {
+        ESP_LOGE(RTOS,"Benchmark could not be set up\r\n");
+        return;
+    }
+
+    //The consumer runs above the producers so it drains the queue whenever there is something in it
+    xTaskCreatePinnedToCore(Benchmark_Task,"Benchmark",4096,NULL,5,NULL,0);
+
+    Mpsc_Init(&Event_Mpsc,Event_Storage,16,sizeof(uint32_t));
+    esp_intr_alloc(ETS_INTERNAL_SW1_INTR_SOURCE,0,Interrupt_Handler,NULL,NULL);
+    xTaskCreate(Event_Receiver,"Receiver",2048,NULL,2,NULL);
+    xTaskCreate(Event_Sender,"Sender",2048,NULL,1,NULL);
+}
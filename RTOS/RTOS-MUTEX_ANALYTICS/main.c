@@ -0,0 +1,418 @@
+/**
+ * @file main.c
+ * @author Tushar Uttekar
+ *
+ * @brief
+ *
+ * This example demonstrates instrumented mutexes, the Print_String of example 20 takes its mutex through a probe which shows
+ * how long the tasks wait on each other and how often the priority inheritance of the mutex raises the holder.
+ *
+ * A mutex which should be measured is described by a MutexProbe_t, the code calls MutexProbe_Take and MutexProbe_Give instead of
+ * xSemaphoreTake and xSemaphoreGive.
+ * ->Acquisitions, contended acquisitions (the mutex was held when the task came) and timeouts are counted.
+ * ->Wait, the time from the call of take until the mutex is held, hold, the time from then until it is given back, both with
+ *   average, maximum and a log2 histogram in microseconds.
+ * ->Owner, the task which holds the mutex right now and since when, MutexProbe_Query copies it along with the statistics.
+ * ->Boosts, the holder saves its priority when it takes the mutex, a higher priority when it gives the mutex back means that a
+ *   waiter has raised it through priority inheritance. The count and the highest boost in priority levels are kept.
+ * ->Lock order, with MUTEX_LOCK_ORDER set every take adds an edge from each mutex which the task already holds to the one it
+ *   takes. An edge which closes a cycle is a potential deadlock, it is reported once with the two mutexes and the task even when
+ *   the timing never lets the deadlock happen.
+ *
+ * MutexProbe_Dump prints every probe which has been used, MutexProbe_Reset clears the statistics.
+ *
+ * NOTE : The probes are for normal mutexes, not recursive ones. The boost check compares the priority at the give with the one
+ *        at the take, a task which already runs boosted by another mutex at the take is only seen when it is raised further.
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "esp_system.h"
+
+#define RTOS                    "FREERTOS"
+
+#define MUTEX_LOCK_ORDER        1
+#define MUTEX_MAX_PROBES        32          //Size of the lock order graph, one bit per probe
+#define MUTEX_HIST_BUCKETS      16
+
+typedef struct
+{
+    uint32_t Acquisitions;
+    uint32_t Contended;
+    uint32_t Timeouts;
+    uint64_t WaitUs;
+    uint32_t WaitMaxUs;
+    uint64_t HoldUs;
+    uint32_t HoldMaxUs;
+    uint32_t Boosts;
+    UBaseType_t BoostMax;                   //Highest rise of the holder, in priority levels
+    uint32_t WaitHistogram[MUTEX_HIST_BUCKETS];
+    uint32_t HoldHistogram[MUTEX_HIST_BUCKETS];
+
+    TaskHandle_t Owner;
+    int64_t OwnedSince;
+}MutexStats_t;
+
+typedef struct MutexProbe
+{
+    const char* Name;
+    SemaphoreHandle_t Handle;
+    struct MutexProbe* Next;
+    uint32_t Id;
+
+    //Written by the holder only
+    UBaseType_t OwnerPriority;
+    int64_t Acquired;
+
+    portMUX_TYPE Lock;                      //Keeps the statistics consistent for MutexProbe_Query
+    MutexStats_t Stats;
+}MutexProbe_t;
+
+#define MUTEX_PROBE_INIT(ProbeName)     { .Name = (ProbeName), .Lock = portMUX_INITIALIZER_UNLOCKED }
+
+static MutexProbe_t* Mutex_Probes;
+static uint32_t Mutex_ProbeCount;
+static portMUX_TYPE Mutex_RegistryLock = portMUX_INITIALIZER_UNLOCKED;
+
+#if MUTEX_LOCK_ORDER
+static uint32_t Mutex_Order[MUTEX_MAX_PROBES];     //Bit B of entry A, B has been taken while A was held
+static uint32_t Mutex_Reported[MUTEX_MAX_PROBES];  //Pairs which have already been reported as a potential deadlock
+#endif
+
+/*---------------------------------------------- Mutex probe ----------------------------------------------*/
+
+static inline uint32_t MutexProbe_Bucket(uint32_t Us)
+{
+    uint32_t Bucket = 31 - __builtin_clz(Us | 1);
+
+    return (Bucket >= MUTEX_HIST_BUCKETS) ? (MUTEX_HIST_BUCKETS - 1) : Bucket;
+}
+
+/*Creates the mutex and puts the probe into the registry*/
+static BaseType_t MutexProbe_Create(MutexProbe_t* Probe)
+{
+    BaseType_t xStatus = pdFAIL;
+
+    Probe->Handle = xSemaphoreCreateMutex();
+
+    if(Probe->Handle == NULL)
+    {
+        return pdFAIL;
+    }
+
+    portENTER_CRITICAL(&Mutex_RegistryLock);
+
+    if(Mutex_ProbeCount < MUTEX_MAX_PROBES)
+    {
+        Probe->Id = Mutex_ProbeCount++;
+        Probe->Next = Mutex_Probes;
+        Mutex_Probes = Probe;
+        xStatus = pdPASS;
+    }
+
+    portEXIT_CRITICAL(&Mutex_RegistryLock);
+
+    if(xStatus == pdFAIL)
+    {
+        vSemaphoreDelete(Probe->Handle);
+        Probe->Handle = NULL;
+    }
+
+    return xStatus;
+}
+
+#if MUTEX_LOCK_ORDER
+/*True when To can be reached from From over the edges of the lock order graph*/
+static BaseType_t MutexProbe_Reaches(uint32_t From, uint32_t To)
+{
+    uint32_t Seen = 1UL << From, Frontier = 1UL << From, Next, Node;
+
+    while(Frontier != 0)
+    {
+        Next = 0;
+
+        for(Node = 0; Node < Mutex_ProbeCount; Node++)
+        {
+            if((Frontier & (1UL << Node)) != 0)
+            {
+                Next |= Mutex_Order[Node];
+            }
+        }
+
+        if((Next & (1UL << To)) != 0)
+        {
+            return pdTRUE;
+        }
+
+        Frontier = Next & ~Seen;
+        Seen |= Next;
+    }
+
+    return pdFALSE;
+}
+
+/*Adds the edges from the held mutexes to Probe, checked before the take blocks so a real deadlock is still reported*/
+static void MutexProbe_CheckOrder(MutexProbe_t* Probe)
+{
+    TaskHandle_t Self = xTaskGetCurrentTaskHandle();
+    MutexProbe_t* Held;
+    const char* Other = NULL;
+
+    portENTER_CRITICAL(&Mutex_RegistryLock);
+
+    for(Held = Mutex_Probes; Held != NULL; Held = Held->Next)
+    {
+        if((Held == Probe) || (Held->Stats.Owner != Self))
+        {
+            continue;
+        }
+
+        if(((Mutex_Order[Held->Id] & (1UL << Probe->Id)) == 0) && (MutexProbe_Reaches(Probe->Id,Held->Id) == pdTRUE) &&
+           ((Mutex_Reported[Held->Id] & (1UL << Probe->Id)) == 0))
+        {
+            Mutex_Reported[Held->Id] |= 1UL << Probe->Id;
+            Other = Held->Name;
+        }
+
+        Mutex_Order[Held->Id] |= 1UL << Probe->Id;
+    }
+
+    portEXIT_CRITICAL(&Mutex_RegistryLock);
+
+    if(Other != NULL)
+    {
+        ESP_LOGW(RTOS,"Potential deadlock, %s takes %s while holding %s, the opposite order has been seen before.\r\n",
+                 pcTaskGetTaskName(NULL),Probe->Name,Other);
+    }
+}
+#endif
+
+static BaseType_t MutexProbe_Take(MutexProbe_t* Probe, TickType_t Timeout)
+{
+    int64_t Start = esp_timer_get_time(), Now;
+    BaseType_t Contended = pdFALSE;
+    uint32_t Wait;
+    MutexStats_t* Stats = &Probe->Stats;
+
+#if MUTEX_LOCK_ORDER
+    MutexProbe_CheckOrder(Probe);
+#endif
+
+    //The try without blocking tells a free mutex from a contended one
+    if(xSemaphoreTake(Probe->Handle,0) != pdTRUE)
+    {
+        Contended = pdTRUE;
+
+        if(xSemaphoreTake(Probe->Handle,Timeout) != pdTRUE)
+        {
+            portENTER_CRITICAL(&Probe->Lock);
+            Stats->Timeouts++;
+            portEXIT_CRITICAL(&Probe->Lock);
+
+            return pdFAIL;
+        }
+    }
+
+    Now = esp_timer_get_time();
+    Wait = (uint32_t)(Now - Start);
+    Probe->OwnerPriority = uxTaskPriorityGet(NULL);
+    Probe->Acquired = Now;
+
+    portENTER_CRITICAL(&Probe->Lock);
+    Stats->Acquisitions++;
+    Stats->Contended += (Contended == pdTRUE) ? 1 : 0;
+    Stats->WaitUs += Wait;
+    Stats->WaitMaxUs = (Wait > Stats->WaitMaxUs) ? Wait : Stats->WaitMaxUs;
+    Stats->WaitHistogram[MutexProbe_Bucket(Wait)]++;
+    Stats->Owner = xTaskGetCurrentTaskHandle();
+    Stats->OwnedSince = Now;
+    portEXIT_CRITICAL(&Probe->Lock);
+
+    return pdPASS;
+}
+
+static BaseType_t MutexProbe_Give(MutexProbe_t* Probe)
+{
+    uint32_t Hold = (uint32_t)(esp_timer_get_time() - Probe->Acquired);
+    UBaseType_t Priority = uxTaskPriorityGet(NULL);
+    MutexStats_t* Stats = &Probe->Stats;
+
+    //The priority drops back inside xSemaphoreGive, so the boost is read before
+    portENTER_CRITICAL(&Probe->Lock);
+    Stats->HoldUs += Hold;
+    Stats->HoldMaxUs = (Hold > Stats->HoldMaxUs) ? Hold : Stats->HoldMaxUs;
+    Stats->HoldHistogram[MutexProbe_Bucket(Hold)]++;
+
+    if(Priority > Probe->OwnerPriority)
+    {
+        Stats->Boosts++;
+        Stats->BoostMax = ((Priority - Probe->OwnerPriority) > Stats->BoostMax) ? (Priority - Probe->OwnerPriority) :
+                                                                                    Stats->BoostMax;
+    }
+
+    Stats->Owner = NULL;
+    portEXIT_CRITICAL(&Probe->Lock);
+
+    return xSemaphoreGive(Probe->Handle);
+}
+
+static void MutexProbe_Query(MutexProbe_t* Probe, MutexStats_t* Stats)
+{
+    portENTER_CRITICAL(&Probe->Lock);
+    *Stats = Probe->Stats;
+    portEXIT_CRITICAL(&Probe->Lock);
+}
+
+static void MutexProbe_PrintHistogram(const char* Title, const uint32_t* Histogram)
+{
+    uint32_t Loop;
+
+    printf("    %-5s",Title);
+
+    for(Loop = 0; Loop < MUTEX_HIST_BUCKETS; Loop++)
+    {
+        if(Histogram[Loop] != 0)
+        {
+            printf(" %s%uus:%u",(Loop == (MUTEX_HIST_BUCKETS - 1)) ? ">=" : "<",
+                   (Loop == (MUTEX_HIST_BUCKETS - 1)) ? (1U << Loop) : (2U << Loop),Histogram[Loop]);
+        }
+    }
+
+    printf("\r\n");
+}
+
+static void MutexProbe_Dump(void)
+{
+    MutexStats_t Stats;
+    MutexProbe_t* Probe;
+
+    printf("%-8s %8s %8s %6s %9s %9s %9s %9s %6s %5s  %s\r\n","Mutex","Acquires","Contend","TmOut","WaitAvg","WaitMax",
+           "HoldAvg","HoldMax","Boosts","Boost","Owner");
+
+    for(Probe = Mutex_Probes; Probe != NULL; Probe = Probe->Next)
+    {
+        MutexProbe_Query(Probe,&Stats);
+
+        if((Stats.Acquisitions == 0) && (Stats.Timeouts == 0))
+        {
+            continue;
+        }
+
+        printf("%-8s %8u %8u %6u %9llu %9u %9llu %9u %6u %5u  %s\r\n",Probe->Name,Stats.Acquisitions,Stats.Contended,
+               Stats.Timeouts,(Stats.Acquisitions != 0) ? (Stats.WaitUs / Stats.Acquisitions) : 0,Stats.WaitMaxUs,
+               (Stats.Acquisitions != 0) ? (Stats.HoldUs / Stats.Acquisitions) : 0,Stats.HoldMaxUs,Stats.Boosts,
+               Stats.BoostMax,(Stats.Owner != NULL) ? pcTaskGetTaskName(Stats.Owner) : "-");
+
+        MutexProbe_PrintHistogram("Wait",Stats.WaitHistogram);
+        MutexProbe_PrintHistogram("Hold",Stats.HoldHistogram);
+    }
+
+    printf("\r\n");
+}
+
+/*Clears the statistics, the owner and the lock order graph stay as they are*/
+static void MutexProbe_Reset(void)
+{
+    MutexProbe_t* Probe;
+    TaskHandle_t Owner;
+    int64_t OwnedSince;
+
+    for(Probe = Mutex_Probes; Probe != NULL; Probe = Probe->Next)
+    {
+        portENTER_CRITICAL(&Probe->Lock);
+        Owner = Probe->Stats.Owner;
+        OwnedSince = Probe->Stats.OwnedSince;
+        memset(&Probe->Stats,0,sizeof(MutexStats_t));
+        Probe->Stats.Owner = Owner;
+        Probe->Stats.OwnedSince = OwnedSince;
+        portEXIT_CRITICAL(&Probe->Lock);
+    }
+}
+
+/*---------------------------------------------- Instrumented application ----------------------------------------------*/
+
+static MutexProbe_t Print_Probe = MUTEX_PROBE_INIT("Print");
+static MutexProbe_t Uart_Probe = MUTEX_PROBE_INIT("Uart");
+static MutexProbe_t Spi_Probe = MUTEX_PROBE_INIT("Spi");
+
+static void Print_String(const char* InputString)
+{
+    //The take is measured, the priority 2 instance waits here while the priority 1 instance prints
+    MutexProbe_Take(&Print_Probe,portMAX_DELAY);
+
+    printf("%s",InputString);
+
+    MutexProbe_Give(&Print_Probe);
+}
+
+static void Print_Task(void* pvParameters)
+{
+    char* StringToPrint;
+    const TickType_t BlockTime = 0x20;
+
+    StringToPrint = (char*) pvParameters;
+
+    for(;;)
+    {
+        Print_String(StringToPrint);
+        vTaskDelay((rand() % BlockTime));
+    }
+}
+
+/*Takes the two peripheral mutexes in the order given, the other instance uses the opposite order*/
+static void Transfer_Task(void* pvParameters)
+{
+    MutexProbe_t** Order = (MutexProbe_t**) pvParameters;
+
+    for(;;)
+    {
+        if(MutexProbe_Take(Order[0],pdMS_TO_TICKS(100)) == pdPASS)
+        {
+            if(MutexProbe_Take(Order[1],pdMS_TO_TICKS(100)) == pdPASS)
+            {
+                vTaskDelay(1);
+                MutexProbe_Give(Order[1]);
+            }
+
+            MutexProbe_Give(Order[0]);
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(100) + (rand() % 50));
+    }
+}
+
+void app_main(void)
+{
+    static MutexProbe_t* UartFirst[] = {&Uart_Probe,&Spi_Probe};
+    static MutexProbe_t* SpiFirst[] = {&Spi_Probe,&Uart_Probe};
+
+    if((MutexProbe_Create(&Print_Probe) == pdPASS) && (MutexProbe_Create(&Uart_Probe) == pdPASS) &&
+       (MutexProbe_Create(&Spi_Probe) == pdPASS))
+    {
+        //The two printing instances of example 20
+        xTaskCreate(Print_Task,"First String",2048,"First Symbols --->  ~!@#$%%^&*()_+\r\n",1,NULL);
+        xTaskCreate(Print_Task,"Second String",2048,"Second Symbols --->  []|;',./?><:'{}\r\n",2,NULL);
+
+        //Opposite lock order on two peripherals, the timeouts and the delays keep it from locking up
+        xTaskCreate(Transfer_Task,"Transfer-1",2048,UartFirst,3,NULL);
+        xTaskCreate(Transfer_Task,"Transfer-2",2048,SpiFirst,3,NULL);
+    }
+
+    for(;;)
+    {
+        vTaskDelay(pdMS_TO_TICKS(5000));
+        MutexProbe_Dump();
+        MutexProbe_Reset();
+    }
+}
@@ -0,0 +1,361 @@
+/**
+ * @file main.c
+ * @author Tushar Uttekar
+ *
+ * @brief
+ *
+ * This example demonstrates a reusable multi stage processing pipeline in which the stages hand over complete blocks of samples
+ * to each other through double buffers and task notifications, instead of passing one value at a time through queues as in
+ * example 19.
+ *
+ * The pipeline of this example is acquire -> filter -> feature extract -> publish.
+ * ->Every stage is a task which can be pinned to its own core and owns two output blocks (double buffer), while the next stage
+ *   is processing one block the stage can already fill the other one.
+ * ->A stage tells the next stage that a block is READY and the previous stage that its block is FREE again by setting bits in
+ *   the notification value of that task, so no queue or copy of the data is involved in the hand over.
+ * ->When a stage is slower than its input both of its input blocks stay in use, the previous stage then has to wait for a FREE
+ *   block which is the backpressure, it travels back stage by stage until it reaches the acquisition.
+ * ->For every stage the number of blocks, the processing time, the time spent waiting for input (idle) and the time spent
+ *   waiting for a free output block (stall) are measured, along with the end to end latency of the blocks at the last stage.
+ *
+ * NOTE : The end to end benchmark runs on the target, first with a fast publish stage and then with a slow one so that the
+ *        backpressure can be seen in the stall times of all the stages in front of it.
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "esp_system.h"
+
+#define RTOS                    "freertos"
+
+#define PIPE_BLOCK_SAMPLES      64
+#define PIPE_READY(Index)       (1UL << (Index))
+#define PIPE_FREE(Index)        (1UL << (2 + (Index)))
+
+typedef struct
+{
+    int64_t Timestamp;                      //Time of the acquisition of the block, carried through all the stages
+    uint32_t Sequence;
+    size_t Count;
+    int32_t Data[PIPE_BLOCK_SAMPLES];
+}PipeBlock_t;
+
+/*Processes one block, In is NULL for the first stage and Out is NULL for the last one, returns the number of output samples*/
+typedef size_t (*PipeProcess_t)(void* Context, const int32_t* In, size_t Count, int32_t* Out);
+
+typedef struct
+{
+    uint32_t Blocks;
+    int64_t ProcessUs;
+    int64_t ProcessMaxUs;
+    int64_t IdleUs;                         //Waiting for a READY input block
+    int64_t StallUs;                        //Waiting for a FREE output block, caused by the backpressure
+    int64_t LatencyUs;                      //End to end latency, last stage only
+    int64_t LatencyMaxUs;
+}PipeStats_t;
+
+typedef struct PipeStage
+{
+    const char* Name;
+    PipeProcess_t Process;
+    void* Context;
+    BaseType_t Core;
+    UBaseType_t Priority;
+    TickType_t Period;                      //Pacing of the first stage, 0 for the other stages
+
+    //Filled by Pipeline_Start
+    struct PipeStage* Prev;
+    struct PipeStage* Next;
+    TaskHandle_t Task;
+    uint32_t Pending;                       //Notification bits received but not consumed yet
+    PipeBlock_t Out[2];
+    PipeStats_t Stats;
+}PipeStage_t;
+
+static portMUX_TYPE Pipe_StatsLock = portMUX_INITIALIZER_UNLOCKED;
+
+/*---------------------------------------------- Pipeline framework ----------------------------------------------*/
+
+/*Blocks until the Bit is received, the other bits are kept in Pending for later, returns the time spent waiting*/
+static int64_t Pipeline_WaitBit(PipeStage_t* Stage, uint32_t Bit)
+{
+    int64_t Start = esp_timer_get_time();
+    uint32_t Bits;
+
+    while((Stage->Pending & Bit) == 0)
+    {
+        xTaskNotifyWait(0,0xFFFFFFFF,&Bits,portMAX_DELAY);
+        Stage->Pending |= Bits;
+    }
+
+    Stage->Pending &= ~Bit;
+
+    return esp_timer_get_time() - Start;
+}
+
+static void Pipeline_StageTask(void* pvParameters)
+{
+    PipeStage_t* Stage = (PipeStage_t*) pvParameters;
+    const PipeBlock_t* In;
+    PipeBlock_t* Out;
+    TickType_t LastExecutionTime = xTaskGetTickCount();
+    uint8_t InIndex = 0, OutIndex = 0;
+    uint32_t Sequence = 0;
+    int64_t Idle, Stall, Start, Process, Latency = 0;
+
+    for(;;)
+    {
+        Idle = 0;
+        Stall = 0;
+        In = NULL;
+        Out = NULL;
+
+        if(Stage->Prev == NULL)
+        {
+            vTaskDelayUntil(&LastExecutionTime,Stage->Period);
+        }
+        else
+        {
+            Idle = Pipeline_WaitBit(Stage,PIPE_READY(InIndex));
+            In = &Stage->Prev->Out[InIndex];
+        }
+
+        if(Stage->Next != NULL)
+        {
+            Stall = Pipeline_WaitBit(Stage,PIPE_FREE(OutIndex));
+            Out = &Stage->Out[OutIndex];
+        }
+
+        Start = esp_timer_get_time();
+
+        if(Out != NULL)
+        {
+            Out->Timestamp = (In != NULL) ? In->Timestamp : Start;
+            Out->Sequence = (In != NULL) ? In->Sequence : Sequence++;
+            Out->Count = Stage->Process(Stage->Context,(In != NULL) ? In->Data : NULL,(In != NULL) ? In->Count : 0,Out->Data);
+        }
+        else
+        {
+            Stage->Process(Stage->Context,In->Data,In->Count,NULL);
+        }
+
+        Process = esp_timer_get_time() - Start;
+
+        if(In != NULL)
+        {
+            Latency = esp_timer_get_time() - In->Timestamp;
+
+            //The input block is not used any more, hand it back to the previous stage
+            xTaskNotify(Stage->Prev->Task,PIPE_FREE(InIndex),eSetBits);
+            InIndex ^= 1;
+        }
+
+        if(Out != NULL)
+        {
+            xTaskNotify(Stage->Next->Task,PIPE_READY(OutIndex),eSetBits);
+            OutIndex ^= 1;
+        }
+
+        portENTER_CRITICAL(&Pipe_StatsLock);
+        Stage->Stats.Blocks++;
+        Stage->Stats.ProcessUs += Process;
+        Stage->Stats.IdleUs += Idle;
+        Stage->Stats.StallUs += Stall;
+
+        if(Process > Stage->Stats.ProcessMaxUs)
+        {
+            Stage->Stats.ProcessMaxUs = Process;
+        }
+
+        if(Stage->Next == NULL)
+        {
+            Stage->Stats.LatencyUs += Latency;
+
+            if(Latency > Stage->Stats.LatencyMaxUs)
+            {
+                Stage->Stats.LatencyMaxUs = Latency;
+            }
+        }
+        portEXIT_CRITICAL(&Pipe_StatsLock);
+    }
+}
+
+/*Links the stages and creates their tasks, from the last stage to the first so every task it notifies already exists*/
+static BaseType_t Pipeline_Start(PipeStage_t* Stages, size_t Count)
+{
+    BaseType_t xStatus = pdPASS;
+    int Loop;
+
+    for(Loop = 0; Loop < (int)Count; Loop++)
+    {
+        Stages[Loop].Prev = (Loop > 0) ? &Stages[Loop - 1] : NULL;
+        Stages[Loop].Next = (Loop < (int)Count - 1) ? &Stages[Loop + 1] : NULL;
+        Stages[Loop].Pending = PIPE_FREE(0) | PIPE_FREE(1);
+        memset(&Stages[Loop].Stats,0,sizeof(PipeStats_t));
+    }
+
+    for(Loop = (int)Count - 1; (Loop >= 0) && (xStatus == pdPASS); Loop--)
+    {
+        xStatus = xTaskCreatePinnedToCore(Pipeline_StageTask,Stages[Loop].Name,3072,&Stages[Loop],Stages[Loop].Priority,
+                                          &Stages[Loop].Task,Stages[Loop].Core);
+    }
+
+    return xStatus;
+}
+
+/*Prints the statistics of every stage for the last Interval and starts a new interval*/
+static void Pipeline_PrintStats(PipeStage_t* Stages, size_t Count, int64_t IntervalUs)
+{
+    PipeStats_t Stats;
+    size_t Loop;
+
+    printf("%-10s %8s %10s %10s %10s %10s %12s\r\n","Stage","Blk/s","AvgUs","MaxUs","Idle%","Stall%","LatencyUs");
+
+    for(Loop = 0; Loop < Count; Loop++)
+    {
+        portENTER_CRITICAL(&Pipe_StatsLock);
+        Stats = Stages[Loop].Stats;
+        memset(&Stages[Loop].Stats,0,sizeof(PipeStats_t));
+        portEXIT_CRITICAL(&Pipe_StatsLock);
+
+        printf("%-10s %8lld %10lld %10lld %10lld %10lld",Stages[Loop].Name,(Stats.Blocks * 1000000LL) / IntervalUs,
+               (Stats.Blocks != 0) ? (Stats.ProcessUs / Stats.Blocks) : 0,Stats.ProcessMaxUs,
+               (Stats.IdleUs * 100) / IntervalUs,(Stats.StallUs * 100) / IntervalUs);
+
+        if(Stages[Loop].Next == NULL)
+        {
+            printf(" %5lld/%-6lld",(Stats.Blocks != 0) ? (Stats.LatencyUs / Stats.Blocks) : 0,Stats.LatencyMaxUs);
+        }
+
+        printf("\r\n");
+    }
+
+    printf("\r\n");
+}
+
+/*---------------------------------------------- Sensor processing stages ----------------------------------------------*/
+
+static volatile uint32_t Publish_DelayUs = 0;
+
+static size_t Acquire_Process(void* Context, const int32_t* In, size_t Count, int32_t* Out)
+{
+    uint32_t* Phase = (uint32_t*) Context;
+    size_t Loop;
+
+    //Simulated sensor, a triangle wave with some noise on it
+    for(Loop = 0; Loop < PIPE_BLOCK_SAMPLES; Loop++)
+    {
+        (*Phase)++;
+        Out[Loop] = (int32_t)((*Phase & 0x200) ? (0x3FF - (*Phase & 0x3FF)) : (*Phase & 0x3FF)) + (int32_t)(esp_random() & 0x1F);
+    }
+
+    return PIPE_BLOCK_SAMPLES;
+}
+
+static size_t Filter_Process(void* Context, const int32_t* In, size_t Count, int32_t* Out)
+{
+    int32_t* Average = (int32_t*) Context;
+    size_t Loop;
+
+    //Exponential moving average with a weight of 1/8, the state is kept from one block to the next
+    for(Loop = 0; Loop < Count; Loop++)
+    {
+        *Average += (In[Loop] - *Average) / 8;
+        Out[Loop] = *Average;
+    }
+
+    return Count;
+}
+
+static size_t Feature_Process(void* Context, const int32_t* In, size_t Count, int32_t* Out)
+{
+    int32_t Min = INT32_MAX, Max = INT32_MIN;
+    int64_t Sum = 0;
+    size_t Loop;
+
+    for(Loop = 0; Loop < Count; Loop++)
+    {
+        Sum += In[Loop];
+
+        if(In[Loop] < Min)
+        {
+            Min = In[Loop];
+        }
+
+        if(In[Loop] > Max)
+        {
+            Max = In[Loop];
+        }
+    }
+
+    Out[0] = Min;
+    Out[1] = Max;
+    Out[2] = (Count != 0) ? (int32_t)(Sum / (int64_t)Count) : 0;
+
+    return 3;
+}
+
+static size_t Publish_Process(void* Context, const int32_t* In, size_t Count, int32_t* Out)
+{
+    uint32_t* Published = (uint32_t*) Context;
+
+    if((++(*Published) % 500) == 0)
+    {
+        printf("Published features min %d max %d mean %d\r\n",In[0],In[1],In[2]);
+    }
+
+    //Simulates a slow uplink for the backpressure part of the benchmark
+    int64_t Start = esp_timer_get_time();
+
+    while((esp_timer_get_time() - Start) < Publish_DelayUs);
+
+    return 0;
+}
+
+static uint32_t Acquire_Phase, Publish_Count;
+static int32_t Filter_Average;
+
+static PipeStage_t Sensor_Pipeline[] =
+{
+    {.Name = "Acquire", .Process = Acquire_Process, .Context = &Acquire_Phase,  .Core = 0, .Priority = 4, .Period = 1},
+    {.Name = "Filter",  .Process = Filter_Process,  .Context = &Filter_Average, .Core = 0, .Priority = 3},
+    {.Name = "Feature", .Process = Feature_Process, .Context = NULL,            .Core = 1, .Priority = 3},
+    {.Name = "Publish", .Process = Publish_Process, .Context = &Publish_Count,  .Core = 1, .Priority = 2},
+};
+
+#define SENSOR_STAGES           (sizeof(Sensor_Pipeline) / sizeof(Sensor_Pipeline[0]))
+
+void app_main(void)
+{
+    if(Pipeline_Start(Sensor_Pipeline,SENSOR_STAGES) != pdPASS)
+    {
+        ESP_LOGE(RTOS,"Pipeline could not be started\r\n");
+        return;
+    }
+
+    //Fast publish stage, the pipeline keeps up with the acquisition at one block per tick
+    vTaskDelay(pdMS_TO_TICKS(3000));
+    printf("Pipeline with a fast publish stage\r\n");
+    Pipeline_PrintStats(Sensor_Pipeline,SENSOR_STAGES,3000000);
+
+    //Publish takes longer than a tick (10 ms at the default tick rate), the stall moves back through the stages to the acquisition
+    Publish_DelayUs = 15000;
+    printf("Pipeline with a slow publish stage (%u us per block)\r\n",Publish_DelayUs);
+    vTaskDelay(pdMS_TO_TICKS(3000));
+    Pipeline_PrintStats(Sensor_Pipeline,SENSOR_STAGES,3000000);
+
+    for(;;)
+    {
+        vTaskDelay(pdMS_TO_TICKS(10000));
+        Pipeline_PrintStats(Sensor_Pipeline,SENSOR_STAGES,10000000);
+    }
+}
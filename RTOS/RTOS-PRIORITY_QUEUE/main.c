@@ -0,0 +1,400 @@
+/**
+ * @file main.c
+ * @author Tushar Uttekar
+ *
+ * @brief
+ *
+ * This example demonstrates a priority message queue which can be used instead of xQueueSendToFront when some messages have to
+ * be handled ahead of the others, as it was done by the tick hook in example 21.
+ *
+ * Sending to the front of a queue gives only two levels and the urgent messages come out in the reverse order of their sending.
+ * The priority queue here has PRIO_QUEUE_LEVELS levels (8 in this example) where:
+ * ->Every level is a FIFO of its own, so the messages of the same level come out in the order they were sent.
+ * ->A bitmap keeps one bit for every non empty level, so the highest non empty level is found with a single count leading zero
+ *   instruction and the receive does not depend on the number of levels or messages.
+ * ->A counting semaphore holds the number of messages in the queue, using which the receiving task blocks when the queue is
+ *   empty and which can be given from an ISR as well, so the send is ISR safe.
+ *
+ * Optional aging is enabled by setting PRIO_QUEUE_AGING_TICKS to a non zero value, a message then gains one level for every
+ * PRIO_QUEUE_AGING_TICKS it has waited so that the low levels are not starved by a steady stream of high level messages.
+ *
+ * For every level the current count, the peak count, the sent, received and dropped messages and the number of times a message
+ * of that level was taken ahead of a higher level due to aging are maintained.
+ *
+ * In the example the gatekeeper of example 21 receives from the priority queue, the print tasks send on different levels and the
+ * tick hook sends its message on the highest level at an interval of 200 ticks.
+ *
+ * NOTE : The tick hook is registered with esp_register_freertos_tick_hook instead of defining vApplicationTickHook, as
+ *        ESP32 uses its own implementation of the tick hook function.
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_freertos_hooks.h"
+#include "esp_log.h"
+#include "esp_system.h"
+
+#define RTOS                    "freertos"
+#define PRIO_QUEUE_MAX_LEVELS   32
+#define PRIO_QUEUE_LEVELS       8
+#define PRIO_QUEUE_DEPTH        4
+#define PRIO_QUEUE_AGING_TICKS  (pdMS_TO_TICKS(100))
+#define STATS_PERIOD            (pdMS_TO_TICKS(5000))
+
+#define LEVEL_URGENT            (PRIO_QUEUE_LEVELS - 1)
+
+/*Per level statistics*/
+typedef struct
+{
+    UBaseType_t Count;
+    UBaseType_t PeakCount;
+    uint32_t Sent;
+    uint32_t Received;
+    uint32_t Dropped;
+    uint32_t Aged;
+}PrioLevelStats_t;
+
+/*Ring of one level, the slots of all the levels are kept in the storage given at the initialisation*/
+typedef struct
+{
+    uint8_t* Slots;
+    UBaseType_t Head;
+    UBaseType_t Tail;
+    PrioLevelStats_t Stats;
+}PrioLevel_t;
+
+typedef struct
+{
+    PrioLevel_t Levels[PRIO_QUEUE_MAX_LEVELS];
+    UBaseType_t LevelCount;
+    UBaseType_t Depth;
+    UBaseType_t ItemSize;
+    UBaseType_t SlotSize;
+    TickType_t AgingTicks;
+    uint32_t NonEmpty;
+    SemaphoreHandle_t Items;
+    portMUX_TYPE Lock;
+}PrioQueue_t;
+
+/*Every slot holds the send time ahead of the message which is used for the aging*/
+#define PRIO_QUEUE_SLOT_SIZE(ItemSize)  (sizeof(TickType_t) + (ItemSize))
+#define PRIO_QUEUE_STORAGE_SIZE(Levels,Depth,ItemSize)  ((Levels) * (Depth) * PRIO_QUEUE_SLOT_SIZE(ItemSize))
+
+/*---------------------------------------------- Priority queue ----------------------------------------------*/
+
+BaseType_t PrioQueue_Init(PrioQueue_t* Queue, UBaseType_t LevelCount, UBaseType_t Depth, UBaseType_t ItemSize,
+                          TickType_t AgingTicks, uint8_t* Storage)
+{
+    UBaseType_t Level;
+
+    if((LevelCount == 0) || (LevelCount > PRIO_QUEUE_MAX_LEVELS))
+    {
+        return pdFAIL;
+    }
+
+    memset(Queue,0,sizeof(PrioQueue_t));
+
+    Queue->LevelCount = LevelCount;
+    Queue->Depth = Depth;
+    Queue->ItemSize = ItemSize;
+    Queue->SlotSize = PRIO_QUEUE_SLOT_SIZE(ItemSize);
+    Queue->AgingTicks = AgingTicks;
+    vPortCPUInitializeMutex(&Queue->Lock);
+
+    for(Level = 0; Level < LevelCount; Level++)
+    {
+        Queue->Levels[Level].Slots = Storage + (Level * Depth * Queue->SlotSize);
+    }
+
+    //The semaphore count is the number of messages in the whole queue
+    Queue->Items = xSemaphoreCreateCounting(LevelCount * Depth,0);
+
+    return (Queue->Items != NULL) ? pdPASS : pdFAIL;
+}
+
+/*Copies the message in the level, has to be called with the lock taken*/
+static BaseType_t PrioQueue_Put(PrioQueue_t* Queue, UBaseType_t Level, const void* Item, TickType_t Now)
+{
+    PrioLevel_t* Ring = &Queue->Levels[Level];
+    uint8_t* Slot;
+
+    if(Ring->Stats.Count >= Queue->Depth)
+    {
+        Ring->Stats.Dropped++;
+        return errQUEUE_FULL;
+    }
+
+    Slot = Ring->Slots + (Ring->Tail * Queue->SlotSize);
+    memcpy(Slot,&Now,sizeof(TickType_t));
+    memcpy(Slot + sizeof(TickType_t),Item,Queue->ItemSize);
+
+    Ring->Tail = (Ring->Tail + 1) % Queue->Depth;
+    Ring->Stats.Count++;
+    Ring->Stats.Sent++;
+
+    if(Ring->Stats.Count > Ring->Stats.PeakCount)
+    {
+        Ring->Stats.PeakCount = Ring->Stats.Count;
+    }
+
+    Queue->NonEmpty |= (1U << Level);
+
+    return pdPASS;
+}
+
+BaseType_t PrioQueue_Send(PrioQueue_t* Queue, UBaseType_t Level, const void* Item)
+{
+    BaseType_t xStatus;
+
+    if(Level >= Queue->LevelCount)
+    {
+        return pdFAIL;
+    }
+
+    portENTER_CRITICAL(&Queue->Lock);
+    xStatus = PrioQueue_Put(Queue,Level,Item,xTaskGetTickCount());
+    portEXIT_CRITICAL(&Queue->Lock);
+
+    if(xStatus == pdPASS)
+    {
+        xSemaphoreGive(Queue->Items);
+    }
+
+    return xStatus;
+}
+
+BaseType_t PrioQueue_SendFromISR(PrioQueue_t* Queue, UBaseType_t Level, const void* Item, BaseType_t* pxHigherPriorityTaskWoken)
+{
+    BaseType_t xStatus;
+
+    if(Level >= Queue->LevelCount)
+    {
+        return pdFAIL;
+    }
+
+    portENTER_CRITICAL_ISR(&Queue->Lock);
+    xStatus = PrioQueue_Put(Queue,Level,Item,xTaskGetTickCountFromISR());
+    portEXIT_CRITICAL_ISR(&Queue->Lock);
+
+    if(xStatus == pdPASS)
+    {
+        xSemaphoreGiveFromISR(Queue->Items,pxHigherPriorityTaskWoken);
+    }
+
+    return xStatus;
+}
+
+/*Picks the level to receive from, has to be called with the lock taken and at least one message in the queue*/
+static UBaseType_t PrioQueue_SelectLevel(PrioQueue_t* Queue, TickType_t Now)
+{
+    UBaseType_t Highest, Level, Best, BestScore, Score;
+    uint32_t Pending;
+    TickType_t SentAt;
+    PrioLevel_t* Ring;
+
+    //Highest non empty level straight from the bitmap
+    Highest = 31 - __builtin_clz(Queue->NonEmpty);
+
+    if(Queue->AgingTicks == 0)
+    {
+        return Highest;
+    }
+
+    //With aging only the oldest message of every non empty level is compared, which is bounded by the number of levels.
+    //The levels are scored from the highest one down, so on equal scores the higher level wins
+    Best = Highest;
+    BestScore = 0;
+    Pending = Queue->NonEmpty;
+
+    while(Pending != 0)
+    {
+        Level = 31 - __builtin_clz(Pending);
+        Pending &= ~(1U << Level);
+
+        Ring = &Queue->Levels[Level];
+        memcpy(&SentAt,Ring->Slots + (Ring->Head * Queue->SlotSize),sizeof(TickType_t));
+        Score = Level + ((Now - SentAt) / Queue->AgingTicks);
+
+        if((Level == Highest) || (Score > BestScore))
+        {
+            Best = Level;
+            BestScore = Score;
+        }
+    }
+
+    if(Best != Highest)
+    {
+        Queue->Levels[Best].Stats.Aged++;
+    }
+
+    return Best;
+}
+
+/**
+ * Receives the message of the highest level, blocking for up to Timeout ticks when the queue is empty.
+ * The level of the received message is written to Level when it is not NULL.
+ */
+BaseType_t PrioQueue_Receive(PrioQueue_t* Queue, void* Item, UBaseType_t* Level, TickType_t Timeout)
+{
+    PrioLevel_t* Ring;
+    UBaseType_t Selected;
+
+    if(xSemaphoreTake(Queue->Items,Timeout) != pdPASS)
+    {
+        return pdFAIL;
+    }
+
+    portENTER_CRITICAL(&Queue->Lock);
+
+    Selected = PrioQueue_SelectLevel(Queue,xTaskGetTickCount());
+    Ring = &Queue->Levels[Selected];
+
+    memcpy(Item,Ring->Slots + (Ring->Head * Queue->SlotSize) + sizeof(TickType_t),Queue->ItemSize);
+    Ring->Head = (Ring->Head + 1) % Queue->Depth;
+    Ring->Stats.Count--;
+    Ring->Stats.Received++;
+
+    if(Ring->Stats.Count == 0)
+    {
+        Queue->NonEmpty &= ~(1U << Selected);
+    }
+
+    portEXIT_CRITICAL(&Queue->Lock);
+
+    if(Level != NULL)
+    {
+        *Level = Selected;
+    }
+
+    return pdPASS;
+}
+
+BaseType_t PrioQueue_GetStats(PrioQueue_t* Queue, UBaseType_t Level, PrioLevelStats_t* Stats)
+{
+    if(Level >= Queue->LevelCount)
+    {
+        return pdFAIL;
+    }
+
+    portENTER_CRITICAL(&Queue->Lock);
+    *Stats = Queue->Levels[Level].Stats;
+    portEXIT_CRITICAL(&Queue->Lock);
+
+    return pdPASS;
+}
+
+/*---------------------------------------------- Example tasks ----------------------------------------------*/
+
+const char* strings[] = {"Task 1 printing the string message through the gatekeeper task\r\n",
+                         "Task 2 printing the string message through the gatekeeper task\r\n",
+                         "Tick Hook function printing the string message through the gatekeeper task\r\n",
+                         "Command task printing the string message through the gatekeeper task\r\n"
+                         };
+
+static uint8_t GateKeeper_Storage[PRIO_QUEUE_STORAGE_SIZE(PRIO_QUEUE_LEVELS,PRIO_QUEUE_DEPTH,sizeof(char*))];
+PrioQueue_t GateKeeper_Queue;
+
+static void GateKeeper_Task(void* pvParameters)
+{
+    char* print_string;
+    UBaseType_t Level;
+
+    for(;;)
+    {
+        //The highest level message will be printed first, messages of the same level in the order they were sent
+        if(PrioQueue_Receive(&GateKeeper_Queue,&print_string,&Level,portMAX_DELAY) == pdPASS)
+        {
+            printf("[L%u] %s",Level,print_string);
+        }
+    }
+}
+
+static void Print_Task(void* pvParameters)
+{
+    char *string;
+    UBaseType_t Level;
+
+    string = (char*) pvParameters;
+
+    //Level is taken from the task priority so the two instances send on different levels
+    Level = uxTaskPriorityGet(NULL);
+
+    for(;;)
+    {
+        PrioQueue_Send(&GateKeeper_Queue,Level,&string);
+        vTaskDelay((rand() % (0x20)));
+    }
+}
+
+static void Command_Task(void* pvParameters)
+{
+    const char* string = strings[3];
+
+    for(;;)
+    {
+        //Commands are spread over all the levels below the urgent one
+        PrioQueue_Send(&GateKeeper_Queue,(rand() % LEVEL_URGENT),&string);
+        vTaskDelay((rand() % (0x40)));
+    }
+}
+
+static void Stats_Task(void* pvParameters)
+{
+    PrioLevelStats_t Stats;
+    UBaseType_t Level;
+
+    for(;;)
+    {
+        vTaskDelay(STATS_PERIOD);
+
+        printf("level count peak     sent     recv  dropped     aged\r\n");
+        for(Level = 0; Level < PRIO_QUEUE_LEVELS; Level++)
+        {
+            PrioQueue_GetStats(&GateKeeper_Queue,Level,&Stats);
+            printf("%5u %5u %4u %8u %8u %8u %8u\r\n",Level,Stats.Count,Stats.PeakCount,Stats.Sent,Stats.Received,
+                   Stats.Dropped,Stats.Aged);
+        }
+    }
+}
+
+static void GateKeeper_TickHook(void)
+{
+    static int count = 0;
+
+    count++;
+
+    //Here the string will be sent on the urgent level at an interval of 200 ticks
+    if(count >= 200)
+    {
+        PrioQueue_SendFromISR(&GateKeeper_Queue,LEVEL_URGENT,&strings[2],NULL);
+        count = 0;
+    }
+}
+
+void app_main(void)
+{
+    //Create priority queue for the gatekeeper operation
+    if(PrioQueue_Init(&GateKeeper_Queue,PRIO_QUEUE_LEVELS,PRIO_QUEUE_DEPTH,sizeof(char*),PRIO_QUEUE_AGING_TICKS,
+                      GateKeeper_Storage) == pdPASS)
+    {
+        //Create two instance of the task's which will print the string
+        xTaskCreate(Print_Task,"Print from 1st instance",2048,(void*)strings[0],1,NULL);
+        xTaskCreate(Print_Task,"Print from 2nd instance",2048,(void*)strings[1],2,NULL);
+        xTaskCreate(Command_Task,"Command",2048,NULL,2,NULL);
+
+        //GateKeeper task which will print the strings to the output terminal
+        xTaskCreate(GateKeeper_Task,"GateKeeper",2048,NULL,0,NULL);
+        xTaskCreate(Stats_Task,"Stats",2048,NULL,3,NULL);
+
+        esp_register_freertos_tick_hook(GateKeeper_TickHook);
+    }
+}
@@ -0,0 +1,477 @@
+/**
+ * @file main.c
+ * @author Tushar Uttekar
+ *
+ * @brief
+ *
+ * This example demonstrates a system wide queue registry which can be used for measuring how the queues, semaphores and queue
+ * sets of an application are actually being used at run time instead of checking uxQueueMessagesWaiting inline as it was done
+ * in example 10 and example 11.
+ *
+ * Every object is registered once under a name with the Registry_Add function which also places it in the kernel queue registry
+ * through vQueueAddToRegistry (only when configQUEUE_REGISTRY_SIZE is enabled in the menuconfig) so the name is visible in the
+ * debugger as well.
+ *
+ * ->The send and receive calls go through the Registry_Send and Registry_Receive wrappers which count the successful and the
+ *   failed operations, the number of task's currently blocked on the object and the depth reached right after every send.
+ * ->The sampler task periodically reads the current depth of every registered object, updates the peak depth and calculates the
+ *   send and receive rates in messages per second.
+ * ->At a longer interval the sampler prints a compact dump with one line per object along with a suggested length which is the
+ *   peak depth plus some headroom, so the length of each queue can be decided from real data instead of a guess.
+ *
+ * The statistics of a particular object can also be read by any task with the Registry_GetStats function.
+ *
+ * NOTE : The kernel does not expose the number of task's waiting on a queue, so the blocked count here is maintained by the
+ *        wrappers and only covers the calls which go through them.
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_system.h"
+
+#define RTOS                    "freertos"
+#define REGISTRY_MAX_ENTRIES    16
+#define SAMPLE_PERIOD           (pdMS_TO_TICKS(100))
+#define DUMP_PERIOD             (pdMS_TO_TICKS(5000))
+#define SEMAPHORE_GIVE_PERIOD   (pdMS_TO_TICKS(250))
+
+/*Type of the object which is registered, used only for the dump output*/
+typedef enum
+{
+    Registry_Queue = 0,
+    Registry_Semaphore,
+    Registry_QueueSet
+}RegistryType_t;
+
+/*Statistics which are maintained for every registered object*/
+typedef struct
+{
+    UBaseType_t Length;
+    UBaseType_t CurrentDepth;
+    UBaseType_t PeakDepth;
+    uint32_t Sends;
+    uint32_t Receives;
+    uint32_t SendFails;
+    uint32_t ReceiveFails;
+    uint32_t SendRate;
+    uint32_t ReceiveRate;
+    UBaseType_t BlockedSenders;
+    UBaseType_t BlockedReceivers;
+    UBaseType_t PeakBlocked;
+}QueueStats_t;
+
+typedef struct
+{
+    QueueHandle_t Handle;
+    const char* Name;
+    RegistryType_t Type;
+    QueueStats_t Stats;
+    uint32_t LastSends;
+    uint32_t LastReceives;
+    TickType_t LastRateTime;
+}RegistryEntry_t;
+
+/*Define the source of the data which helps in identification*/
+typedef enum
+{
+    Source1 = 0,
+    Source2
+}DataSource;
+
+/*Structure which will be used for sending the data and sender's information along with it*/
+typedef struct
+{
+    int32_t DataVal;
+    DataSource Source;
+}QueueStruct;
+
+static const QueueStruct xSendStruct[2] = { {123 , Source1}, {456 , Source2} };
+static const char* TypeNames[] = {"queue", "sem", "set"};
+
+static RegistryEntry_t Registry[REGISTRY_MAX_ENTRIES];
+static UBaseType_t Registry_Count = 0;
+static portMUX_TYPE Registry_Lock = portMUX_INITIALIZER_UNLOCKED;
+
+QueueHandle_t xQueue;
+SemaphoreHandle_t xTickSemaphore;
+QueueSetHandle_t xReceiverSet;
+
+static RegistryEntry_t* Registry_Find(QueueHandle_t Handle)
+{
+    UBaseType_t Index;
+
+    for(Index = 0; Index < Registry_Count; Index++)
+    {
+        if(Registry[Index].Handle == Handle)
+        {
+            return &Registry[Index];
+        }
+    }
+
+    return NULL;
+}
+
+BaseType_t Registry_Add(QueueHandle_t Handle, const char* Name, RegistryType_t Type, UBaseType_t Length)
+{
+    RegistryEntry_t* Entry;
+    BaseType_t xStatus = pdFAIL;
+
+    if(Handle == NULL)
+    {
+        return pdFAIL;
+    }
+
+    portENTER_CRITICAL(&Registry_Lock);
+
+    if(Registry_Count < REGISTRY_MAX_ENTRIES)
+    {
+        Entry = &Registry[Registry_Count];
+        memset(Entry,0,sizeof(RegistryEntry_t));
+
+        Entry->Handle = Handle;
+        Entry->Name = Name;
+        Entry->Type = Type;
+        Entry->Stats.Length = Length;
+        Entry->LastRateTime = xTaskGetTickCount();
+
+        Registry_Count++;
+        xStatus = pdPASS;
+    }
+
+    portEXIT_CRITICAL(&Registry_Lock);
+
+#if (configQUEUE_REGISTRY_SIZE > 0)
+    //Placing the object in the kernel registry as well so that the name is visible for the kernel aware debuggers
+    if(xStatus == pdPASS)
+    {
+        vQueueAddToRegistry(Handle,Name);
+    }
+#endif
+
+    return xStatus;
+}
+
+BaseType_t Registry_GetStats(QueueHandle_t Handle, QueueStats_t* Stats)
+{
+    RegistryEntry_t* Entry;
+    BaseType_t xStatus = pdFAIL;
+
+    portENTER_CRITICAL(&Registry_Lock);
+
+    Entry = Registry_Find(Handle);
+    if(Entry != NULL)
+    {
+        *Stats = Entry->Stats;
+        xStatus = pdPASS;
+    }
+
+    portEXIT_CRITICAL(&Registry_Lock);
+
+    return xStatus;
+}
+
+/*Records the depth reached by an object after a successful send, which catches the peaks that fall in between two samples*/
+static void Registry_UpdatePeak(RegistryEntry_t* Entry, UBaseType_t Depth)
+{
+    if(Depth > Entry->Stats.PeakDepth)
+    {
+        Entry->Stats.PeakDepth = Depth;
+    }
+}
+
+static void Registry_UpdateBlocked(RegistryEntry_t* Entry)
+{
+    UBaseType_t Blocked;
+
+    Blocked = Entry->Stats.BlockedSenders + Entry->Stats.BlockedReceivers;
+
+    if(Blocked > Entry->Stats.PeakBlocked)
+    {
+        Entry->Stats.PeakBlocked = Blocked;
+    }
+}
+
+BaseType_t Registry_Send(QueueHandle_t Handle, const void* Item, TickType_t Timeout)
+{
+    RegistryEntry_t* Entry;
+    BaseType_t xStatus, WillBlock = pdFALSE;
+    UBaseType_t Depth;
+
+    portENTER_CRITICAL(&Registry_Lock);
+
+    Entry = Registry_Find(Handle);
+    //The sending task is counted as blocked only when the call is going to wait for a free space
+    if((Entry != NULL) && (Timeout != 0) && (uxQueueSpacesAvailable(Handle) == 0))
+    {
+        WillBlock = pdTRUE;
+        Entry->Stats.BlockedSenders++;
+        Registry_UpdateBlocked(Entry);
+    }
+
+    portEXIT_CRITICAL(&Registry_Lock);
+
+    xStatus = xQueueSendToBack(Handle,Item,Timeout);
+    Depth = uxQueueMessagesWaiting(Handle);
+
+    if(Entry != NULL)
+    {
+        portENTER_CRITICAL(&Registry_Lock);
+
+        if(WillBlock == pdTRUE)
+        {
+            Entry->Stats.BlockedSenders--;
+        }
+
+        if(xStatus == pdPASS)
+        {
+            Entry->Stats.Sends++;
+            Registry_UpdatePeak(Entry,Depth);
+        }
+        else
+        {
+            Entry->Stats.SendFails++;
+        }
+
+        portEXIT_CRITICAL(&Registry_Lock);
+    }
+
+    return xStatus;
+}
+
+BaseType_t Registry_Receive(QueueHandle_t Handle, void* Item, TickType_t Timeout)
+{
+    RegistryEntry_t* Entry;
+    BaseType_t xStatus, WillBlock = pdFALSE;
+
+    portENTER_CRITICAL(&Registry_Lock);
+
+    Entry = Registry_Find(Handle);
+    //The receiving task is counted as blocked only when the call is going to wait for an item
+    if((Entry != NULL) && (Timeout != 0) && (uxQueueMessagesWaiting(Handle) == 0))
+    {
+        WillBlock = pdTRUE;
+        Entry->Stats.BlockedReceivers++;
+        Registry_UpdateBlocked(Entry);
+    }
+
+    portEXIT_CRITICAL(&Registry_Lock);
+
+    xStatus = xQueueReceive(Handle,Item,Timeout);
+
+    if(Entry != NULL)
+    {
+        portENTER_CRITICAL(&Registry_Lock);
+
+        if(WillBlock == pdTRUE)
+        {
+            Entry->Stats.BlockedReceivers--;
+        }
+
+        if(xStatus == pdPASS)
+        {
+            Entry->Stats.Receives++;
+        }
+        else
+        {
+            Entry->Stats.ReceiveFails++;
+        }
+
+        portEXIT_CRITICAL(&Registry_Lock);
+    }
+
+    return xStatus;
+}
+
+/*Semaphores are queues with an item size of zero, so the give and take are counted as a send and a receive respectively*/
+BaseType_t Registry_SemaphoreGive(SemaphoreHandle_t Handle)
+{
+    return Registry_Send(Handle,NULL,0);
+}
+
+BaseType_t Registry_SemaphoreTake(SemaphoreHandle_t Handle, TickType_t Timeout)
+{
+    return Registry_Receive(Handle,NULL,Timeout);
+}
+
+static void Registry_Dump(void)
+{
+    UBaseType_t Index, Suggested;
+    RegistryEntry_t Entry;
+
+    printf("---- queue registry (%u objects) ----\r\n",Registry_Count);
+    printf("%-12s %-5s len cur peak  tx/s  rx/s   tx-fail  rx-fail blk pblk sug\r\n","name","type");
+
+    for(Index = 0; Index < Registry_Count; Index++)
+    {
+        //Taking a copy so that the printf is not done inside the critical section
+        portENTER_CRITICAL(&Registry_Lock);
+        Entry = Registry[Index];
+        portEXIT_CRITICAL(&Registry_Lock);
+
+        //Suggested length is the peak depth with 25% headroom and never less than one
+        Suggested = Entry.Stats.PeakDepth + ((Entry.Stats.PeakDepth + 3) / 4);
+        if(Suggested == 0)
+        {
+            Suggested = 1;
+        }
+
+        printf("%-12s %-5s %3u %3u %4u %5u %5u %9u %8u %3u %4u %3u\r\n",
+               Entry.Name,TypeNames[Entry.Type],Entry.Stats.Length,Entry.Stats.CurrentDepth,Entry.Stats.PeakDepth,
+               Entry.Stats.SendRate,Entry.Stats.ReceiveRate,Entry.Stats.SendFails,Entry.Stats.ReceiveFails,
+               (Entry.Stats.BlockedSenders + Entry.Stats.BlockedReceivers),Entry.Stats.PeakBlocked,Suggested);
+    }
+}
+
+static void Registry_Sampler(void* pvParameters)
+{
+    TickType_t LastExecutionTime, LastDumpTime, CurrentTime, Elapsed;
+    UBaseType_t Index, Depth;
+    RegistryEntry_t* Entry;
+
+    LastExecutionTime = xTaskGetTickCount();
+    LastDumpTime = LastExecutionTime;
+
+    for(;;)
+    {
+        vTaskDelayUntil(&LastExecutionTime,SAMPLE_PERIOD);
+
+        CurrentTime = xTaskGetTickCount();
+
+        for(Index = 0; Index < Registry_Count; Index++)
+        {
+            Entry = &Registry[Index];
+            Depth = uxQueueMessagesWaiting(Entry->Handle);
+
+            portENTER_CRITICAL(&Registry_Lock);
+
+            Entry->Stats.CurrentDepth = Depth;
+            Registry_UpdatePeak(Entry,Depth);
+
+            //Rates are recalculated once per second from the difference of the counters
+            Elapsed = CurrentTime - Entry->LastRateTime;
+            if(Elapsed >= pdMS_TO_TICKS(1000))
+            {
+                Entry->Stats.SendRate = ((Entry->Stats.Sends - Entry->LastSends) * configTICK_RATE_HZ) / Elapsed;
+                Entry->Stats.ReceiveRate = ((Entry->Stats.Receives - Entry->LastReceives) * configTICK_RATE_HZ) / Elapsed;
+                Entry->LastSends = Entry->Stats.Sends;
+                Entry->LastReceives = Entry->Stats.Receives;
+                Entry->LastRateTime = CurrentTime;
+            }
+
+            portEXIT_CRITICAL(&Registry_Lock);
+        }
+
+        if((CurrentTime - LastDumpTime) >= DUMP_PERIOD)
+        {
+            Registry_Dump();
+            LastDumpTime = CurrentTime;
+        }
+    }
+}
+
+static void Sender_Task(void* pvParameters)
+{
+    BaseType_t xStatus;
+    const TickType_t Timeout = pdMS_TO_TICKS(100);
+
+    for(;;)
+    {
+        //Sending the data to the queue through the registry so that the operation is accounted for
+        xStatus = Registry_Send(xQueue,pvParameters,Timeout);
+
+        if(xStatus != pdPASS)
+        {
+            printf("Unable to send data to queue!!\r\n");
+        }
+
+        vTaskDelay((rand() % 0x10));
+    }
+}
+
+static void Tick_Task(void* pvParameters)
+{
+    for(;;)
+    {
+        vTaskDelay(SEMAPHORE_GIVE_PERIOD);
+        Registry_SemaphoreGive(xTickSemaphore);
+    }
+}
+
+static void Receiver_Task(void* pvParameters)
+{
+    QueueStruct ReceiveData;
+    QueueSetMemberHandle_t Member;
+    QueueStats_t Stats;
+
+    for(;;)
+    {
+        //Waiting on the queue set for either the data queue or the semaphore to become available
+        Member = xQueueSelectFromSet(xReceiverSet,portMAX_DELAY);
+
+        if(Member == xQueue)
+        {
+            if(Registry_Receive(xQueue,&ReceiveData,0) == pdPASS)
+            {
+                printf("Received Data from source %d = %d\r\n",(ReceiveData.Source + 1),ReceiveData.DataVal);
+            }
+        }
+        else if(Member == xTickSemaphore)
+        {
+            Registry_SemaphoreTake(xTickSemaphore,0);
+
+            //Reading the statistics of the data queue through the API instead of checking the depth inline
+            if(Registry_GetStats(xQueue,&Stats) == pdPASS)
+            {
+                printf("Data queue peak depth %u of %u\r\n",Stats.PeakDepth,Stats.Length);
+            }
+        }
+
+        //Slow consumer so that the data queue builds up and the statistics have something to show
+        vTaskDelay(pdMS_TO_TICKS(20));
+    }
+}
+
+void app_main(void)
+{
+    xQueue = xQueueCreate(3,sizeof(QueueStruct));
+    xTickSemaphore = xSemaphoreCreateBinary();
+    xReceiverSet = xQueueCreateSet(3 + 1);
+
+    //Validate whether all the objects are created or not
+    if((xQueue != NULL) && (xTickSemaphore != NULL) && (xReceiverSet != NULL))
+    {
+        xQueueAddToSet(xQueue,xReceiverSet);
+        xQueueAddToSet(xTickSemaphore,xReceiverSet);
+
+        //Registering every object under a name
+        Registry_Add(xQueue,"DataQueue",Registry_Queue,3);
+        Registry_Add(xTickSemaphore,"TickSem",Registry_Semaphore,1);
+        Registry_Add(xReceiverSet,"ReceiverSet",Registry_QueueSet,3 + 1);
+
+        //Sender Task two independent instances
+        xTaskCreate(Sender_Task,"Sender_I1",2048,(void*)&xSendStruct[0],2,NULL);
+        xTaskCreate(Sender_Task,"Sender_I2",2048,(void*)&xSendStruct[1],2,NULL);
+
+        xTaskCreate(Tick_Task,"Tick",2048,NULL,2,NULL);
+        xTaskCreate(Receiver_Task,"Receiver",2048,NULL,1,NULL);
+
+        //Sampler runs above the application tasks so that the samples are taken at a steady interval
+        xTaskCreate(Registry_Sampler,"Registry",3072,NULL,3,NULL);
+    }
+    else
+    {
+        /*Represents that the objects were not created due to insufficient heap space*/
+        ESP_LOGE(RTOS,"Unable to create the registry example objects\r\n");
+    }
+}
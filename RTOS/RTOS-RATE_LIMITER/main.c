@@ -0,0 +1,380 @@
+/**
+ * @file main.c
+ * @author Tushar Uttekar
+ *
+ * @brief
+ *
+ * This example demonstrates a token bucket rate limiter for producer tasks. The senders of example 11 loop without any delay and
+ * keep the queue full as fast as the scheduler allows, the print tasks of example 21 use a random delay of up to 0x20 ticks as
+ * a throttle, neither of them has a defined rate which the consumer or the link behind it can be sized for.
+ *
+ * ->A limiter has a rate in tokens per second and a burst, the largest number of tokens the bucket can hold. It starts full, so
+ *   a producer which was idle may send a burst at once and is then held to the rate.
+ * ->The refill is computed from the tick count when the limiter is used, there is no timer behind it. The tokens are kept in
+ *   units of 1/configTICK_RATE_HZ of a token, so every tick adds exactly Rate units and no fraction is lost.
+ * ->RateLimiter_TryAcquire takes tokens if they are there and never blocks, it may be called from tasks and from ISRs.
+ * ->RateLimiter_Acquire waits for the tokens up to a timeout, it sleeps for the ticks the refill needs instead of polling.
+ * ->Every limiter counts the tokens granted, the requests denied, the requests which had to wait and the ticks waited.
+ *
+ * In the example the senders of example 11 are limited to 20 messages per second each with a burst of 5, and the print tasks
+ * and the tick hook of example 21 share the gatekeeper under limiters of their own, the counters are printed every 5 seconds.
+ *
+ * NOTE : The limiter is shared between both cores and ISRs by a spinlock, portENTER_CRITICAL_SAFE picks the ISR or the task
+ *        version. The tick hook is registered with esp_register_freertos_tick_hook_for_cpu instead of defining
+ *        vApplicationTickHook, as ESP32 uses its own implementation of the tick hook function.
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_freertos_hooks.h"
+#include "esp_log.h"
+#include "esp_system.h"
+
+#define RTOS                    "FREERTOS"
+
+typedef struct
+{
+    uint32_t Granted;                       //Tokens
+    uint32_t Denied;                        //Requests which got no tokens
+    uint32_t Waited;                        //Requests which had to wait for the refill
+    uint64_t WaitTicks;
+    TickType_t WaitMax;
+}RateLimiterStats_t;
+
+typedef struct
+{
+    portMUX_TYPE Lock;
+    uint32_t Rate;                          //Tokens per second
+    uint32_t Burst;                         //Tokens
+    uint32_t Tokens;                        //In 1/configTICK_RATE_HZ of a token
+    TickType_t LastTick;
+    RateLimiterStats_t Stats;
+}RateLimiter_t;
+
+/*---------------------------------------------- Rate limiter ----------------------------------------------*/
+
+static inline TickType_t RateLimiter_Now(void)
+{
+    return xPortInIsrContext() ? xTaskGetTickCountFromISR() : xTaskGetTickCount();
+}
+
+static BaseType_t RateLimiter_Init(RateLimiter_t* Limiter, uint32_t RatePerSecond, uint32_t Burst)
+{
+    //The full bucket has to fit into the 32 bit token count
+    if((RatePerSecond == 0) || (Burst == 0) || (Burst > (UINT32_MAX / configTICK_RATE_HZ)))
+    {
+        return pdFAIL;
+    }
+
+    vPortCPUInitializeMutex(&Limiter->Lock);
+    Limiter->Rate = RatePerSecond;
+    Limiter->Burst = Burst;
+    Limiter->Tokens = Burst * configTICK_RATE_HZ;
+    Limiter->LastTick = RateLimiter_Now();
+    Limiter->Stats = (RateLimiterStats_t){0};
+
+    return pdPASS;
+}
+
+/*Adds the tokens of the ticks since the last call, called with the lock held*/
+static void RateLimiter_Refill(RateLimiter_t* Limiter, TickType_t Now)
+{
+    uint64_t Tokens;
+
+    Tokens = (uint64_t)Limiter->Tokens + ((uint64_t)(TickType_t)(Now - Limiter->LastTick) * Limiter->Rate);
+    Limiter->Tokens = (Tokens > ((uint64_t)Limiter->Burst * configTICK_RATE_HZ)) ? (Limiter->Burst * configTICK_RATE_HZ)
+                                                                                   : (uint32_t)Tokens;
+    Limiter->LastTick = Now;
+}
+
+/*Takes Count tokens if the bucket holds them, never blocks and may be called from an ISR*/
+static BaseType_t RateLimiter_TryAcquire(RateLimiter_t* Limiter, uint32_t Count)
+{
+    BaseType_t xStatus = pdFAIL;
+
+    portENTER_CRITICAL_SAFE(&Limiter->Lock);
+
+    RateLimiter_Refill(Limiter,RateLimiter_Now());
+
+    if((Count <= Limiter->Burst) && (Limiter->Tokens >= (Count * configTICK_RATE_HZ)))
+    {
+        Limiter->Tokens -= Count * configTICK_RATE_HZ;
+        Limiter->Stats.Granted += Count;
+        xStatus = pdPASS;
+    }
+    else
+    {
+        Limiter->Stats.Denied++;
+    }
+
+    portEXIT_CRITICAL_SAFE(&Limiter->Lock);
+
+    return xStatus;
+}
+
+/*Takes Count tokens, waits for the refill up to Timeout ticks, must be called from a task*/
+static BaseType_t RateLimiter_Acquire(RateLimiter_t* Limiter, uint32_t Count, TickType_t Timeout)
+{
+    TimeOut_t TimeOut;
+    TickType_t Start = 0, Waited, Sleep;
+    uint32_t Missing;
+    BaseType_t Blocked = pdFALSE;
+
+    //More than the burst can never be granted, failing at once is better than waiting for the timeout
+    if(Count > Limiter->Burst)
+    {
+        portENTER_CRITICAL(&Limiter->Lock);
+        Limiter->Stats.Denied++;
+        portEXIT_CRITICAL(&Limiter->Lock);
+
+        return pdFAIL;
+    }
+
+    vTaskSetTimeOutState(&TimeOut);
+
+    for(;;)
+    {
+        portENTER_CRITICAL(&Limiter->Lock);
+
+        RateLimiter_Refill(Limiter,xTaskGetTickCount());
+
+        if(Limiter->Tokens >= (Count * configTICK_RATE_HZ))
+        {
+            Limiter->Tokens -= Count * configTICK_RATE_HZ;
+            Limiter->Stats.Granted += Count;
+
+            if(Blocked == pdTRUE)
+            {
+                Waited = Limiter->LastTick - Start;
+                Limiter->Stats.Waited++;
+                Limiter->Stats.WaitTicks += Waited;
+                Limiter->Stats.WaitMax = (Waited > Limiter->Stats.WaitMax) ? Waited : Limiter->Stats.WaitMax;
+            }
+
+            portEXIT_CRITICAL(&Limiter->Lock);
+            return pdPASS;
+        }
+
+        //Ticks until the missing units have been refilled, rounded up
+        Missing = (Count * configTICK_RATE_HZ) - Limiter->Tokens;
+        Sleep = (Missing + Limiter->Rate - 1) / Limiter->Rate;
+
+        if(Blocked == pdFALSE)
+        {
+            Start = Limiter->LastTick;
+        }
+
+        portEXIT_CRITICAL(&Limiter->Lock);
+
+        //Timeout is updated to the ticks which are left
+        if((Timeout == 0) || (xTaskCheckForTimeOut(&TimeOut,&Timeout) == pdTRUE))
+        {
+            break;
+        }
+
+        Blocked = pdTRUE;
+        vTaskDelay((Sleep < Timeout) ? Sleep : Timeout);
+    }
+
+    portENTER_CRITICAL(&Limiter->Lock);
+    Limiter->Stats.Denied++;
+    portEXIT_CRITICAL(&Limiter->Lock);
+
+    return pdFAIL;
+}
+
+static void RateLimiter_GetStats(RateLimiter_t* Limiter, RateLimiterStats_t* Stats)
+{
+    portENTER_CRITICAL_SAFE(&Limiter->Lock);
+    *Stats = Limiter->Stats;
+    portEXIT_CRITICAL_SAFE(&Limiter->Lock);
+}
+
+static void RateLimiter_PrintStats(const char* Name, RateLimiter_t* Limiter)
+{
+    RateLimiterStats_t Stats;
+
+    RateLimiter_GetStats(Limiter,&Stats);
+
+    printf("%-12s %4u/s burst %3u : granted %7u, denied %6u, waited %6u, wait avg %4u max %4u ticks\r\n",Name,Limiter->Rate,
+           Limiter->Burst,Stats.Granted,Stats.Denied,Stats.Waited,
+           (Stats.Waited != 0) ? (uint32_t)(Stats.WaitTicks / Stats.Waited) : 0,Stats.WaitMax);
+}
+
+/*---------------------------------------------- Example 11 ----------------------------------------------*/
+
+#define SENDER_RATE             20          //Messages per second and sender
+#define SENDER_BURST            5
+
+/*Define the source of the data which helps in identification*/
+typedef enum
+{
+    Source1 = 0,
+    Source2
+}DataSource;
+
+/*Structure which will be used for sending the data and sender's information along with it*/
+typedef struct
+{
+    int32_t DataVal;
+    DataSource Source;
+}QueueStruct;
+
+/*Data which will be passed to the queue*/
+static const QueueStruct xSendStruct[2] = { {123 , Source1}, {456 , Source2} };
+
+static RateLimiter_t Sender_Limiter[2];
+xQueueHandle xQueue;
+
+static void Sender_Task(void* pvParameters)
+{
+    BaseType_t xStatus;
+    const QueueStruct* SendStruct = (const QueueStruct*) pvParameters;
+    const TickType_t Timeout = pdMS_TO_TICKS(100);
+
+    for(;;)
+    {
+        //Every message costs one token of the sender's own limiter
+        RateLimiter_Acquire(&Sender_Limiter[SendStruct->Source],1,portMAX_DELAY);
+
+        xStatus = xQueueSendToBack(xQueue,SendStruct,Timeout);
+
+        if(xStatus != pdPASS)
+        {
+            printf("Unable to send data to queue!!\r\n");
+        }
+    }
+}
+
+static void Receiver_Task(void* pvParameters)
+{
+    QueueStruct ReceiveData;
+    BaseType_t xStatus;
+
+    for(;;)
+    {
+        //The senders are limited now, so the receiver waits for the data instead of polling
+        xStatus = xQueueReceive(xQueue,&ReceiveData,portMAX_DELAY);
+
+        if(xStatus == pdPASS)
+        {
+            if(ReceiveData.Source == Source1)
+            {
+                printf("Received Data from source 1 = %d\r\n",ReceiveData.DataVal);
+            }
+            else
+            {
+                printf("Received Data from source 2 = %d\r\n",ReceiveData.DataVal);
+            }
+        }
+    }
+}
+
+/*---------------------------------------------- Example 21 ----------------------------------------------*/
+
+#define PRINT_RATE              10          //Strings per second shared by both print tasks
+#define PRINT_BURST             3
+#define TICK_HOOK_RATE          2           //Strings per second from the tick hook
+#define TICK_HOOK_BURST         1
+
+const char* strings[] = {"Task 1 printing the string message through the gatekeeper task\r\n",
+                         "Task 2 printing the string message through the gatekeeper task\r\n",
+                         "Tick Hook function printing the string message through the gatekeeper task\r\n"
+                         };
+QueueHandle_t GateKeeper_Queue;
+
+static RateLimiter_t Print_Limiter, TickHook_Limiter;
+
+static void GateKeeper_Task(void* pvParameters)
+{
+    char* print_string;
+
+    for(;;)
+    {
+        //The received data over the queue will be printed on the terminal output
+        xQueueReceive(GateKeeper_Queue,&print_string,portMAX_DELAY);
+
+        printf("%s",print_string);
+    }
+}
+
+static void Print_Task(void* pvParameters)
+{
+    char *string;
+
+    string = (char*) pvParameters;
+
+    for(;;)
+    {
+        //The limiter replaces the random delay, both instances share the rate of the gatekeeper
+        RateLimiter_Acquire(&Print_Limiter,1,portMAX_DELAY);
+        xQueueSendToBack(GateKeeper_Queue,&string,0);
+    }
+}
+
+static void GateKeeper_TickHook(void)
+{
+    //Tried on every tick, the limiter lets TICK_HOOK_RATE of them through every second
+    if(RateLimiter_TryAcquire(&TickHook_Limiter,1) == pdPASS)
+    {
+        xQueueSendToFrontFromISR(GateKeeper_Queue,&strings[2],NULL);
+    }
+}
+
+/*---------------------------------------------- Statistics ----------------------------------------------*/
+
+static void Stats_Task(void* pvParameters)
+{
+    for(;;)
+    {
+        vTaskDelay(pdMS_TO_TICKS(5000));
+
+        RateLimiter_PrintStats("Sender_I1",&Sender_Limiter[Source1]);
+        RateLimiter_PrintStats("Sender_I2",&Sender_Limiter[Source2]);
+        RateLimiter_PrintStats("Print",&Print_Limiter);
+        RateLimiter_PrintStats("TickHook",&TickHook_Limiter);
+    }
+}
+
+void app_main(void)
+{
+    if((RateLimiter_Init(&Sender_Limiter[Source1],SENDER_RATE,SENDER_BURST) == pdFAIL) ||
+       (RateLimiter_Init(&Sender_Limiter[Source2],SENDER_RATE,SENDER_BURST) == pdFAIL) ||
+       (RateLimiter_Init(&Print_Limiter,PRINT_RATE,PRINT_BURST) == pdFAIL) ||
+       (RateLimiter_Init(&TickHook_Limiter,TICK_HOOK_RATE,TICK_HOOK_BURST) == pdFAIL))
+    {
+        ESP_LOGE(RTOS,"Rate limiters could not be initialized.\r\n");
+        return;
+    }
+
+    xQueue = xQueueCreate(3,sizeof(QueueStruct));
+    GateKeeper_Queue = xQueueCreate(5,sizeof(char*));
+
+    if((xQueue == NULL) || (GateKeeper_Queue == NULL))
+    {
+        ESP_LOGE(RTOS,"Queues could not be created.\r\n");
+        return;
+    }
+
+    //Example 11, the sender task two independent instances and the receiver task
+    xTaskCreate(Sender_Task,"Sender_I1",2048,(void*)&xSendStruct[0],2,NULL);
+    xTaskCreate(Sender_Task,"Sender_I2",2048,(void*)&xSendStruct[1],2,NULL);
+    xTaskCreate(Receiver_Task,"Receiver",2048,NULL,1,NULL);
+
+    //Example 21, two instances of the print task and the gatekeeper task
+    xTaskCreate(Print_Task,"Print from 1st instance",2048,(void*)strings[0],1,NULL);
+    xTaskCreate(Print_Task,"Print from 2nd instance",2048,(void*)strings[1],2,NULL);
+    xTaskCreate(GateKeeper_Task,"GateKeeper",2048,NULL,0,NULL);
+
+    xTaskCreate(Stats_Task,"Stats",2048,NULL,3,NULL);
+
+    esp_register_freertos_tick_hook_for_cpu(GateKeeper_TickHook,0);
+}
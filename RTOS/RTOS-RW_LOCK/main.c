@@ -0,0 +1,563 @@
+/**
+ * @file main.c
+ * @author Tushar Uttekar
+ *
+ * @brief
+ *
+ * This example demonstrates a reader-writer lock for read-mostly shared data such as calibration or routing tables, which many
+ * tasks read all the time and which change rarely. With the mutex of example 20 every reader waits for every other reader, with
+ * the reader-writer lock any number of readers share the data and only a writer is exclusive.
+ *
+ * ->The state of the lock is one word, the number of readers inside in the low half and the number of writers which have asked
+ *   for the lock in the high half, a reader enters with a compare and swap when there is no writer.
+ * ->Writer preference, a reader is refused as soon as a writer has asked for the lock, so a steady stream of readers can not
+ *   starve a writer. The writer waits for the readers which are still inside, the last one to leave notifies it.
+ * ->Writers are serialised by a mutex, with RW_WRITER_INHERITANCE set a waiting writer raises the priority of the writer inside.
+ * ->Readers in an interrupt use RwLock_ReadTryFromISR, which never blocks and fails while a writer is around. Readers in a task
+ *   register as waiting and block on a counting semaphore, the last writer to leave gives it once for every waiting reader.
+ *
+ * The benchmark runs eight tasks on both cores which read or write a shared table in a 90/10 and a 99/1 mix, once with a mutex
+ * and once with the reader-writer lock, and prints the operations per second. After that a calibration table is read by tasks
+ * and by an interrupt while a task updates it every second, the readers check that they never see a half written table.
+ *
+ * NOTE : Readers are not known by name, so a writer can not raise the priority of the readers it waits for. The writer is
+ *        notified through its task notification, a task which uses the lock as a writer should not use the notification for
+ *        anything else.
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/portmacro.h"
+#include "freertos/xtensa_api.h"
+#include "xtensa/core-macros.h"
+#include "esp_intr_alloc.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "esp_system.h"
+
+#define RTOS                    "FREERTOS"
+#define SW_ISR_LEVEL_3          29
+
+#define RW_WRITER_INHERITANCE   1
+#define RW_READERS_MASK         0x0000FFFFUL
+#define RW_WRITER_ONE           0x00010000UL
+
+typedef struct
+{
+    volatile uint32_t State;
+    volatile TaskHandle_t Writer;           //Writer inside or waiting for the readers to leave
+    SemaphoreHandle_t WriterLock;
+    SemaphoreHandle_t ReadGate;             //Given once for every waiting reader by the last writer to leave
+    uint32_t Waiting;                       //Readers registered for the next ReadGate, protected by WaitLock
+    portMUX_TYPE WaitLock;
+}RwLock_t;
+
+/*---------------------------------------------- Reader-writer lock ----------------------------------------------*/
+
+static BaseType_t RwLock_Create(RwLock_t* Lock)
+{
+    Lock->State = 0;
+    Lock->Writer = NULL;
+    Lock->Waiting = 0;
+    vPortCPUInitializeMutex(&Lock->WaitLock);
+    Lock->ReadGate = xSemaphoreCreateCounting(RW_READERS_MASK,0);
+
+#if RW_WRITER_INHERITANCE
+    Lock->WriterLock = xSemaphoreCreateMutex();
+#else
+    Lock->WriterLock = xSemaphoreCreateBinary();
+
+    if(Lock->WriterLock != NULL)
+    {
+        xSemaphoreGive(Lock->WriterLock);
+    }
+#endif
+
+    return ((Lock->ReadGate != NULL) && (Lock->WriterLock != NULL)) ? pdPASS : pdFAIL;
+}
+
+/*Enters as a reader when no writer has asked for the lock, never blocks*/
+static inline BaseType_t RwLock_ReadTry(RwLock_t* Lock)
+{
+    uint32_t State = __atomic_load_n(&Lock->State,__ATOMIC_RELAXED);
+
+    do
+    {
+        if(((State & ~RW_READERS_MASK) != 0) || ((State & RW_READERS_MASK) == RW_READERS_MASK))
+        {
+            return pdFAIL;
+        }
+    }while(!__atomic_compare_exchange_n(&Lock->State,&State,State + 1,pdTRUE,__ATOMIC_ACQUIRE,__ATOMIC_RELAXED));
+
+    return pdPASS;
+}
+
+/*Leaves as a reader, pdTRUE when the writer which waits for the readers has to be notified*/
+static inline BaseType_t RwLock_ReadLeave(RwLock_t* Lock)
+{
+    uint32_t State = __atomic_sub_fetch(&Lock->State,1,__ATOMIC_SEQ_CST);
+
+    return (((State & RW_READERS_MASK) == 0) && ((State & ~RW_READERS_MASK) != 0) &&
+            (__atomic_load_n(&Lock->Writer,__ATOMIC_SEQ_CST) != NULL)) ? pdTRUE : pdFALSE;
+}
+
+static BaseType_t RwLock_ReadTryFromISR(RwLock_t* Lock)
+{
+    return RwLock_ReadTry(Lock);
+}
+
+static void RwLock_ReadUnlockFromISR(RwLock_t* Lock, BaseType_t* pxHigherPriorityTaskWoken)
+{
+    TaskHandle_t Writer;
+
+    if(RwLock_ReadLeave(Lock) == pdTRUE)
+    {
+        Writer = __atomic_load_n(&Lock->Writer,__ATOMIC_SEQ_CST);
+
+        if(Writer != NULL)
+        {
+            vTaskNotifyGiveFromISR(Writer,pxHigherPriorityTaskWoken);
+        }
+    }
+}
+
+static BaseType_t RwLock_ReadLock(RwLock_t* Lock, TickType_t Timeout)
+{
+    TimeOut_t TimeOut;
+    BaseType_t Wait;
+
+    vTaskSetTimeOutState(&TimeOut);
+
+    for(;;)
+    {
+        if(RwLock_ReadTry(Lock) == pdPASS)
+        {
+            return pdPASS;
+        }
+
+        if(xTaskCheckForTimeOut(&TimeOut,&Timeout) == pdTRUE)
+        {
+            return pdFAIL;
+        }
+
+        //The writers are checked and the reader registered in one step, the last writer to leave takes the count under the
+        //same lock after its writer count has dropped, so it either sees this reader or this reader sees no writer
+        portENTER_CRITICAL(&Lock->WaitLock);
+
+        Wait = ((__atomic_load_n(&Lock->State,__ATOMIC_SEQ_CST) & ~RW_READERS_MASK) != 0) ? pdTRUE : pdFALSE;
+        if(Wait == pdTRUE)
+        {
+            Lock->Waiting++;
+        }
+
+        portEXIT_CRITICAL(&Lock->WaitLock);
+
+        if((Wait == pdTRUE) && (xSemaphoreTake(Lock->ReadGate,Timeout) != pdTRUE))
+        {
+            portENTER_CRITICAL(&Lock->WaitLock);
+
+            //Still registered, the registration is taken back, otherwise the gate has been or is about to be given for it
+            Wait = (Lock->Waiting != 0) ? pdFALSE : pdTRUE;
+            if(Wait == pdFALSE)
+            {
+                Lock->Waiting--;
+            }
+
+            portEXIT_CRITICAL(&Lock->WaitLock);
+
+            if(Wait == pdTRUE)
+            {
+                xSemaphoreTake(Lock->ReadGate,portMAX_DELAY);
+            }
+
+            return pdFAIL;
+        }
+    }
+}
+
+static void RwLock_ReadUnlock(RwLock_t* Lock)
+{
+    TaskHandle_t Writer;
+
+    if(RwLock_ReadLeave(Lock) == pdTRUE)
+    {
+        Writer = __atomic_load_n(&Lock->Writer,__ATOMIC_SEQ_CST);
+
+        if(Writer != NULL)
+        {
+            xTaskNotifyGive(Writer);
+        }
+    }
+}
+
+/*Called after the writer count has dropped to zero, gives the gate once for every reader which has registered until now*/
+static void RwLock_ReleaseReaders(RwLock_t* Lock)
+{
+    uint32_t Waiting;
+
+    portENTER_CRITICAL(&Lock->WaitLock);
+    Waiting = Lock->Waiting;
+    Lock->Waiting = 0;
+    portEXIT_CRITICAL(&Lock->WaitLock);
+
+    while(Waiting-- != 0)
+    {
+        xSemaphoreGive(Lock->ReadGate);
+    }
+}
+
+/*The writer count drops, the last writer lets the blocked readers in*/
+static void RwLock_WriterLeave(RwLock_t* Lock)
+{
+    __atomic_store_n(&Lock->Writer,NULL,__ATOMIC_SEQ_CST);
+
+    if((__atomic_sub_fetch(&Lock->State,RW_WRITER_ONE,__ATOMIC_SEQ_CST) & ~RW_READERS_MASK) == 0)
+    {
+        RwLock_ReleaseReaders(Lock);
+    }
+
+    xSemaphoreGive(Lock->WriterLock);
+}
+
+static BaseType_t RwLock_WriteLock(RwLock_t* Lock, TickType_t Timeout)
+{
+    TimeOut_t TimeOut;
+
+    vTaskSetTimeOutState(&TimeOut);
+
+    //Counted before the mutex is taken, so the readers are held off while the writer waits for an earlier writer
+    __atomic_add_fetch(&Lock->State,RW_WRITER_ONE,__ATOMIC_SEQ_CST);
+
+    if(xSemaphoreTake(Lock->WriterLock,Timeout) != pdTRUE)
+    {
+        if((__atomic_sub_fetch(&Lock->State,RW_WRITER_ONE,__ATOMIC_SEQ_CST) & ~RW_READERS_MASK) == 0)
+        {
+            RwLock_ReleaseReaders(Lock);
+        }
+
+        return pdFAIL;
+    }
+
+    //Stored before the readers are counted, a reader which leaves after the count sees it and notifies
+    __atomic_store_n(&Lock->Writer,xTaskGetCurrentTaskHandle(),__ATOMIC_SEQ_CST);
+
+    while((__atomic_load_n(&Lock->State,__ATOMIC_SEQ_CST) & RW_READERS_MASK) != 0)
+    {
+        if(xTaskCheckForTimeOut(&TimeOut,&Timeout) == pdTRUE)
+        {
+            RwLock_WriterLeave(Lock);
+            return pdFAIL;
+        }
+
+        //A notification left over from an earlier write only causes one more pass
+        ulTaskNotifyTake(pdTRUE,Timeout);
+    }
+
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+    return pdPASS;
+}
+
+static void RwLock_WriteUnlock(RwLock_t* Lock)
+{
+    RwLock_WriterLeave(Lock);
+}
+
+/*---------------------------------------------- Benchmark ----------------------------------------------*/
+
+#define BENCH_WORKERS           8
+#define BENCH_RUN_MS            2000
+#define BENCH_TABLE_WORDS       64
+
+typedef enum
+{
+    BENCH_MUTEX = 0,
+    BENCH_RWLOCK
+}BenchMode_t;
+
+static const uint32_t Bench_ReadPercent[] = {90,99};
+
+static SemaphoreHandle_t Bench_Mutex, Bench_Start, Bench_Done;
+static RwLock_t Bench_Lock;
+static volatile BenchMode_t Bench_Mode;
+static volatile uint32_t Bench_Percent;
+static volatile BaseType_t Bench_Running;
+static volatile uint32_t Bench_Table[BENCH_TABLE_WORDS];
+static uint32_t Bench_Reads, Bench_Writes;
+static portMUX_TYPE Bench_Mux = portMUX_INITIALIZER_UNLOCKED;
+
+static uint32_t Bench_ReadTable(void)
+{
+    uint32_t Sum = 0, Loop;
+
+    for(Loop = 0; Loop < BENCH_TABLE_WORDS; Loop++)
+    {
+        Sum += Bench_Table[Loop];
+    }
+
+    return Sum;
+}
+
+static void Bench_WriteTable(uint32_t Value)
+{
+    uint32_t Loop;
+
+    for(Loop = 0; Loop < BENCH_TABLE_WORDS; Loop++)
+    {
+        Bench_Table[Loop] = Value;
+    }
+}
+
+static void BenchWorker_Task(void* pvParameters)
+{
+    uint32_t Random = (uint32_t)pvParameters * 2654435761UL + 1, Reads, Writes;
+    BaseType_t Read;
+
+    for(;;)
+    {
+        xSemaphoreTake(Bench_Start,portMAX_DELAY);
+        Reads = 0;
+        Writes = 0;
+
+        while(Bench_Running == pdTRUE)
+        {
+            //Xorshift, cheaper than rand and without the shared state
+            Random ^= Random << 13;
+            Random ^= Random >> 17;
+            Random ^= Random << 5;
+            Read = ((Random % 100) < Bench_Percent) ? pdTRUE : pdFALSE;
+
+            if(Bench_Mode == BENCH_MUTEX)
+            {
+                xSemaphoreTake(Bench_Mutex,portMAX_DELAY);
+
+                if(Read == pdTRUE)
+                {
+                    Bench_ReadTable();
+                }
+                else
+                {
+                    Bench_WriteTable(Random);
+                }
+
+                xSemaphoreGive(Bench_Mutex);
+            }
+            else if(Read == pdTRUE)
+            {
+                RwLock_ReadLock(&Bench_Lock,portMAX_DELAY);
+                Bench_ReadTable();
+                RwLock_ReadUnlock(&Bench_Lock);
+            }
+            else
+            {
+                RwLock_WriteLock(&Bench_Lock,portMAX_DELAY);
+                Bench_WriteTable(Random);
+                RwLock_WriteUnlock(&Bench_Lock);
+            }
+
+            if(Read == pdTRUE)
+            {
+                Reads++;
+            }
+            else
+            {
+                Writes++;
+            }
+        }
+
+        portENTER_CRITICAL(&Bench_Mux);
+        Bench_Reads += Reads;
+        Bench_Writes += Writes;
+        portEXIT_CRITICAL(&Bench_Mux);
+
+        xSemaphoreGive(Bench_Done);
+    }
+}
+
+static void Benchmark_Run(void)
+{
+    static const char* const Modes[] = {"Mutex","RwLock"};
+    uint32_t Mix, Mode, Loop;
+
+    printf("%-8s %6s %12s %12s %12s\r\n","Lock","Reads","Reads/s","Writes/s","Ops/s");
+
+    for(Mix = 0; Mix < (sizeof(Bench_ReadPercent) / sizeof(Bench_ReadPercent[0])); Mix++)
+    {
+        for(Mode = BENCH_MUTEX; Mode <= BENCH_RWLOCK; Mode++)
+        {
+            Bench_Mode = (BenchMode_t)Mode;
+            Bench_Percent = Bench_ReadPercent[Mix];
+            Bench_Reads = 0;
+            Bench_Writes = 0;
+            Bench_Running = pdTRUE;
+
+            for(Loop = 0; Loop < BENCH_WORKERS; Loop++)
+            {
+                xSemaphoreGive(Bench_Start);
+            }
+
+            vTaskDelay(pdMS_TO_TICKS(BENCH_RUN_MS));
+            Bench_Running = pdFALSE;
+
+            for(Loop = 0; Loop < BENCH_WORKERS; Loop++)
+            {
+                xSemaphoreTake(Bench_Done,portMAX_DELAY);
+            }
+
+            printf("%-8s %5u%% %12u %12u %12u\r\n",Modes[Mode],Bench_ReadPercent[Mix],
+                   Bench_Reads * 1000 / BENCH_RUN_MS,Bench_Writes * 1000 / BENCH_RUN_MS,
+                   (Bench_Reads + Bench_Writes) * 1000 / BENCH_RUN_MS);
+        }
+    }
+
+    printf("\r\n");
+}
+
+/*---------------------------------------------- Calibration table ----------------------------------------------*/
+
+#define CAL_CHANNELS            8
+
+typedef struct
+{
+    uint32_t Version;
+    float Gain[CAL_CHANNELS];
+    float Offset[CAL_CHANNELS];
+    uint32_t Check;                         //Version of the last member written, differs from Version while half written
+}Calibration_t;
+
+static RwLock_t Cal_Lock;
+static Calibration_t Cal_Table;
+static volatile uint32_t Cal_IsrReads, Cal_IsrMisses, Cal_Torn;
+static volatile float Cal_IsrGain;
+
+static void Interrupt_Handler(void* arg)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    xt_set_intclear(1 << SW_ISR_LEVEL_3);
+
+    //An interrupt can not wait for the writer, the value of the last read is used instead
+    if(RwLock_ReadTryFromISR(&Cal_Lock) == pdPASS)
+    {
+        Cal_IsrGain = Cal_Table.Gain[0];
+        Cal_Torn += (Cal_Table.Check != Cal_Table.Version) ? 1 : 0;
+        RwLock_ReadUnlockFromISR(&Cal_Lock,&xHigherPriorityTaskWoken);
+        Cal_IsrReads++;
+    }
+    else
+    {
+        Cal_IsrMisses++;
+    }
+
+    portYIELD_FROM_ISR();
+}
+
+static void CalReader_Task(void* pvParameters)
+{
+    uint32_t Reads = 0, Channel;
+    float Sum;
+
+    for(;;)
+    {
+        RwLock_ReadLock(&Cal_Lock,portMAX_DELAY);
+
+        for(Sum = 0, Channel = 0; Channel < CAL_CHANNELS; Channel++)
+        {
+            Sum += Cal_Table.Gain[Channel] + Cal_Table.Offset[Channel];
+        }
+
+        if(Cal_Table.Check != Cal_Table.Version)
+        {
+            Cal_Torn++;
+        }
+
+        RwLock_ReadUnlock(&Cal_Lock);
+
+        if((++Reads % 1000) == 0)
+        {
+            ESP_LOGI(RTOS,"%s, %u reads, sum %.2f.\r\n",pcTaskGetTaskName(NULL),Reads,Sum);
+        }
+
+        vTaskDelay(1);
+    }
+}
+
+static void CalWriter_Task(void* pvParameters)
+{
+    uint32_t Channel;
+
+    for(;;)
+    {
+        vTaskDelay(pdMS_TO_TICKS(1000));
+
+        RwLock_WriteLock(&Cal_Lock,portMAX_DELAY);
+
+        Cal_Table.Version++;
+
+        for(Channel = 0; Channel < CAL_CHANNELS; Channel++)
+        {
+            Cal_Table.Gain[Channel] = 1.0f + (Cal_Table.Version % 10) * 0.01f;
+            Cal_Table.Offset[Channel] = (float)Channel * 0.5f;
+        }
+
+        Cal_Table.Check = Cal_Table.Version;
+
+        RwLock_WriteUnlock(&Cal_Lock);
+
+        ESP_LOGI(RTOS,"Calibration version %u, ISR reads %u, ISR misses %u, torn reads %u.\r\n",Cal_Table.Version,
+                 Cal_IsrReads,Cal_IsrMisses,Cal_Torn);
+    }
+}
+
+static void Interrupt_Generator(void* pvParameters)
+{
+    for(;;)
+    {
+        xt_set_intset(1 << SW_ISR_LEVEL_3);
+        vTaskDelay(1);
+    }
+}
+
+void app_main(void)
+{
+    uint32_t Loop;
+
+    Bench_Mutex = xSemaphoreCreateMutex();
+    Bench_Start = xSemaphoreCreateCounting(BENCH_WORKERS,0);
+    Bench_Done = xSemaphoreCreateCounting(BENCH_WORKERS,0);
+
+    if((Bench_Mutex == NULL) || (Bench_Start == NULL) || (Bench_Done == NULL) || (RwLock_Create(&Bench_Lock) == pdFAIL) ||
+       (RwLock_Create(&Cal_Lock) == pdFAIL))
+    {
+        ESP_LOGE(RTOS,"Locks could not be created.\r\n");
+        return;
+    }
+
+    //Workers at the same priority on both cores, below app_main which stops them
+    vTaskPrioritySet(NULL,6);
+
+    for(Loop = 0; Loop < BENCH_WORKERS; Loop++)
+    {
+        xTaskCreatePinnedToCore(BenchWorker_Task,"Worker",2048,(void*)Loop,5,NULL,Loop & 1);
+    }
+
+    Benchmark_Run();
+
+    vTaskPrioritySet(NULL,1);
+
+    esp_intr_alloc(ETS_INTERNAL_SW1_INTR_SOURCE,0,Interrupt_Handler,NULL,NULL);
+
+    xTaskCreatePinnedToCore(CalReader_Task,"Reader-1",3072,NULL,3,NULL,0);
+    xTaskCreatePinnedToCore(CalReader_Task,"Reader-2",3072,NULL,3,NULL,1);
+    xTaskCreatePinnedToCore(CalReader_Task,"Reader-3",3072,NULL,2,NULL,1);
+    xTaskCreatePinnedToCore(CalWriter_Task,"Writer",3072,NULL,4,NULL,0);
+    xTaskCreatePinnedToCore(Interrupt_Generator,"Interrupt",2048,NULL,1,NULL,0);
+}
@@ -0,0 +1,254 @@
+/**
+ * @file main.c
+ * @author Tushar Uttekar
+ *
+ * @brief
+ *
+ * This example demonstrates how the complete topology of an application (its tasks, queues and queue sets along with the
+ * connections between them) can be declared once in tables at compile time, from which the storage, the checks and the startup
+ * code are generated, instead of creating everything one by one in app_main and checking every returned handle by hand.
+ *
+ * The topology of example 12 (two sending tasks, two queues, one queue set and the receiving task) is declared in the
+ * SYSTEM_QUEUES, SYSTEM_QUEUE_SETS, SYSTEM_SET_MEMBERS and SYSTEM_TASKS tables. Each table is expanded several times (X macros):
+ * ->Once for the enums which are used for referring to the objects, e.g. System_Queue(Queue1).
+ * ->Once for the static storage of every object, so all the RAM is reserved by the linker and the startup does not depend on the
+ *   state of the heap.
+ * ->Once for the compile time checks, the priorities have to be below configMAX_PRIORITIES, the stacks above the minimal stack
+ *   size, the queue set long enough for all its members and the total RAM within SYSTEM_RAM_BUDGET.
+ * ->Once for the startup, System_Start creates all the objects in one pass from the static storage.
+ *
+ * The total RAM taken by the topology is a compile time constant which is printed at the boot, along with the time from the
+ * reset to the start of the topology and the time until all the tasks have reported that they are ready.
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "esp_system.h"
+
+#define RTOS                    "freertos"
+#define SYSTEM_RAM_BUDGET       (16 * 1024)
+
+/*---------------------------------------------- Topology declaration ----------------------------------------------*/
+
+/*X(Name, Length, ItemSize)*/
+#define SYSTEM_QUEUES(X)                                    \
+    X(Queue1,       1,      sizeof(char*))                  \
+    X(Queue2,       1,      sizeof(char*))
+
+/*X(Name, Length), the length must hold the items of all its members*/
+#define SYSTEM_QUEUE_SETS(X)                                \
+    X(ReceiveSet,   2)
+
+/*X(Arg, Set, Queue), Arg is passed through for the expansions which need it*/
+#define SYSTEM_SET_MEMBERS(X,Arg)                           \
+    X(Arg,  ReceiveSet,     Queue1)                         \
+    X(Arg,  ReceiveSet,     Queue2)
+
+/*X(Name, Function, StackBytes, Priority, Core)*/
+#define SYSTEM_TASKS(X)                                     \
+    X(Sending1,     Sending_Task1,  2048,   0,  0)          \
+    X(Sending2,     Sending_Task2,  2048,   0,  0)          \
+    X(Receiving,    Receiving_Task, 2048,   1,  1)
+
+/*---------------------------------------------- Generated identifiers ----------------------------------------------*/
+
+#define QUEUE_ENUM(Name,Length,ItemSize)                    Queue_##Name,
+#define SET_ENUM(Name,Length)                               Set_##Name,
+#define TASK_ENUM(Name,Function,Stack,Priority,Core)        Task_##Name,
+
+typedef enum { SYSTEM_QUEUES(QUEUE_ENUM) System_QueueCount } SystemQueue_t;
+typedef enum { SYSTEM_QUEUE_SETS(SET_ENUM) System_SetCount } SystemSet_t;
+typedef enum { SYSTEM_TASKS(TASK_ENUM) System_TaskCount } SystemTask_t;
+
+#define System_Queue(Name)      (System_Queues[Queue_##Name])
+#define System_Set(Name)        (System_Sets[Set_##Name])
+#define System_Task(Name)       (System_Tasks[Task_##Name])
+
+static QueueHandle_t System_Queues[System_QueueCount];
+static QueueSetHandle_t System_Sets[System_SetCount];
+static TaskHandle_t System_Tasks[System_TaskCount];
+
+/*---------------------------------------------- Generated storage ----------------------------------------------*/
+
+#define QUEUE_STORAGE(Name,Length,ItemSize)                                                     \
+    static StaticQueue_t Queue_##Name##_Control;                                                \
+    static uint8_t Queue_##Name##_Storage[(Length) * (ItemSize)];
+
+/*The kernel keeps a handle of the member queue in the set for every item*/
+#define SET_STORAGE(Name,Length)                                                                \
+    static StaticQueue_t Set_##Name##_Control;                                                  \
+    static uint8_t Set_##Name##_Storage[(Length) * sizeof(QueueSetMemberHandle_t)];
+
+#define TASK_STORAGE(Name,Function,Stack,Priority,Core)                                         \
+    static void Function(void* pvParameters);                                                   \
+    static StaticTask_t Task_##Name##_Control;                                                  \
+    static StackType_t Task_##Name##_Stack[(Stack) / sizeof(StackType_t)];
+
+SYSTEM_QUEUES(QUEUE_STORAGE)
+SYSTEM_QUEUE_SETS(SET_STORAGE)
+SYSTEM_TASKS(TASK_STORAGE)
+
+/*---------------------------------------------- Compile time checks ----------------------------------------------*/
+
+#define TASK_CHECK(Name,Function,Stack,Priority,Core)                                                           \
+    _Static_assert((Priority) < configMAX_PRIORITIES, "Priority of task " #Name " is too high");                \
+    _Static_assert((Stack) >= configMINIMAL_STACK_SIZE, "Stack of task " #Name " is below the minimum");        \
+    _Static_assert(((Core) >= 0) && ((Core) < portNUM_PROCESSORS), "Core of task " #Name " does not exist");
+
+#define QUEUE_CHECK(Name,Length,ItemSize)                                                                       \
+    _Static_assert((Length) > 0, "Queue " #Name " has no length");
+
+SYSTEM_TASKS(TASK_CHECK)
+SYSTEM_QUEUES(QUEUE_CHECK)
+
+/*Length of every queue as a constant, used for checking that a queue set can hold the items of all its members*/
+#define QUEUE_LENGTH_ENUM(Name,Length,ItemSize)             Queue_##Name##_Length = (Length),
+enum { SYSTEM_QUEUES(QUEUE_LENGTH_ENUM) };
+
+#define SET_LENGTH_ENUM(Name,Length)                        Set_##Name##_Length = (Length),
+enum { SYSTEM_QUEUE_SETS(SET_LENGTH_ENUM) };
+
+/*Sum of the member lengths of every set, the set has to be at least as long as all its members together*/
+#define SET_MEMBER_SUM(SetID,Set,Queue)                     + ((Set_##Set == (SetID)) ? Queue_##Queue##_Length : 0)
+#define SET_TOTAL_ENUM(Name,Length)                         Set_##Name##_Members = 0 SYSTEM_SET_MEMBERS(SET_MEMBER_SUM,Set_##Name),
+enum { SYSTEM_QUEUE_SETS(SET_TOTAL_ENUM) };
+
+#define SET_TOTAL_CHECK(Name,Length)                                                                            \
+    _Static_assert((int)Set_##Name##_Length >= (int)Set_##Name##_Members, "Queue set " #Name " can not hold its members");
+
+SYSTEM_QUEUE_SETS(SET_TOTAL_CHECK)
+
+/*Total RAM of the topology, the same sizes as the generated storage*/
+#define QUEUE_RAM(Name,Length,ItemSize)                     + sizeof(StaticQueue_t) + ((Length) * (ItemSize))
+#define SET_RAM(Name,Length)                                + sizeof(StaticQueue_t) + ((Length) * sizeof(QueueSetMemberHandle_t))
+#define TASK_RAM(Name,Function,Stack,Priority,Core)         + sizeof(StaticTask_t) + (Stack)
+
+#define SYSTEM_RAM_BYTES        (0 SYSTEM_QUEUES(QUEUE_RAM) SYSTEM_QUEUE_SETS(SET_RAM) SYSTEM_TASKS(TASK_RAM))
+
+_Static_assert(SYSTEM_RAM_BYTES <= SYSTEM_RAM_BUDGET, "Topology does not fit in the RAM budget");
+
+/*---------------------------------------------- Generated startup ----------------------------------------------*/
+
+static volatile UBaseType_t System_Pending = System_TaskCount;
+static portMUX_TYPE System_Lock = portMUX_INITIALIZER_UNLOCKED;
+static int64_t System_StartTime;
+
+/*Every task calls this once before its loop, the last one reports the boot time*/
+static void System_TaskReady(void)
+{
+    UBaseType_t Pending;
+
+    portENTER_CRITICAL(&System_Lock);
+    System_Pending--;
+    Pending = System_Pending;
+    portEXIT_CRITICAL(&System_Lock);
+
+    if(Pending == 0)
+    {
+        ESP_LOGI(RTOS,"Topology started at %lld us after reset, all %d tasks ready at %lld us\r\n",
+                 System_StartTime,System_TaskCount,esp_timer_get_time());
+    }
+}
+
+#define QUEUE_CREATE(Name,Length,ItemSize)                                                                      \
+    System_Queue(Name) = xQueueCreateStatic((Length),(ItemSize),Queue_##Name##_Storage,&Queue_##Name##_Control); \
+    if(System_Queue(Name) == NULL) { return #Name; }
+
+/*Same as xQueueCreateSet without the heap, a queue set is a queue of member handles of the set type*/
+#define SET_CREATE(Name,Length)                                                                                 \
+    System_Set(Name) = xQueueGenericCreateStatic((Length),sizeof(QueueSetMemberHandle_t),Set_##Name##_Storage,   \
+                                                 &Set_##Name##_Control,queueQUEUE_TYPE_SET);                    \
+    if(System_Set(Name) == NULL) { return #Name; }
+
+#define SET_MEMBER_ADD(Unused,Set,Queue)                                                                               \
+    if(xQueueAddToSet(System_Queue(Queue),System_Set(Set)) != pdPASS) { return #Queue; }
+
+#define TASK_CREATE(Name,Function,Stack,Priority,Core)                                                          \
+    System_Task(Name) = xTaskCreateStaticPinnedToCore(Function,#Name,(Stack),NULL,(Priority),                   \
+                                                      Task_##Name##_Stack,&Task_##Name##_Control,(Core));        \
+    if(System_Task(Name) == NULL) { return #Name; }
+
+/*Creates the whole topology in one pass, returns NULL on success or the name of the object which could not be created*/
+static const char* System_Start(void)
+{
+    System_StartTime = esp_timer_get_time();
+
+    SYSTEM_QUEUES(QUEUE_CREATE)
+    SYSTEM_QUEUE_SETS(SET_CREATE)
+    SYSTEM_SET_MEMBERS(SET_MEMBER_ADD,0)
+
+    //Tasks are created last so every object they use already exists when they start
+    SYSTEM_TASKS(TASK_CREATE)
+
+    return NULL;
+}
+
+/*---------------------------------------------- Application tasks ----------------------------------------------*/
+
+static void Sending_Task1(void* pvParameters)
+{
+    const char* const Queue_String = "Sending the string from task1!!!\r\n";
+
+    System_TaskReady();
+
+    for(;;)
+    {
+        xQueueSendToBack(System_Queue(Queue1),&Queue_String,0);
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+}
+
+static void Sending_Task2(void* pvParameters)
+{
+    const char* const Queue_String = "Sending the string from task2!!!\r\n";
+
+    System_TaskReady();
+
+    for(;;)
+    {
+        xQueueSendToBack(System_Queue(Queue2),&Queue_String,0);
+        vTaskDelay(pdMS_TO_TICKS(200));
+    }
+}
+
+static void Receiving_Task(void* pvParameters)
+{
+    QueueHandle_t xQueue_Data_Receive;
+    char* ReceiveString;
+
+    System_TaskReady();
+
+    for(;;)
+    {
+        xQueue_Data_Receive = (QueueHandle_t) xQueueSelectFromSet(System_Set(ReceiveSet),pdMS_TO_TICKS(200));
+
+        if((xQueue_Data_Receive != NULL) && (xQueueReceive(xQueue_Data_Receive,&ReceiveString,0) == pdPASS))
+        {
+            printf("%s",ReceiveString);
+        }
+    }
+}
+
+void app_main(void)
+{
+    const char* Failed;
+
+    printf("Topology: %d tasks, %d queues, %d queue sets, %u bytes of RAM (budget %u)\r\n",System_TaskCount,
+           System_QueueCount,System_SetCount,(unsigned)SYSTEM_RAM_BYTES,(unsigned)SYSTEM_RAM_BUDGET);
+
+    Failed = System_Start();
+
+    if(Failed != NULL)
+    {
+        ESP_LOGE(RTOS,"Topology start failed at %s\r\n",Failed);
+    }
+}
@@ -0,0 +1,762 @@
+/**
+ * @file main.c
+ * @author Tushar Uttekar
+ *
+ * @brief
+ *
+ * This example demonstrates block based streaming kernels which process a whole batch of samples drained from a queue at once,
+ * instead of running a scalar loop for every sample received as the receivers of example 10 and 11 would do.
+ *
+ * The kernels are generated for int16, int32 and float samples by STREAM_KERNELS and are
+ * ->Moving average over a window, the history is kept in a linear buffer so the block loop has no modulo per sample.
+ * ->Exponential smoothing, Alpha is in Q15 for the integer types.
+ * ->FIR filter, the taps are in Q15 for the integer types, four outputs are computed at once so every tap is loaded once for
+ *   four samples and the block is handed over in chunks of STREAM_CHUNK samples to keep the stack small.
+ * ->Decimation, averages Factor samples into one output sample.
+ * ->Running statistics, count, min, max, mean and variance of the stream.
+ *
+ * Every kernel has a scalar reference version taking one sample at a time, the benchmark at the start runs both over the same
+ * signal and prints the cycles per sample along with the largest difference between the outputs.
+ *
+ * NOTE : The ESP32 has no general purpose SIMD unit, when the ESP-DSP component is part of the project the benchmark also runs
+ *        its assembly optimised dsps_fir_f32 (MAC with zero overhead loops) next to the float block FIR. The receiver works on
+ *        int32 samples and always uses the generated block kernels. The ESP-DSP FIR expects the taps in reversed order, the
+ *        low pass taps used here are symmetric so the same array is used.
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "xtensa/core-macros.h"
+#include "esp_log.h"
+#include "esp_system.h"
+
+#if defined(__has_include)
+#if __has_include("esp_dsp.h")
+#include "esp_dsp.h"
+#define STREAM_USE_ESP_DSP      1
+#endif
+#endif
+
+#define STREAM_MAX_WINDOW       32
+#define STREAM_MAX_TAPS         32
+#define STREAM_CHUNK            64
+#define STREAM_BATCH            32
+
+#define STREAM_MIN(A,B)         (((A) < (B)) ? (A) : (B))
+#define STREAM_MAX(A,B)         (((A) > (B)) ? (A) : (B))
+
+/*Scaling of an accumulated product of a sample with a coefficient, Q15 for the integer types*/
+#define STREAM_SCALE_Q15(Value) ((Value) >> 15)
+#define STREAM_SCALE_F32(Value) (Value)
+
+/*---------------------------------------------- Kernel generator ----------------------------------------------*/
+
+/*
+ * Name     Suffix of the generated types and functions
+ * Type     Sample type
+ * Acc      Accumulator for sums and products
+ * SqAcc    Accumulator for the sum of squares
+ * Coef     Type of the taps and of Alpha
+ * Scale    Scaling of an accumulated product back to the sample range
+ */
+#define STREAM_KERNELS(Name,Type,Acc,SqAcc,Coef,Scale)                                                          \
+                                                                                                                \
+typedef struct                                                                                                  \
+{                                                                                                               \
+    Type History[STREAM_MAX_WINDOW];    /*Block version keeps the last Window samples oldest first, the reference uses a ring*/ \
+    Acc Sum;                                                                                                    \
+    uint16_t Window;                                                                                            \
+    uint16_t Index;                                                                                             \
+}MovAvg_##Name##_t;                                                                                             \
+                                                                                                                \
+typedef struct                                                                                                  \
+{                                                                                                               \
+    Acc Value;                                                                                                  \
+    Coef Alpha;                                                                                                 \
+}Smooth_##Name##_t;                                                                                             \
+                                                                                                                \
+typedef struct                                                                                                  \
+{                                                                                                               \
+    const Coef* Taps;                                                                                           \
+    uint16_t TapCount;                                                                                          \
+    uint16_t Index;                                                                                             \
+    Type Delay[STREAM_MAX_TAPS];        /*Block version keeps the last TapCount-1 samples oldest first, the reference uses a ring*/ \
+}Fir_##Name##_t;                                                                                                \
+                                                                                                                \
+typedef struct                                                                                                  \
+{                                                                                                               \
+    Acc Sum;                                                                                                    \
+    uint16_t Factor;                                                                                            \
+    uint16_t Phase;                                                                                             \
+}Decimate_##Name##_t;                                                                                           \
+                                                                                                                \
+typedef struct                                                                                                  \
+{                                                                                                               \
+    uint32_t Count;                                                                                             \
+    Type Min;                                                                                                   \
+    Type Max;                                                                                                   \
+    Acc Sum;                                                                                                    \
+    SqAcc SumSq;                                                                                                \
+}Stats_##Name##_t;                                                                                              \
+                                                                                                                \
+/*A window of zero samples has no average, pdFAIL without touching State*/                                      \
+static inline BaseType_t Stream_MovAvgInit_##Name(MovAvg_##Name##_t* State, uint16_t Window)                    \
+{                                                                                                               \
+    if(Window == 0)                                                                                             \
+    {                                                                                                           \
+        return pdFAIL;                                                                                          \
+    }                                                                                                           \
+                                                                                                                \
+    memset(State,0,sizeof(*State));                                                                             \
+    State->Window = STREAM_MIN(Window,STREAM_MAX_WINDOW);                                                       \
+                                                                                                                \
+    return pdPASS;                                                                                              \
+}                                                                                                               \
+                                                                                                                \
+static Type Stream_MovAvgRef_##Name(MovAvg_##Name##_t* State, Type Sample)                                      \
+{                                                                                                               \
+    State->Sum += (Acc)Sample - (Acc)State->History[State->Index];                                              \
+    State->History[State->Index] = Sample;                                                                      \
+    State->Index = (State->Index + 1) % State->Window;                                                          \
+                                                                                                                \
+    return (Type)(State->Sum / State->Window);                                                                  \
+}                                                                                                               \
+                                                                                                                \
+static void Stream_MovAvg_##Name(MovAvg_##Name##_t* State, const Type* In, Type* Out, size_t Count)             \
+{                                                                                                               \
+    const size_t Window = State->Window;                                                                        \
+    const size_t Head = STREAM_MIN(Count,Window);                                                               \
+    Acc Sum = State->Sum;                                                                                       \
+    size_t Loop;                                                                                                \
+                                                                                                                \
+    /*The sample leaving the window comes from the history for the first Window samples and from the block after*/ \
+    for(Loop = 0; Loop < Head; Loop++)                                                                          \
+    {                                                                                                           \
+        Sum += (Acc)In[Loop] - (Acc)State->History[Loop];                                                       \
+        Out[Loop] = (Type)(Sum / (Acc)Window);                                                                  \
+    }                                                                                                           \
+                                                                                                                \
+    for(; Loop < Count; Loop++)                                                                                 \
+    {                                                                                                           \
+        Sum += (Acc)In[Loop] - (Acc)In[Loop - Window];                                                          \
+        Out[Loop] = (Type)(Sum / (Acc)Window);                                                                  \
+    }                                                                                                           \
+                                                                                                                \
+    if(Count >= Window)                                                                                         \
+    {                                                                                                           \
+        memcpy(State->History,&In[Count - Window],Window * sizeof(Type));                                       \
+    }                                                                                                           \
+    else                                                                                                        \
+    {                                                                                                           \
+        memmove(State->History,&State->History[Count],(Window - Count) * sizeof(Type));                         \
+        memcpy(&State->History[Window - Count],In,Count * sizeof(Type));                                        \
+    }                                                                                                           \
+                                                                                                                \
+    State->Sum = Sum;                                                                                           \
+}                                                                                                               \
+                                                                                                                \
+static inline void Stream_SmoothInit_##Name(Smooth_##Name##_t* State, Coef Alpha)                               \
+{                                                                                                               \
+    State->Value = 0;                                                                                           \
+    State->Alpha = Alpha;                                                                                       \
+}                                                                                                               \
+                                                                                                                \
+static Type Stream_SmoothRef_##Name(Smooth_##Name##_t* State, Type Sample)                                      \
+{                                                                                                               \
+    State->Value += Scale(((Acc)Sample - State->Value) * (Acc)State->Alpha);                                    \
+                                                                                                                \
+    return (Type)State->Value;                                                                                  \
+}                                                                                                               \
+                                                                                                                \
+static void Stream_Smooth_##Name(Smooth_##Name##_t* State, const Type* In, Type* Out, size_t Count)             \
+{                                                                                                               \
+    const Acc Alpha = (Acc)State->Alpha;                                                                        \
+    Acc Value = State->Value;                                                                                   \
+    size_t Loop;                                                                                                \
+                                                                                                                \
+    /*Every output depends on the previous one, the gain is keeping the state in a register for the whole block*/ \
+    for(Loop = 0; Loop < Count; Loop++)                                                                         \
+    {                                                                                                           \
+        Value += Scale(((Acc)In[Loop] - Value) * Alpha);                                                        \
+        Out[Loop] = (Type)Value;                                                                                \
+    }                                                                                                           \
+                                                                                                                \
+    State->Value = Value;                                                                                       \
+}                                                                                                               \
+                                                                                                                \
+static inline BaseType_t Stream_FirInit_##Name(Fir_##Name##_t* State, const Coef* Taps, uint16_t TapCount)      \
+{                                                                                                               \
+    if((Taps == NULL) || (TapCount == 0))                                                                       \
+    {                                                                                                           \
+        return pdFAIL;                                                                                          \
+    }                                                                                                           \
+                                                                                                                \
+    memset(State,0,sizeof(*State));                                                                             \
+    State->Taps = Taps;                                                                                         \
+    State->TapCount = STREAM_MIN(TapCount,STREAM_MAX_TAPS);                                                     \
+                                                                                                                \
+    return pdPASS;                                                                                              \
+}                                                                                                               \
+                                                                                                                \
+static Type Stream_FirRef_##Name(Fir_##Name##_t* State, Type Sample)                                            \
+{                                                                                                               \
+    const uint16_t TapCount = State->TapCount;                                                                  \
+    Acc Sum = 0;                                                                                                \
+    uint16_t Tap;                                                                                               \
+                                                                                                                \
+    State->Delay[State->Index] = Sample;                                                                        \
+                                                                                                                \
+    for(Tap = 0; Tap < TapCount; Tap++)                                                                         \
+    {                                                                                                           \
+        Sum += (Acc)State->Delay[(State->Index + TapCount - Tap) % TapCount] * (Acc)State->Taps[Tap];           \
+    }                                                                                                           \
+                                                                                                                \
+    State->Index = (State->Index + 1) % TapCount;                                                               \
+                                                                                                                \
+    return (Type)Scale(Sum);                                                                                    \
+}                                                                                                               \
+                                                                                                                \
+static void Stream_Fir_##Name(Fir_##Name##_t* State, const Type* In, Type* Out, size_t Count)                   \
+{                                                                                                               \
+    const size_t History = State->TapCount - 1;                                                                 \
+    Type Ext[STREAM_MAX_TAPS - 1 + STREAM_CHUNK];                                                               \
+    const Type* Sample;                                                                                         \
+    Acc Sum0, Sum1, Sum2, Sum3, Tap;                                                                            \
+    size_t Chunk, Loop, Index;                                                                                  \
+                                                                                                                \
+    while(Count > 0)                                                                                            \
+    {                                                                                                           \
+        Chunk = STREAM_MIN(Count,STREAM_CHUNK);                                                                 \
+        memcpy(Ext,State->Delay,History * sizeof(Type));                                                        \
+        memcpy(&Ext[History],In,Chunk * sizeof(Type));                                                          \
+                                                                                                                \
+        /*Four outputs at a time, every tap is loaded once and multiplied with four neighbouring samples*/       \
+        for(Loop = 0; (Loop + 4) <= Chunk; Loop += 4)                                                           \
+        {                                                                                                       \
+            Sum0 = Sum1 = Sum2 = Sum3 = 0;                                                                      \
+            Sample = &Ext[History + Loop];                                                                      \
+                                                                                                                \
+            for(Index = 0; Index <= History; Index++, Sample--)                                                 \
+            {                                                                                                   \
+                Tap = (Acc)State->Taps[Index];                                                                  \
+                Sum0 += (Acc)Sample[0] * Tap;                                                                   \
+                Sum1 += (Acc)Sample[1] * Tap;                                                                   \
+                Sum2 += (Acc)Sample[2] * Tap;                                                                   \
+                Sum3 += (Acc)Sample[3] * Tap;                                                                   \
+            }                                                                                                   \
+                                                                                                                \
+            Out[Loop] = (Type)Scale(Sum0);                                                                      \
+            Out[Loop + 1] = (Type)Scale(Sum1);                                                                  \
+            Out[Loop + 2] = (Type)Scale(Sum2);                                                                  \
+            Out[Loop + 3] = (Type)Scale(Sum3);                                                                  \
+        }                                                                                                       \
+                                                                                                                \
+        for(; Loop < Chunk; Loop++)                                                                             \
+        {                                                                                                       \
+            Sum0 = 0;                                                                                           \
+            Sample = &Ext[History + Loop];                                                                      \
+                                                                                                                \
+            for(Index = 0; Index <= History; Index++, Sample--)                                                 \
+            {                                                                                                   \
+                Sum0 += (Acc)Sample[0] * (Acc)State->Taps[Index];                                               \
+            }                                                                                                   \
+                                                                                                                \
+            Out[Loop] = (Type)Scale(Sum0);                                                                      \
+        }                                                                                                       \
+                                                                                                                \
+        memcpy(State->Delay,&Ext[Chunk],History * sizeof(Type));                                                \
+        In += Chunk;                                                                                            \
+        Out += Chunk;                                                                                           \
+        Count -= Chunk;                                                                                         \
+    }                                                                                                           \
+}                                                                                                               \
+                                                                                                                \
+static inline BaseType_t Stream_DecimateInit_##Name(Decimate_##Name##_t* State, uint16_t Factor)                \
+{                                                                                                               \
+    if(Factor == 0)                                                                                             \
+    {                                                                                                           \
+        return pdFAIL;                                                                                          \
+    }                                                                                                           \
+                                                                                                                \
+    State->Sum = 0;                                                                                             \
+    State->Factor = Factor;                                                                                     \
+    State->Phase = 0;                                                                                           \
+                                                                                                                \
+    return pdPASS;                                                                                              \
+}                                                                                                               \
+                                                                                                                \
+/*Returns pdTRUE when an output sample is produced*/                                                            \
+static BaseType_t Stream_DecimateRef_##Name(Decimate_##Name##_t* State, Type Sample, Type* Out)                 \
+{                                                                                                               \
+    State->Sum += (Acc)Sample;                                                                                  \
+                                                                                                                \
+    if(++State->Phase < State->Factor)                                                                          \
+    {                                                                                                           \
+        return pdFALSE;                                                                                         \
+    }                                                                                                           \
+                                                                                                                \
+    *Out = (Type)(State->Sum / (Acc)State->Factor);                                                             \
+    State->Sum = 0;                                                                                             \
+    State->Phase = 0;                                                                                           \
+                                                                                                                \
+    return pdTRUE;                                                                                              \
+}                                                                                                               \
+                                                                                                                \
+/*Returns the number of output samples, Out has to hold Count / Factor + 1 samples*/                            \
+static size_t Stream_Decimate_##Name(Decimate_##Name##_t* State, const Type* In, Type* Out, size_t Count)       \
+{                                                                                                               \
+    const size_t Factor = State->Factor;                                                                        \
+    size_t Produced = 0, Loop = 0, Index;                                                                       \
+    Acc Sum = State->Sum;                                                                                       \
+                                                                                                                \
+    /*Completes the group which was left open by the previous block*/                                           \
+    if(State->Phase != 0)                                                                                       \
+    {                                                                                                           \
+        for(; (Loop < Count) && ((State->Phase + Loop) < Factor); Loop++)                                       \
+        {                                                                                                       \
+            Sum += (Acc)In[Loop];                                                                               \
+        }                                                                                                       \
+                                                                                                                \
+        if((State->Phase + Loop) < Factor)                                                                      \
+        {                                                                                                       \
+            State->Sum = Sum;                                                                                   \
+            State->Phase += Loop;                                                                               \
+            return 0;                                                                                           \
+        }                                                                                                       \
+                                                                                                                \
+        Out[Produced++] = (Type)(Sum / (Acc)Factor);                                                            \
+    }                                                                                                           \
+                                                                                                                \
+    /*Full groups, two accumulators so the additions do not wait for each other*/                               \
+    for(; (Loop + Factor) <= Count; Loop += Factor)                                                             \
+    {                                                                                                           \
+        Acc Sum0 = 0, Sum1 = 0;                                                                                 \
+                                                                                                                \
+        for(Index = 0; (Index + 2) <= Factor; Index += 2)                                                       \
+        {                                                                                                       \
+            Sum0 += (Acc)In[Loop + Index];                                                                      \
+            Sum1 += (Acc)In[Loop + Index + 1];                                                                  \
+        }                                                                                                       \
+                                                                                                                \
+        if(Index < Factor)                                                                                      \
+        {                                                                                                       \
+            Sum0 += (Acc)In[Loop + Index];                                                                      \
+        }                                                                                                       \
+                                                                                                                \
+        Out[Produced++] = (Type)((Sum0 + Sum1) / (Acc)Factor);                                                  \
+    }                                                                                                           \
+                                                                                                                \
+    /*Remaining samples start the next group*/                                                                  \
+    for(Sum = 0, State->Phase = 0; Loop < Count; Loop++, State->Phase++)                                        \
+    {                                                                                                           \
+        Sum += (Acc)In[Loop];                                                                                   \
+    }                                                                                                           \
+                                                                                                                \
+    State->Sum = Sum;                                                                                           \
+                                                                                                                \
+    return Produced;                                                                                            \
+}                                                                                                               \
+                                                                                                                \
+static inline void Stream_StatsInit_##Name(Stats_##Name##_t* State)                                             \
+{                                                                                                               \
+    memset(State,0,sizeof(*State));                                                                             \
+}                                                                                                               \
+                                                                                                                \
+static void Stream_StatsRef_##Name(Stats_##Name##_t* State, Type Sample)                                        \
+{                                                                                                               \
+    if((State->Count == 0) || (Sample < State->Min))                                                            \
+    {                                                                                                           \
+        State->Min = Sample;                                                                                    \
+    }                                                                                                           \
+                                                                                                                \
+    if((State->Count == 0) || (Sample > State->Max))                                                            \
+    {                                                                                                           \
+        State->Max = Sample;                                                                                    \
+    }                                                                                                           \
+                                                                                                                \
+    State->Sum += (Acc)Sample;                                                                                  \
+    State->SumSq += (SqAcc)Sample * (SqAcc)Sample;                                                              \
+    State->Count++;                                                                                             \
+}                                                                                                               \
+                                                                                                                \
+static void Stream_Stats_##Name(Stats_##Name##_t* State, const Type* In, size_t Count)                          \
+{                                                                                                               \
+    Type Min0, Max0, Min1, Max1;                                                                                \
+    Acc Sum0 = 0, Sum1 = 0;                                                                                     \
+    SqAcc Sq0 = 0, Sq1 = 0;                                                                                     \
+    size_t Loop;                                                                                                \
+                                                                                                                \
+    if(Count == 0)                                                                                              \
+    {                                                                                                           \
+        return;                                                                                                 \
+    }                                                                                                           \
+                                                                                                                \
+    Min0 = Min1 = (State->Count == 0) ? In[0] : State->Min;                                                     \
+    Max0 = Max1 = (State->Count == 0) ? In[0] : State->Max;                                                     \
+                                                                                                                \
+    /*Two independent sets of accumulators, the even and the odd samples are merged at the end*/                \
+    for(Loop = 0; (Loop + 2) <= Count; Loop += 2)                                                               \
+    {                                                                                                           \
+        Min0 = STREAM_MIN(Min0,In[Loop]);                                                                       \
+        Max0 = STREAM_MAX(Max0,In[Loop]);                                                                       \
+        Min1 = STREAM_MIN(Min1,In[Loop + 1]);                                                                   \
+        Max1 = STREAM_MAX(Max1,In[Loop + 1]);                                                                   \
+        Sum0 += (Acc)In[Loop];                                                                                  \
+        Sum1 += (Acc)In[Loop + 1];                                                                              \
+        Sq0 += (SqAcc)In[Loop] * (SqAcc)In[Loop];                                                               \
+        Sq1 += (SqAcc)In[Loop + 1] * (SqAcc)In[Loop + 1];                                                       \
+    }                                                                                                           \
+                                                                                                                \
+    if(Loop < Count)                                                                                            \
+    {                                                                                                           \
+        Min0 = STREAM_MIN(Min0,In[Loop]);                                                                       \
+        Max0 = STREAM_MAX(Max0,In[Loop]);                                                                       \
+        Sum0 += (Acc)In[Loop];                                                                                  \
+        Sq0 += (SqAcc)In[Loop] * (SqAcc)In[Loop];                                                               \
+    }                                                                                                           \
+                                                                                                                \
+    State->Min = STREAM_MIN(Min0,Min1);                                                                         \
+    State->Max = STREAM_MAX(Max0,Max1);                                                                         \
+    State->Sum += Sum0 + Sum1;                                                                                  \
+    State->SumSq += Sq0 + Sq1;                                                                                  \
+    State->Count += Count;                                                                                      \
+}                                                                                                               \
+                                                                                                                \
+static void Stream_StatsResult_##Name(const Stats_##Name##_t* State, float* Mean, float* Variance)              \
+{                                                                                                               \
+    float Average = (State->Count != 0) ? (float)State->Sum / (float)State->Count : 0.0f;                       \
+                                                                                                                \
+    *Mean = Average;                                                                                            \
+    *Variance = (State->Count != 0) ? ((float)State->SumSq / (float)State->Count) - (Average * Average) : 0.0f; \
+}
+
+/*int16 samples, 64 bit accumulators so 32 taps of full scale samples can not overflow*/
+STREAM_KERNELS(S16,int16_t,int64_t,int64_t,int16_t,STREAM_SCALE_Q15)
+
+/*int32 samples, the sum of squares is kept in a double as it would overflow 64 bits*/
+STREAM_KERNELS(S32,int32_t,int64_t,double,int16_t,STREAM_SCALE_Q15)
+
+/*float samples, single precision accumulators as the FPU of the ESP32 has no double precision*/
+STREAM_KERNELS(F32,float,float,float,float,STREAM_SCALE_F32)
+
+#if STREAM_USE_ESP_DSP
+typedef struct
+{
+    fir_f32_t Fir;
+    float Delay[STREAM_MAX_TAPS];
+}FirDsp_F32_t;
+
+static BaseType_t Stream_FirDspInit_F32(FirDsp_F32_t* State, const float* Taps, uint16_t TapCount)
+{
+    if((Taps == NULL) || (TapCount == 0))
+    {
+        return pdFAIL;
+    }
+
+    memset(State->Delay,0,sizeof(State->Delay));
+
+    if(dsps_fir_init_f32(&State->Fir,(float*)Taps,State->Delay,STREAM_MIN(TapCount,STREAM_MAX_TAPS)) != ESP_OK)
+    {
+        return pdFAIL;
+    }
+
+    return pdPASS;
+}
+
+static void Stream_FirDsp_F32(FirDsp_F32_t* State, const float* In, float* Out, size_t Count)
+{
+    dsps_fir_f32(&State->Fir,In,Out,(int)Count);
+}
+#endif
+
+/*---------------------------------------------- Filter coefficients ----------------------------------------------*/
+
+/*15 tap low pass, symmetric, sum of the taps is 1.0*/
+static const float Fir_TapsF32[15] =
+{
+    -0.0067f, -0.0097f, 0.0000f, 0.0406f, 0.1067f, 0.1727f, 0.2164f, 0.2400f,
+    0.2164f, 0.1727f, 0.1067f, 0.0406f, 0.0000f, -0.0097f, -0.0067f
+};
+
+static int16_t Fir_TapsQ15[15];
+
+#define SMOOTH_ALPHA_F32        0.125f
+#define SMOOTH_ALPHA_Q15        ((int16_t)(SMOOTH_ALPHA_F32 * 32768))
+#define MOVAVG_WINDOW           16
+#define DECIMATE_FACTOR         4
+
+/*---------------------------------------------- Benchmark ----------------------------------------------*/
+
+#define BENCH_SAMPLES           1024
+#define BENCH_BLOCK             32
+
+static uint32_t Bench_Cycles;
+
+#define BENCH_START()           Bench_Cycles = XTHAL_GET_CCOUNT()
+#define BENCH_STOP()            (XTHAL_GET_CCOUNT() - Bench_Cycles)
+
+static void Bench_Print(const char* Type, const char* Kernel, uint32_t RefCycles, uint32_t BlockCycles, double MaxError)
+{
+    printf("%-4s %-10s %8.2f %8.2f %6.2fx %12.6f\r\n",Type,Kernel,(double)RefCycles / BENCH_SAMPLES,
+           (double)BlockCycles / BENCH_SAMPLES,(double)RefCycles / (double)STREAM_MAX(BlockCycles,1),MaxError);
+}
+
+/*Runs every kernel as reference per sample and as block over the same input, the blocks are BENCH_BLOCK samples as drained
+  from a queue*/
+#define STREAM_BENCH(Name,Type,Alpha,Taps)                                                                      \
+static void Stream_Bench_##Name(const Type* In, Type* Ref, Type* Block)                                         \
+{                                                                                                               \
+    MovAvg_##Name##_t MovAvg;                                                                                   \
+    Smooth_##Name##_t Smooth;                                                                                   \
+    Fir_##Name##_t Fir;                                                                                         \
+    Decimate_##Name##_t Decimate;                                                                               \
+    Stats_##Name##_t Stats;                                                                                     \
+    uint32_t RefCycles, BlockCycles;                                                                            \
+    size_t Loop, RefCount, BlockCount;                                                                          \
+    float RefMean, RefVariance, Mean, Variance;                                                                 \
+    double MaxError;                                                                                            \
+                                                                                                                \
+    Stream_MovAvgInit_##Name(&MovAvg,MOVAVG_WINDOW);                                                            \
+    BENCH_START();                                                                                              \
+    for(Loop = 0; Loop < BENCH_SAMPLES; Loop++) { Ref[Loop] = Stream_MovAvgRef_##Name(&MovAvg,In[Loop]); }      \
+    RefCycles = BENCH_STOP();                                                                                   \
+    Stream_MovAvgInit_##Name(&MovAvg,MOVAVG_WINDOW);                                                            \
+    BENCH_START();                                                                                              \
+    for(Loop = 0; Loop < BENCH_SAMPLES; Loop += BENCH_BLOCK)                                                    \
+    {                                                                                                           \
+        Stream_MovAvg_##Name(&MovAvg,&In[Loop],&Block[Loop],BENCH_BLOCK);                                       \
+    }                                                                                                           \
+    BlockCycles = BENCH_STOP();                                                                                 \
+    Bench_Print(#Name,"MovAvg",RefCycles,BlockCycles,Bench_MaxError_##Name(Ref,Block,BENCH_SAMPLES));          \
+                                                                                                                \
+    Stream_SmoothInit_##Name(&Smooth,Alpha);                                                                    \
+    BENCH_START();                                                                                              \
+    for(Loop = 0; Loop < BENCH_SAMPLES; Loop++) { Ref[Loop] = Stream_SmoothRef_##Name(&Smooth,In[Loop]); }      \
+    RefCycles = BENCH_STOP();                                                                                   \
+    Stream_SmoothInit_##Name(&Smooth,Alpha);                                                                    \
+    BENCH_START();                                                                                              \
+    for(Loop = 0; Loop < BENCH_SAMPLES; Loop += BENCH_BLOCK)                                                    \
+    {                                                                                                           \
+        Stream_Smooth_##Name(&Smooth,&In[Loop],&Block[Loop],BENCH_BLOCK);                                       \
+    }                                                                                                           \
+    BlockCycles = BENCH_STOP();                                                                                 \
+    Bench_Print(#Name,"Smooth",RefCycles,BlockCycles,Bench_MaxError_##Name(Ref,Block,BENCH_SAMPLES));          \
+                                                                                                                \
+    Stream_FirInit_##Name(&Fir,Taps,15);                                                                        \
+    BENCH_START();                                                                                              \
+    for(Loop = 0; Loop < BENCH_SAMPLES; Loop++) { Ref[Loop] = Stream_FirRef_##Name(&Fir,In[Loop]); }            \
+    RefCycles = BENCH_STOP();                                                                                   \
+    Stream_FirInit_##Name(&Fir,Taps,15);                                                                        \
+    BENCH_START();                                                                                              \
+    for(Loop = 0; Loop < BENCH_SAMPLES; Loop += BENCH_BLOCK)                                                    \
+    {                                                                                                           \
+        Stream_Fir_##Name(&Fir,&In[Loop],&Block[Loop],BENCH_BLOCK);                                             \
+    }                                                                                                           \
+    BlockCycles = BENCH_STOP();                                                                                 \
+    Bench_Print(#Name,"FIR",RefCycles,BlockCycles,Bench_MaxError_##Name(Ref,Block,BENCH_SAMPLES));             \
+                                                                                                                \
+    Stream_DecimateInit_##Name(&Decimate,DECIMATE_FACTOR);                                                      \
+    RefCount = 0;                                                                                               \
+    BENCH_START();                                                                                              \
+    for(Loop = 0; Loop < BENCH_SAMPLES; Loop++)                                                                 \
+    {                                                                                                           \
+        RefCount += Stream_DecimateRef_##Name(&Decimate,In[Loop],&Ref[RefCount]);                               \
+    }                                                                                                           \
+    RefCycles = BENCH_STOP();                                                                                   \
+    Stream_DecimateInit_##Name(&Decimate,DECIMATE_FACTOR);                                                      \
+    BlockCount = 0;                                                                                             \
+    BENCH_START();                                                                                              \
+    for(Loop = 0; Loop < BENCH_SAMPLES; Loop += BENCH_BLOCK)                                                    \
+    {                                                                                                           \
+        BlockCount += Stream_Decimate_##Name(&Decimate,&In[Loop],&Block[BlockCount],BENCH_BLOCK);               \
+    }                                                                                                           \
+    BlockCycles = BENCH_STOP();                                                                                 \
+    MaxError = (RefCount == BlockCount) ? Bench_MaxError_##Name(Ref,Block,RefCount) : INFINITY;                 \
+    Bench_Print(#Name,"Decimate",RefCycles,BlockCycles,MaxError);                                               \
+                                                                                                                \
+    Stream_StatsInit_##Name(&Stats);                                                                            \
+    BENCH_START();                                                                                              \
+    for(Loop = 0; Loop < BENCH_SAMPLES; Loop++) { Stream_StatsRef_##Name(&Stats,In[Loop]); }                    \
+    RefCycles = BENCH_STOP();                                                                                   \
+    Stream_StatsResult_##Name(&Stats,&RefMean,&RefVariance);                                                    \
+    Stream_StatsInit_##Name(&Stats);                                                                            \
+    BENCH_START();                                                                                              \
+    for(Loop = 0; Loop < BENCH_SAMPLES; Loop += BENCH_BLOCK)                                                    \
+    {                                                                                                           \
+        Stream_Stats_##Name(&Stats,&In[Loop],BENCH_BLOCK);                                                      \
+    }                                                                                                           \
+    BlockCycles = BENCH_STOP();                                                                                 \
+    Stream_StatsResult_##Name(&Stats,&Mean,&Variance);                                                          \
+    MaxError = STREAM_MAX(fabs((double)RefMean - Mean),fabs((double)RefVariance - Variance) / RefVariance);     \
+    Bench_Print(#Name,"Stats",RefCycles,BlockCycles,MaxError);                                                  \
+}
+
+#define STREAM_MAX_ERROR(Name,Type)                                                                             \
+static double Bench_MaxError_##Name(const Type* Ref, const Type* Block, size_t Count)                           \
+{                                                                                                               \
+    double MaxError = 0;                                                                                        \
+    size_t Loop;                                                                                                \
+                                                                                                                \
+    for(Loop = 0; Loop < Count; Loop++)                                                                         \
+    {                                                                                                           \
+        MaxError = STREAM_MAX(MaxError,fabs((double)Ref[Loop] - (double)Block[Loop]));                          \
+    }                                                                                                           \
+                                                                                                                \
+    return MaxError;                                                                                            \
+}
+
+STREAM_MAX_ERROR(S16,int16_t)
+STREAM_MAX_ERROR(S32,int32_t)
+STREAM_MAX_ERROR(F32,float)
+
+STREAM_BENCH(S16,int16_t,SMOOTH_ALPHA_Q15,Fir_TapsQ15)
+STREAM_BENCH(S32,int32_t,SMOOTH_ALPHA_Q15,Fir_TapsQ15)
+STREAM_BENCH(F32,float,SMOOTH_ALPHA_F32,Fir_TapsF32)
+
+static void Benchmark_Task(void* pvParameters)
+{
+    static int16_t InS16[BENCH_SAMPLES], RefS16[BENCH_SAMPLES], BlockS16[BENCH_SAMPLES];
+    static int32_t InS32[BENCH_SAMPLES], RefS32[BENCH_SAMPLES], BlockS32[BENCH_SAMPLES];
+    static float InF32[BENCH_SAMPLES], RefF32[BENCH_SAMPLES], BlockF32[BENCH_SAMPLES];
+    int32_t Value;
+    size_t Loop;
+
+    //Triangle wave with noise, scaled to the range of every type
+    for(Loop = 0; Loop < BENCH_SAMPLES; Loop++)
+    {
+        Value = (int32_t)((Loop & 0x100) ? (0x100 - (Loop & 0xFF)) : (Loop & 0xFF)) * 96 - 12288;
+        Value += (int32_t)(esp_random() & 0x3FF) - 0x200;
+        InS16[Loop] = (int16_t)Value;
+        InS32[Loop] = Value * 64;
+        InF32[Loop] = (float)Value / 1000.0f;
+    }
+
+    printf("Type Kernel        RefCyc  BlkCyc  Speed     MaxError\r\n");
+    Stream_Bench_S16(InS16,RefS16,BlockS16);
+    Stream_Bench_S32(InS32,RefS32,BlockS32);
+    Stream_Bench_F32(InF32,RefF32,BlockF32);
+
+#if STREAM_USE_ESP_DSP
+    {
+        static FirDsp_F32_t FirDsp;
+        Fir_F32_t Fir;
+        uint32_t RefCycles, BlockCycles;
+
+        Stream_FirInit_F32(&Fir,Fir_TapsF32,15);
+        BENCH_START();
+        for(Loop = 0; Loop < BENCH_SAMPLES; Loop++) { RefF32[Loop] = Stream_FirRef_F32(&Fir,InF32[Loop]); }
+        RefCycles = BENCH_STOP();
+
+        Stream_FirDspInit_F32(&FirDsp,Fir_TapsF32,15);
+        BENCH_START();
+        for(Loop = 0; Loop < BENCH_SAMPLES; Loop += BENCH_BLOCK)
+        {
+            Stream_FirDsp_F32(&FirDsp,&InF32[Loop],&BlockF32[Loop],BENCH_BLOCK);
+        }
+        BlockCycles = BENCH_STOP();
+        Bench_Print("F32","FIR DSP",RefCycles,BlockCycles,Bench_MaxError_F32(RefF32,BlockF32,BENCH_SAMPLES));
+    }
+#endif
+
+    vTaskDelete(NULL);
+}
+
+/*---------------------------------------------- Queue consumer ----------------------------------------------*/
+
+xQueueHandle xQueue;
+
+static void Sender_Task(void* pvParameters)
+{
+    int32_t Sending_Value, Base;
+    BaseType_t xStatus;
+
+    Base = (int32_t) pvParameters;
+
+    for(;;)
+    {
+        Sending_Value = Base + (int32_t)(esp_random() & 0x3F) - 0x20;
+
+        xStatus = xQueueSendToBack(xQueue,&Sending_Value,100);
+
+        if(xStatus != pdPASS)
+        {
+            printf("Unable to send data to queue!!\r\n");
+        }
+
+        vTaskDelay(1);
+    }
+}
+
+static void Receiver_Task(void* pvParameters)
+{
+    int32_t Batch[STREAM_BATCH], Filtered[STREAM_BATCH], Decimated[STREAM_BATCH / DECIMATE_FACTOR + 1];
+    MovAvg_S32_t MovAvg;
+    Fir_S32_t Fir;
+    Decimate_S32_t Decimate;
+    Stats_S32_t Stats;
+    size_t Count;
+    float Mean, Variance;
+
+    if((Stream_MovAvgInit_S32(&MovAvg,MOVAVG_WINDOW) == pdFAIL) || (Stream_FirInit_S32(&Fir,Fir_TapsQ15,15) == pdFAIL) ||
+       (Stream_DecimateInit_S32(&Decimate,DECIMATE_FACTOR) == pdFAIL))
+    {
+        printf("Stream kernels could not be initialized.\r\n");
+        vTaskDelete(NULL);
+    }
+
+    Stream_StatsInit_S32(&Stats);
+
+    for(;;)
+    {
+        //Waits for the first sample, then drains whatever else is already in the queue up to a full batch
+        if(xQueueReceive(xQueue,&Batch[0],portMAX_DELAY) != pdPASS)
+        {
+            continue;
+        }
+
+        for(Count = 1; (Count < STREAM_BATCH) && (xQueueReceive(xQueue,&Batch[Count],0) == pdPASS); Count++);
+
+        Stream_Stats_S32(&Stats,Batch,Count);
+        Stream_MovAvg_S32(&MovAvg,Batch,Filtered,Count);
+        Stream_Fir_S32(&Fir,Filtered,Filtered,Count);
+        Stream_Decimate_S32(&Decimate,Filtered,Decimated,Count);
+
+        if(Stats.Count >= 1000)
+        {
+            Stream_StatsResult_S32(&Stats,&Mean,&Variance);
+            printf("Samples %u min %d max %d mean %.1f variance %.1f filtered %d\r\n",Stats.Count,Stats.Min,Stats.Max,
+                   Mean,Variance,Filtered[Count - 1]);
+            Stream_StatsInit_S32(&Stats);
+        }
+    }
+}
+
+void app_main(void)
+{
+    size_t Loop;
+
+    for(Loop = 0; Loop < 15; Loop++)
+    {
+        Fir_TapsQ15[Loop] = (int16_t)lrintf(Fir_TapsF32[Loop] * 32768.0f);
+    }
+
+    xTaskCreate(Benchmark_Task,"Benchmark",4096,NULL,3,NULL);
+
+    xQueue = xQueueCreate(64,sizeof(int32_t));
+
+    if(xQueue != NULL)
+    {
+        xTaskCreate(Sender_Task,"Sender_I1",2048,(void*)100,1,NULL);
+        xTaskCreate(Sender_Task,"Sender_I2",2048,(void*)200,1,NULL);
+        xTaskCreate(Receiver_Task,"Receiver",4096,NULL,2,NULL);
+    }
+}
@@ -0,0 +1,458 @@
+/**
+ * @file main.c
+ * @author Tushar Uttekar
+ *
+ * @brief
+ *
+ * This example demonstrates threaded interrupts, one registration call replaces the hand written pair of an Interrupt_Handler
+ * and a Handler_Function task of the examples 16, 17, 24 and 25.
+ *
+ * An interrupt is registered with ThreadedIrq_Register and an IrqConfig_t, which gives a top half, a bottom half, and the priority
+ * and the core of the task which runs the bottom half.
+ * ->The top half runs in the interrupt, it clears the source and returns the number of events for the bottom half, 0 when
+ *   everything has been done in the interrupt.
+ * ->The framework owns the notification of the task and the portYIELD_FROM_ISR. Events which come while the bottom half has not
+ *   run yet are coalesced, the bottom half is called once with the number of events.
+ * ->A dedicated thread runs the bottom half of one interrupt. Interrupts registered as Shared share one thread for each priority
+ *   and core, which saves a task and its stack for sources with a low rate, every interrupt of the thread has a notification bit.
+ * ->Statistics for every interrupt, interrupts, events and bottom half runs, the cycles of the top half and the latency from the
+ *   top half to the start of the bottom half.
+ * ->Soft sources, an interrupt registered with IRQ_SOURCE_SOFT has no hardware behind it, ThreadedIrq_Raise raises it like a signal
+ *   through the software interrupt. All the soft sources share the one software interrupt, so any number of them can be
+ *   registered and driven by a test without hardware.
+ *
+ * The four examples are registered as soft sources and raised every 500 ms as before, 16 and 17 with a thread of their own at
+ * priority 3, 24 and 25 on a shared thread at priority 2.
+ *
+ * NOTE : An interrupt is allocated on the core which calls ThreadedIrq_Register, Core only places the bottom half. The software
+ *        interrupt is a per core interrupt, so ThreadedIrq_Raise has to be called on the core which registered the first soft
+ *        source.
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/portmacro.h"
+#include "freertos/xtensa_api.h"
+#include "xtensa/core-macros.h"
+#include "esp_intr_alloc.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "esp_system.h"
+
+#define RTOS                    "FREERTOS"
+#define SW_ISR_LEVEL_3          29
+
+#define IRQ_MAX                 16
+#define IRQ_MAX_THREADS         8
+#define IRQ_THREAD_SLOTS        32          //Interrupts on one shared thread, one notification bit each
+#define IRQ_THREAD_STACK        3072
+#define IRQ_SOURCE_SOFT         (-1)
+
+typedef uint32_t (*IrqTopHalf_t)(void* Arg);
+typedef void (*IrqBottomHalf_t)(void* Arg, uint32_t Events);
+
+typedef struct
+{
+    const char* Name;
+    int Source;                             //Interrupt source of esp_intr_alloc or IRQ_SOURCE_SOFT
+    IrqTopHalf_t TopHalf;
+    IrqBottomHalf_t BottomHalf;
+    void* Arg;
+    UBaseType_t Priority;
+    BaseType_t Core;                        //Core of the bottom half, 0, 1 or tskNO_AFFINITY
+    BaseType_t Shared;
+}IrqConfig_t;
+
+typedef struct
+{
+    uint32_t Interrupts;
+    uint32_t Events;
+    uint32_t Runs;                          //Bottom half calls, below Events when events have been coalesced
+    uint64_t TopCycles;
+    uint32_t TopMax;
+    uint64_t LatencyUs;
+    uint32_t LatencyMax;
+}IrqStats_t;
+
+struct IrqThread;
+
+typedef struct
+{
+    IrqConfig_t Config;
+    struct IrqThread* Thread;
+    uint32_t Slot;                          //Notification bit on the thread
+    uint32_t SoftBit;
+    intr_handle_t Handle;
+    volatile uint32_t Pending;
+    volatile int64_t RaisedAt;              //Time of the first pending event
+    portMUX_TYPE Lock;
+    IrqStats_t Stats;
+}Irq_t;
+
+typedef struct IrqThread
+{
+    TaskHandle_t Task;
+    UBaseType_t Priority;
+    BaseType_t Core;
+    BaseType_t Shared;
+    uint32_t Count;
+    Irq_t* Irqs[IRQ_THREAD_SLOTS];
+}IrqThread_t;
+
+static Irq_t Irq_Table[IRQ_MAX];
+static uint32_t Irq_Count;
+static IrqThread_t Irq_Threads[IRQ_MAX_THREADS];
+static uint32_t Irq_ThreadCount;
+static Irq_t* Irq_Soft[32];
+static uint32_t Irq_SoftCount;
+static volatile uint32_t Irq_SoftPending;
+static BaseType_t Irq_SoftCore;
+static portMUX_TYPE Irq_RegistryLock = portMUX_INITIALIZER_UNLOCKED;
+
+/*---------------------------------------------- Threaded interrupts ----------------------------------------------*/
+
+/*Top half of one interrupt, the caller yields once for all of them*/
+static void ThreadedIrq_Handle(Irq_t* Irq, BaseType_t* pxHigherPriorityTaskWoken)
+{
+    uint32_t Start = XTHAL_GET_CCOUNT(), Events, Cycles;
+
+    Events = Irq->Config.TopHalf(Irq->Config.Arg);
+
+    if(Events != 0)
+    {
+        //The time of a new batch is stored before its events can be seen by the bottom half
+        if(__atomic_load_n(&Irq->Pending,__ATOMIC_ACQUIRE) == 0)
+        {
+            Irq->RaisedAt = esp_timer_get_time();
+        }
+
+        //Only the first event of a batch notifies, the others are added to the count the bottom half collects
+        if(__atomic_fetch_add(&Irq->Pending,Events,__ATOMIC_ACQ_REL) == 0)
+        {
+            xTaskNotifyFromISR(Irq->Thread->Task,1UL << Irq->Slot,eSetBits,pxHigherPriorityTaskWoken);
+        }
+    }
+
+    Cycles = XTHAL_GET_CCOUNT() - Start;
+
+    portENTER_CRITICAL_ISR(&Irq->Lock);
+    Irq->Stats.Interrupts++;
+    Irq->Stats.TopCycles += Cycles;
+    Irq->Stats.TopMax = (Cycles > Irq->Stats.TopMax) ? Cycles : Irq->Stats.TopMax;
+    portEXIT_CRITICAL_ISR(&Irq->Lock);
+}
+
+static void ThreadedIrq_Isr(void* arg)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    ThreadedIrq_Handle((Irq_t*)arg,&xHigherPriorityTaskWoken);
+
+    portYIELD_FROM_ISR();
+}
+
+/*The software interrupt behind all the soft sources*/
+static void ThreadedIrq_SoftIsr(void* arg)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    uint32_t Pending, Bit;
+
+    xt_set_intclear(1 << SW_ISR_LEVEL_3);
+
+    Pending = __atomic_exchange_n(&Irq_SoftPending,0,__ATOMIC_ACQ_REL);
+
+    while(Pending != 0)
+    {
+        Bit = __builtin_ctz(Pending);
+        Pending &= Pending - 1;
+        ThreadedIrq_Handle(Irq_Soft[Bit],&xHigherPriorityTaskWoken);
+    }
+
+    portYIELD_FROM_ISR();
+}
+
+static void ThreadedIrq_Run(Irq_t* Irq)
+{
+    int64_t RaisedAt = Irq->RaisedAt;
+    uint32_t Events, Latency;
+
+    Events = __atomic_exchange_n(&Irq->Pending,0,__ATOMIC_ACQ_REL);
+
+    if(Events == 0)
+    {
+        return;
+    }
+
+    Latency = (uint32_t)(esp_timer_get_time() - RaisedAt);
+
+    portENTER_CRITICAL(&Irq->Lock);
+    Irq->Stats.Events += Events;
+    Irq->Stats.Runs++;
+    Irq->Stats.LatencyUs += Latency;
+    Irq->Stats.LatencyMax = (Latency > Irq->Stats.LatencyMax) ? Latency : Irq->Stats.LatencyMax;
+    portEXIT_CRITICAL(&Irq->Lock);
+
+    Irq->Config.BottomHalf(Irq->Config.Arg,Events);
+}
+
+static void IrqThread_Task(void* pvParameters)
+{
+    IrqThread_t* Thread = (IrqThread_t*)pvParameters;
+    uint32_t Bits, Slot;
+
+    for(;;)
+    {
+        xTaskNotifyWait(0,UINT32_MAX,&Bits,portMAX_DELAY);
+
+        //Lower slots first, the order of registration on a shared thread is its priority order
+        while(Bits != 0)
+        {
+            Slot = __builtin_ctz(Bits);
+            Bits &= Bits - 1;
+
+            if(Slot < Thread->Count)
+            {
+                ThreadedIrq_Run(Thread->Irqs[Slot]);
+            }
+        }
+    }
+}
+
+/*A shared thread with the same priority and core is reused, a dedicated thread is always new*/
+static IrqThread_t* ThreadedIrq_GetThread(const IrqConfig_t* Config)
+{
+    IrqThread_t* Thread;
+    uint32_t Loop;
+    char Name[configMAX_TASK_NAME_LEN];
+
+    if(Config->Shared == pdTRUE)
+    {
+        for(Loop = 0; Loop < Irq_ThreadCount; Loop++)
+        {
+            Thread = &Irq_Threads[Loop];
+
+            if((Thread->Shared == pdTRUE) && (Thread->Priority == Config->Priority) && (Thread->Core == Config->Core) &&
+               (Thread->Count < IRQ_THREAD_SLOTS))
+            {
+                return Thread;
+            }
+        }
+    }
+
+    if(Irq_ThreadCount == IRQ_MAX_THREADS)
+    {
+        return NULL;
+    }
+
+    Thread = &Irq_Threads[Irq_ThreadCount];
+    Thread->Priority = Config->Priority;
+    Thread->Core = Config->Core;
+    Thread->Shared = Config->Shared;
+    Thread->Count = 0;
+
+    if(Config->Shared == pdTRUE)
+    {
+        snprintf(Name,sizeof(Name),"irq/shared-%u",Config->Priority);
+    }
+    else
+    {
+        snprintf(Name,sizeof(Name),"irq/%s",Config->Name);
+    }
+
+    if(xTaskCreatePinnedToCore(IrqThread_Task,Name,IRQ_THREAD_STACK,Thread,Config->Priority,&Thread->Task,Config->Core) !=
+       pdPASS)
+    {
+        return NULL;
+    }
+
+    Irq_ThreadCount++;
+
+    return Thread;
+}
+
+static Irq_t* ThreadedIrq_Register(const IrqConfig_t* Config)
+{
+    Irq_t* Irq;
+    IrqThread_t* Thread;
+
+    if((Irq_Count == IRQ_MAX) || (Config->TopHalf == NULL) || (Config->BottomHalf == NULL) ||
+       ((Config->Source == IRQ_SOURCE_SOFT) && (Irq_SoftCount == 32)))
+    {
+        return NULL;
+    }
+
+    Thread = ThreadedIrq_GetThread(Config);
+
+    if(Thread == NULL)
+    {
+        return NULL;
+    }
+
+    Irq = &Irq_Table[Irq_Count];
+    memset(Irq,0,sizeof(Irq_t));
+    Irq->Config = *Config;
+    vPortCPUInitializeMutex(&Irq->Lock);
+    Irq->Thread = Thread;
+    Irq->Slot = Thread->Count;
+
+    //The thread and the tables are complete before the interrupt can fire
+    portENTER_CRITICAL(&Irq_RegistryLock);
+    Thread->Irqs[Thread->Count++] = Irq;
+    Irq_Count++;
+
+    if(Config->Source == IRQ_SOURCE_SOFT)
+    {
+        Irq->SoftBit = Irq_SoftCount;
+        Irq_Soft[Irq_SoftCount++] = Irq;
+    }
+
+    portEXIT_CRITICAL(&Irq_RegistryLock);
+
+    if(Config->Source == IRQ_SOURCE_SOFT)
+    {
+        if(Irq->SoftBit == 0)
+        {
+            Irq_SoftCore = xPortGetCoreID();
+            esp_intr_alloc(ETS_INTERNAL_SW1_INTR_SOURCE,0,ThreadedIrq_SoftIsr,NULL,NULL);
+        }
+    }
+    else if(esp_intr_alloc(Config->Source,0,ThreadedIrq_Isr,Irq,&Irq->Handle) != ESP_OK)
+    {
+        ESP_LOGE(RTOS,"Interrupt %s could not be allocated.\r\n",Config->Name);
+        return NULL;
+    }
+
+    return Irq;
+}
+
+/*Raises a soft source, from a task or from an interrupt on the core which registered the soft sources*/
+static void ThreadedIrq_Raise(Irq_t* Irq)
+{
+    configASSERT(xPortGetCoreID() == Irq_SoftCore);
+
+    __atomic_or_fetch(&Irq_SoftPending,1UL << Irq->SoftBit,__ATOMIC_RELEASE);
+    xt_set_intset(1 << SW_ISR_LEVEL_3);
+}
+
+static void ThreadedIrq_GetStats(Irq_t* Irq, IrqStats_t* Stats)
+{
+    portENTER_CRITICAL(&Irq->Lock);
+    *Stats = Irq->Stats;
+    portEXIT_CRITICAL(&Irq->Lock);
+}
+
+static void ThreadedIrq_PrintStats(void)
+{
+    IrqStats_t Stats;
+    uint32_t Loop;
+
+    printf("%-8s %-16s %8s %8s %8s %8s %8s %10s %10s\r\n","Irq","Thread","Irqs","Events","Runs","TopAvg","TopMax",
+           "LatAvgUs","LatMaxUs");
+
+    for(Loop = 0; Loop < Irq_Count; Loop++)
+    {
+        ThreadedIrq_GetStats(&Irq_Table[Loop],&Stats);
+
+        printf("%-8s %-16s %8u %8u %8u %8llu %8u %10llu %10u\r\n",Irq_Table[Loop].Config.Name,
+               pcTaskGetTaskName(Irq_Table[Loop].Thread->Task),Stats.Interrupts,Stats.Events,Stats.Runs,
+               (Stats.Interrupts != 0) ? (Stats.TopCycles / Stats.Interrupts) : 0,Stats.TopMax,
+               (Stats.Runs != 0) ? (Stats.LatencyUs / Stats.Runs) : 0,Stats.LatencyMax);
+    }
+
+    printf("\r\n");
+}
+
+/*---------------------------------------------- Examples 16, 17, 24 and 25 ----------------------------------------------*/
+
+typedef struct
+{
+    const char* Text;
+    uint32_t Events;                        //Gives of the original interrupt handler
+}ExampleIrq_t;
+
+static const ExampleIrq_t Ex16 = {"Handler Function is executing after taking semaphore!!!!",1};
+static const ExampleIrq_t Ex17 = {"Handler Function is executing after taking counting semaphore!!!!",6};
+static const ExampleIrq_t Ex24 = {"Handler Function is executing after receiving task notification!!!!",1};
+static const ExampleIrq_t Ex25 = {"Handler Function is executing after receiving counted notification!!!!",4};
+
+static uint32_t Example_TopHalf(void* Arg)
+{
+    //A soft source has nothing to clear, a hardware source acknowledges its peripheral here
+    return ((const ExampleIrq_t*)Arg)->Events;
+}
+
+static void Example_BottomHalf(void* Arg, uint32_t Events)
+{
+    const ExampleIrq_t* Example = (const ExampleIrq_t*)Arg;
+
+    while(Events--)
+    {
+        printf("%s\r\n",Example->Text);
+    }
+}
+
+static const IrqConfig_t Example_Irqs[] =
+{
+    {.Name = "Ex16", .Source = IRQ_SOURCE_SOFT, .TopHalf = Example_TopHalf, .BottomHalf = Example_BottomHalf,
+     .Arg = (void*)&Ex16, .Priority = 3, .Core = tskNO_AFFINITY, .Shared = pdFALSE},
+    {.Name = "Ex17", .Source = IRQ_SOURCE_SOFT, .TopHalf = Example_TopHalf, .BottomHalf = Example_BottomHalf,
+     .Arg = (void*)&Ex17, .Priority = 3, .Core = tskNO_AFFINITY, .Shared = pdFALSE},
+    {.Name = "Ex24", .Source = IRQ_SOURCE_SOFT, .TopHalf = Example_TopHalf, .BottomHalf = Example_BottomHalf,
+     .Arg = (void*)&Ex24, .Priority = 2, .Core = tskNO_AFFINITY, .Shared = pdTRUE},
+    {.Name = "Ex25", .Source = IRQ_SOURCE_SOFT, .TopHalf = Example_TopHalf, .BottomHalf = Example_BottomHalf,
+     .Arg = (void*)&Ex25, .Priority = 2, .Core = tskNO_AFFINITY, .Shared = pdTRUE},
+};
+
+#define EXAMPLE_IRQS            (sizeof(Example_Irqs) / sizeof(IrqConfig_t))
+
+static Irq_t* Example_Handles[EXAMPLE_IRQS];
+
+static void Periodic_Function(void* pvParameters)
+{
+    uint32_t Loop, Round = 0;
+
+    for(;;)
+    {
+        vTaskDelay(pdMS_TO_TICKS(500));
+
+        printf("About to generate the interrupt........\r\n");
+
+        for(Loop = 0; Loop < EXAMPLE_IRQS; Loop++)
+        {
+            ThreadedIrq_Raise(Example_Handles[Loop]);
+        }
+
+        printf("Interrupt generated......!!!!!\r\n\r\n");
+
+        if((++Round % 20) == 0)
+        {
+            ThreadedIrq_PrintStats();
+        }
+    }
+}
+
+void app_main(void)
+{
+    uint32_t Loop;
+
+    for(Loop = 0; Loop < EXAMPLE_IRQS; Loop++)
+    {
+        Example_Handles[Loop] = ThreadedIrq_Register(&Example_Irqs[Loop]);
+
+        if(Example_Handles[Loop] == NULL)
+        {
+            ESP_LOGE(RTOS,"%s could not be registered.\r\n",Example_Irqs[Loop].Name);
+            return;
+        }
+    }
+
+    //On the core of app_main, which registered the soft sources
+    xTaskCreatePinnedToCore(Periodic_Function,"Periodic",2048,NULL,1,NULL,xPortGetCoreID());
+}
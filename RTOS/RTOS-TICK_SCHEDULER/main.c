@@ -0,0 +1,400 @@
+/**
+ * @file main.c
+ * @author Tushar Uttekar
+ *
+ * @brief
+ *
+ * This example demonstrates a light weight scheduler of callbacks which runs in the tick hook, for the small periodic actions
+ * which are too small to have a task or a software timer of their own.
+ *
+ * In example 21 a periodic action of 200 ticks was made by counting the ticks inside vApplicationTickHook. When there are dozens
+ * of such actions a task for each costs a stack and a software timer for each costs a command and a callback in the daemon task.
+ *
+ * Here every action is registered with a period and a phase (the tick offset of its first run) and the scheduler keeps them in a
+ * timing wheel of TICK_WHEEL_SIZE slots indexed by the tick of their next run:
+ * ->On every tick only the slot of the current tick is visited, so the work per tick depends on the number of entries which are
+ *   due and not on the number of registered entries. Entries with a period longer than the wheel keep a count of the remaining
+ *   rounds and are skipped until it reaches zero.
+ * ->Every tick has a strict budget of TICK_BUDGET_US, once it is used up the remaining due entries are moved to the next tick and
+ *   counted as deferred, and the tick is counted as an overrun tick.
+ * ->Registration and removal are done from the tasks under the same spinlock which is used by the tick hook.
+ *
+ * The callbacks run in the tick interrupt, so only ISR safe API's can be used from them and they must be kept short.
+ *
+ * NOTE : The tick hook is registered with esp_register_freertos_tick_hook_for_cpu on core 0 instead of defining
+ *        vApplicationTickHook, as ESP32 uses its own implementation of the tick hook function.
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_freertos_hooks.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "esp_system.h"
+
+#define RTOS                    "freertos"
+#define TICK_MAX_ENTRIES        64
+#define TICK_WHEEL_SIZE         128
+#define TICK_WHEEL_MASK         (TICK_WHEEL_SIZE - 1)
+#define TICK_BUDGET_US          50
+#define TICK_INVALID            (-1)
+#define STATS_PERIOD            (pdMS_TO_TICKS(5000))
+
+typedef void (*TickCallback_t)(void* Arg);
+typedef int32_t TickEntryHandle_t;
+
+typedef struct TickEntry
+{
+    struct TickEntry* Next;
+    struct TickEntry* Prev;
+    TickCallback_t Callback;
+    void* Arg;
+    const char* Name;
+    uint32_t Period;
+    uint32_t Rounds;
+    uint32_t Slot;
+    BaseType_t InUse;
+    uint32_t Runs;
+    uint32_t Deferred;
+    uint32_t MaxUs;
+}TickEntry_t;
+
+typedef struct
+{
+    uint32_t Ticks;
+    uint32_t Dispatched;
+    uint32_t Deferred;
+    uint32_t OverrunTicks;
+    uint32_t MaxTickUs;
+}TickSchedulerStats_t;
+
+static TickEntry_t Tick_Entries[TICK_MAX_ENTRIES];
+static TickEntry_t* Tick_Wheel[TICK_WHEEL_SIZE];
+static uint32_t Tick_Now = 0;
+static TickSchedulerStats_t Tick_Stats;
+static portMUX_TYPE Tick_Lock = portMUX_INITIALIZER_UNLOCKED;
+
+/*---------------------------------------------- Tick scheduler ----------------------------------------------*/
+
+/*Places the entry in the slot of the tick it is going to run next, called with the lock taken*/
+static void TickScheduler_Insert(TickEntry_t* Entry, uint32_t Delay)
+{
+    uint32_t Slot;
+
+    Slot = (Tick_Now + Delay) & TICK_WHEEL_MASK;
+
+    //A delay of a whole wheel or more has to pass the slot that many times before it is due
+    Entry->Rounds = (Delay - 1) / TICK_WHEEL_SIZE;
+    Entry->Slot = Slot;
+
+    Entry->Prev = NULL;
+    Entry->Next = Tick_Wheel[Slot];
+    if(Entry->Next != NULL)
+    {
+        Entry->Next->Prev = Entry;
+    }
+    Tick_Wheel[Slot] = Entry;
+}
+
+static void TickScheduler_Unlink(TickEntry_t* Entry)
+{
+    if(Entry->Prev != NULL)
+    {
+        Entry->Prev->Next = Entry->Next;
+    }
+    else
+    {
+        Tick_Wheel[Entry->Slot] = Entry->Next;
+    }
+
+    if(Entry->Next != NULL)
+    {
+        Entry->Next->Prev = Entry->Prev;
+    }
+}
+
+/**
+ * Registers a callback which runs every Period ticks, the first run is Phase ticks from now (a phase of zero means one period
+ * from now). Returns the handle of the entry or TICK_INVALID when the table is full.
+ */
+TickEntryHandle_t TickScheduler_Register(const char* Name, TickCallback_t Callback, void* Arg, uint32_t Period, uint32_t Phase)
+{
+    TickEntryHandle_t Handle;
+    TickEntry_t* Entry;
+
+    if((Callback == NULL) || (Period == 0))
+    {
+        return TICK_INVALID;
+    }
+
+    portENTER_CRITICAL(&Tick_Lock);
+
+    for(Handle = 0; Handle < TICK_MAX_ENTRIES; Handle++)
+    {
+        if(Tick_Entries[Handle].InUse == pdFALSE)
+        {
+            break;
+        }
+    }
+
+    if(Handle < TICK_MAX_ENTRIES)
+    {
+        Entry = &Tick_Entries[Handle];
+        memset(Entry,0,sizeof(TickEntry_t));
+
+        Entry->Callback = Callback;
+        Entry->Arg = Arg;
+        Entry->Name = Name;
+        Entry->Period = Period;
+        Entry->InUse = pdTRUE;
+
+        TickScheduler_Insert(Entry,(Phase != 0) ? Phase : Period);
+    }
+    else
+    {
+        Handle = TICK_INVALID;
+    }
+
+    portEXIT_CRITICAL(&Tick_Lock);
+
+    return Handle;
+}
+
+/*Once this returns the callback will not be called again, as the tick hook runs the callbacks with the same lock taken*/
+BaseType_t TickScheduler_Remove(TickEntryHandle_t Handle)
+{
+    BaseType_t xStatus = pdFAIL;
+
+    if((Handle < 0) || (Handle >= TICK_MAX_ENTRIES))
+    {
+        return pdFAIL;
+    }
+
+    portENTER_CRITICAL(&Tick_Lock);
+
+    if(Tick_Entries[Handle].InUse == pdTRUE)
+    {
+        TickScheduler_Unlink(&Tick_Entries[Handle]);
+        Tick_Entries[Handle].InUse = pdFALSE;
+        xStatus = pdPASS;
+    }
+
+    portEXIT_CRITICAL(&Tick_Lock);
+
+    return xStatus;
+}
+
+static void TickScheduler_Hook(void)
+{
+    TickEntry_t *Entry, *Next;
+    int64_t Start, Now;
+    uint32_t Slot, Elapsed;
+    BaseType_t Overrun = pdFALSE;
+
+    portENTER_CRITICAL_ISR(&Tick_Lock);
+
+    Tick_Now++;
+    Tick_Stats.Ticks++;
+
+    Slot = Tick_Now & TICK_WHEEL_MASK;
+    Entry = Tick_Wheel[Slot];
+    Start = esp_timer_get_time();
+
+    while(Entry != NULL)
+    {
+        Next = Entry->Next;
+
+        //Entries which still have rounds to go are not due on this pass of the slot
+        if(Entry->Rounds != 0)
+        {
+            Entry->Rounds--;
+            Entry = Next;
+            continue;
+        }
+
+        TickScheduler_Unlink(Entry);
+
+        //Budget of the tick is used up, the entry runs on the next tick instead
+        if(Overrun == pdTRUE)
+        {
+            Entry->Deferred++;
+            Tick_Stats.Deferred++;
+            TickScheduler_Insert(Entry,1);
+            Entry = Next;
+            continue;
+        }
+
+        Now = esp_timer_get_time();
+        Entry->Callback(Entry->Arg);
+        Elapsed = (uint32_t)(esp_timer_get_time() - Now);
+
+        Entry->Runs++;
+        if(Elapsed > Entry->MaxUs)
+        {
+            Entry->MaxUs = Elapsed;
+        }
+        Tick_Stats.Dispatched++;
+
+        TickScheduler_Insert(Entry,Entry->Period);
+
+        if((esp_timer_get_time() - Start) > TICK_BUDGET_US)
+        {
+            Overrun = pdTRUE;
+        }
+
+        Entry = Next;
+    }
+
+    Elapsed = (uint32_t)(esp_timer_get_time() - Start);
+    if(Elapsed > Tick_Stats.MaxTickUs)
+    {
+        Tick_Stats.MaxTickUs = Elapsed;
+    }
+
+    if(Overrun == pdTRUE)
+    {
+        Tick_Stats.OverrunTicks++;
+    }
+
+    portEXIT_CRITICAL_ISR(&Tick_Lock);
+}
+
+void TickScheduler_Start(void)
+{
+    //Tick hook on core 0 only, so that every tick is counted once
+    esp_register_freertos_tick_hook_for_cpu(TickScheduler_Hook,0);
+}
+
+static void TickScheduler_Report(void)
+{
+    TickSchedulerStats_t Stats;
+    TickEntry_t Entry;
+    UBaseType_t Index;
+
+    portENTER_CRITICAL(&Tick_Lock);
+    Stats = Tick_Stats;
+    portEXIT_CRITICAL(&Tick_Lock);
+
+    printf("tick scheduler: ticks %u dispatched %u deferred %u overrun ticks %u max tick %u us\r\n",
+           Stats.Ticks,Stats.Dispatched,Stats.Deferred,Stats.OverrunTicks,Stats.MaxTickUs);
+
+    for(Index = 0; Index < TICK_MAX_ENTRIES; Index++)
+    {
+        portENTER_CRITICAL(&Tick_Lock);
+        Entry = Tick_Entries[Index];
+        portEXIT_CRITICAL(&Tick_Lock);
+
+        //Only the named entries are printed to keep the dump compact
+        if((Entry.InUse == pdTRUE) && (Entry.Name != NULL))
+        {
+            printf("  %-12s period %5u runs %7u deferred %5u max %4u us\r\n",Entry.Name,Entry.Period,Entry.Runs,
+                   Entry.Deferred,Entry.MaxUs);
+        }
+    }
+}
+
+/*---------------------------------------------- Example actions ----------------------------------------------*/
+
+const char* strings[] = {"Task printing the string message through the gatekeeper task\r\n",
+                         "Tick scheduler printing the string message through the gatekeeper task\r\n"
+                         };
+QueueHandle_t GateKeeper_Queue;
+static volatile uint32_t Counters[48];
+
+/*Replaces the hand counted 200 tick action of the tick hook in example 21*/
+static void GateKeeper_Action(void* Arg)
+{
+    xQueueSendToFrontFromISR(GateKeeper_Queue,&strings[1],NULL);
+}
+
+/*Tiny periodic action like a debounce or a watchdog counter*/
+static void Counter_Action(void* Arg)
+{
+    (*(volatile uint32_t*)Arg)++;
+}
+
+/*Heavier action which eats the budget of the tick it runs in*/
+static void Heavy_Action(void* Arg)
+{
+    int64_t Start;
+
+    Start = esp_timer_get_time();
+    while((esp_timer_get_time() - Start) < (TICK_BUDGET_US + 10))
+    {
+        //Busy working for longer than the tick budget
+    }
+}
+
+static void GateKeeper_Task(void* pvParameters)
+{
+    char* print_string;
+
+    for(;;)
+    {
+        xQueueReceive(GateKeeper_Queue,&print_string,portMAX_DELAY);
+        printf("%s",print_string);
+    }
+}
+
+static void Print_Task(void* pvParameters)
+{
+    char* string;
+
+    string = (char*) pvParameters;
+
+    for(;;)
+    {
+        xQueueSendToBack(GateKeeper_Queue,&string,0);
+        vTaskDelay(pdMS_TO_TICKS(500));
+    }
+}
+
+static void Stats_Task(void* pvParameters)
+{
+    TickEntryHandle_t Temporary;
+
+    for(;;)
+    {
+        //Registering and removing an entry from a task while the tick hook is running
+        Temporary = TickScheduler_Register("Temporary",Counter_Action,(void*)&Counters[0],3,1);
+        vTaskDelay(STATS_PERIOD);
+        TickScheduler_Remove(Temporary);
+
+        TickScheduler_Report();
+    }
+}
+
+void app_main(void)
+{
+    uint32_t Index;
+
+    GateKeeper_Queue = xQueueCreate(5,sizeof(char*));
+
+    if(GateKeeper_Queue != NULL)
+    {
+        TickScheduler_Register("GateKeeper",GateKeeper_Action,NULL,200,200);
+
+        //Many tiny actions with different periods and phases spread over the ticks
+        for(Index = 1; Index < (sizeof(Counters) / sizeof(Counters[0])); Index++)
+        {
+            TickScheduler_Register(NULL,Counter_Action,(void*)&Counters[Index],((Index % 7) + 1) * 5,Index);
+        }
+
+        //Long period which is more than the size of the wheel
+        TickScheduler_Register("Heavy",Heavy_Action,NULL,(TICK_WHEEL_SIZE * 3) + 7,1);
+
+        TickScheduler_Start();
+
+        xTaskCreate(GateKeeper_Task,"GateKeeper",2048,NULL,1,NULL);
+        xTaskCreate(Print_Task,"Print",2048,(void*)strings[0],1,NULL);
+        xTaskCreate(Stats_Task,"Stats",3072,NULL,2,NULL);
+    }
+}
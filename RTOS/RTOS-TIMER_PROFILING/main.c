@@ -0,0 +1,402 @@
+/**
+ * @file main.c
+ * @author Tushar Uttekar
+ *
+ * @brief
+ *
+ * This example demonstrates how the callback routines of the software timers can be profiled to find out which callback is
+ * delaying the other timers.
+ *
+ * All the timer callbacks are executed one after the other by the timer daemon task, so a single slow callback (for example
+ * the BacklightCallBack of example 15 doing more work) delays every other timer and nothing reports it.
+ *
+ * The timers are created with ProfiledTimer_Create which places a common dispatch routine as the callback of the timer and calls
+ * the actual callback from it. For every timer the dispatch routine records:
+ * ->The execution time of the callback (last, average and maximum).
+ * ->The lateness, which is the time between the expiry of the timer and the start of its callback.
+ * ->The number of missed periods for the auto reload timers, when the callback was so late that a whole period was skipped.
+ * ->The number of times the callback took longer than its budget, in which case the overrun hook is called as well. The hook can
+ *   be replaced with Profiler_SetOverrunHook.
+ *
+ * The command queue of the daemon task is not accessible from the application, so its delay is measured with a probe function
+ * which is pended through xTimerPendFunctionCall at a fixed interval. The time taken by the probe to reach the daemon grows with
+ * the number of commands waiting ahead of it in the command queue.
+ *
+ * The timers of example 13, 14, 15 and the time period change example are recreated here along with a deliberately slow timer
+ * whose callback exceeds its budget and shows up as the cause of the lateness of the other timers.
+ *
+ * NOTE : The timer ID is used by the profiler for finding the statistics of the timer, the application can use
+ *        ProfiledTimer_GetUserID instead of pvTimerGetTimerID for its own timer specific storage.
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/timers.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "esp_system.h"
+
+#define RTOS                    "freertos"
+#define PROFILER_MAX_TIMERS     8
+#define PROBE_PERIOD            (pdMS_TO_TICKS(50))
+#define REPORT_PERIOD           (pdMS_TO_TICKS(5000))
+
+#define ONE_SHOT_TIMER_PERIOD   (pdMS_TO_TICKS(3000))
+#define PERIODIC_TIMER_PERIOD   (pdMS_TO_TICKS(500))
+#define BACKLIGHT_TIMER_PERIOD  (pdMS_TO_TICKS(3000))
+#define SLOW_TIMER_PERIOD       (pdMS_TO_TICKS(40))
+
+typedef struct ProfiledTimer ProfiledTimer_t;
+typedef void (*OverrunHook_t)(const ProfiledTimer_t* Timer, uint32_t DurationUs);
+
+/*Profiling data of one software timer*/
+struct ProfiledTimer
+{
+    TimerHandle_t Handle;
+    TimerCallbackFunction_t Callback;
+    void* UserID;
+    UBaseType_t AutoReload;
+    uint32_t BudgetUs;
+    uint32_t Calls;
+    uint32_t LastUs;
+    uint32_t MaxUs;
+    uint64_t TotalUs;
+    TickType_t LastLateness;
+    TickType_t MaxLateness;
+    uint32_t MissedPeriods;
+    uint32_t Overruns;
+};
+
+/*Delay of the daemon command queue measured through the probe*/
+typedef struct
+{
+    uint32_t Probes;
+    uint32_t LastDelayUs;
+    uint32_t MaxDelayUs;
+    uint32_t PendFailures;
+}DaemonStats_t;
+
+static ProfiledTimer_t Profiler_Timers[PROFILER_MAX_TIMERS];
+static UBaseType_t Profiler_Count = 0;
+static DaemonStats_t Profiler_Daemon;
+static portMUX_TYPE Profiler_Lock = portMUX_INITIALIZER_UNLOCKED;
+
+static void Profiler_DefaultOverrunHook(const ProfiledTimer_t* Timer, uint32_t DurationUs)
+{
+    ESP_LOGW(RTOS,"Timer %s callback took %u us, budget is %u us\r\n",pcTimerGetName(Timer->Handle),DurationUs,Timer->BudgetUs);
+}
+
+static OverrunHook_t Profiler_OverrunHook = Profiler_DefaultOverrunHook;
+
+/*---------------------------------------------- Timer profiler ----------------------------------------------*/
+
+void Profiler_SetOverrunHook(OverrunHook_t Hook)
+{
+    Profiler_OverrunHook = (Hook != NULL) ? Hook : Profiler_DefaultOverrunHook;
+}
+
+/*Common callback of all the profiled timers which measures the actual callback of the timer*/
+static void Profiler_Dispatch(TimerHandle_t Timer)
+{
+    ProfiledTimer_t* Profiled;
+    TickType_t Now, Expiry, Period;
+    int64_t Start;
+    uint32_t Duration;
+
+    Profiled = (ProfiledTimer_t*) pvTimerGetTimerID(Timer);
+    Now = xTaskGetTickCount();
+    Period = xTimerGetPeriod(Timer);
+
+    //An auto reload timer is already reloaded by the daemon before its callback, so the expiry which fired is one period behind
+    Expiry = xTimerGetExpiryTime(Timer);
+    if(Profiled->AutoReload == pdTRUE)
+    {
+        Expiry -= Period;
+    }
+
+    Start = esp_timer_get_time();
+    Profiled->Callback(Timer);
+    Duration = (uint32_t)(esp_timer_get_time() - Start);
+
+    portENTER_CRITICAL(&Profiler_Lock);
+
+    Profiled->Calls++;
+    Profiled->LastUs = Duration;
+    Profiled->TotalUs += Duration;
+    if(Duration > Profiled->MaxUs)
+    {
+        Profiled->MaxUs = Duration;
+    }
+
+    Profiled->LastLateness = Now - Expiry;
+    if(Profiled->LastLateness > Profiled->MaxLateness)
+    {
+        Profiled->MaxLateness = Profiled->LastLateness;
+    }
+
+    //An auto reload timer dispatched a whole period or more after its expiry has skipped those periods
+    if((Profiled->AutoReload == pdTRUE) && (Period != 0))
+    {
+        Profiled->MissedPeriods += (Profiled->LastLateness / Period);
+    }
+
+    if((Profiled->BudgetUs != 0) && (Duration > Profiled->BudgetUs))
+    {
+        Profiled->Overruns++;
+    }
+
+    portEXIT_CRITICAL(&Profiler_Lock);
+
+    if((Profiled->BudgetUs != 0) && (Duration > Profiled->BudgetUs))
+    {
+        Profiler_OverrunHook(Profiled,Duration);
+    }
+}
+
+/**
+ * Creates a software timer whose callback is profiled, BudgetUs is the allowed execution time of the callback in microseconds
+ * and zero disables the overrun check for the timer.
+ */
+TimerHandle_t ProfiledTimer_Create(const char* Name, TickType_t Period, UBaseType_t AutoReload, void* UserID,
+                                   uint32_t BudgetUs, TimerCallbackFunction_t Callback)
+{
+    ProfiledTimer_t* Profiled = NULL;
+    TimerHandle_t Handle;
+    UBaseType_t Index;
+
+    if(Callback == NULL)
+    {
+        return NULL;
+    }
+
+    portENTER_CRITICAL(&Profiler_Lock);
+
+    //A slot is claimed by its callback, slots released by a failed create are used again first
+    for(Index = 0; Index < Profiler_Count; Index++)
+    {
+        if(Profiler_Timers[Index].Callback == NULL)
+        {
+            Profiled = &Profiler_Timers[Index];
+            break;
+        }
+    }
+
+    if((Profiled == NULL) && (Profiler_Count < PROFILER_MAX_TIMERS))
+    {
+        Profiled = &Profiler_Timers[Profiler_Count];
+        Profiler_Count++;
+    }
+
+    if(Profiled != NULL)
+    {
+        memset(Profiled,0,sizeof(ProfiledTimer_t));
+        Profiled->Callback = Callback;
+    }
+
+    portEXIT_CRITICAL(&Profiler_Lock);
+
+    if(Profiled == NULL)
+    {
+        return NULL;
+    }
+
+    Profiled->UserID = UserID;
+    Profiled->AutoReload = AutoReload;
+    Profiled->BudgetUs = BudgetUs;
+    Handle = xTimerCreate(Name,Period,AutoReload,Profiled,Profiler_Dispatch);
+
+    portENTER_CRITICAL(&Profiler_Lock);
+
+    //Without a timer the slot is released again
+    Profiled->Handle = Handle;
+    if(Handle == NULL)
+    {
+        Profiled->Callback = NULL;
+    }
+
+    portEXIT_CRITICAL(&Profiler_Lock);
+
+    return Handle;
+}
+
+void* ProfiledTimer_GetUserID(TimerHandle_t Timer)
+{
+    return ((ProfiledTimer_t*) pvTimerGetTimerID(Timer))->UserID;
+}
+
+void ProfiledTimer_SetUserID(TimerHandle_t Timer, void* UserID)
+{
+    ((ProfiledTimer_t*) pvTimerGetTimerID(Timer))->UserID = UserID;
+}
+
+BaseType_t ProfiledTimer_GetStats(TimerHandle_t Timer, ProfiledTimer_t* Stats)
+{
+    portENTER_CRITICAL(&Profiler_Lock);
+    *Stats = *((ProfiledTimer_t*) pvTimerGetTimerID(Timer));
+    portEXIT_CRITICAL(&Profiler_Lock);
+
+    return pdPASS;
+}
+
+/*Executed by the daemon task, the parameter carries the time at which the probe was pended*/
+static void Profiler_Probe(void* pvParameter1, uint32_t ulParameter2)
+{
+    uint32_t Delay;
+
+    Delay = (uint32_t) esp_timer_get_time() - ulParameter2;
+
+    portENTER_CRITICAL(&Profiler_Lock);
+
+    Profiler_Daemon.Probes++;
+    Profiler_Daemon.LastDelayUs = Delay;
+    if(Delay > Profiler_Daemon.MaxDelayUs)
+    {
+        Profiler_Daemon.MaxDelayUs = Delay;
+    }
+
+    portEXIT_CRITICAL(&Profiler_Lock);
+}
+
+static void Profiler_Report(void)
+{
+    ProfiledTimer_t Stats;
+    DaemonStats_t Daemon;
+    UBaseType_t Index;
+
+    printf("timer           calls  last-us  avg-us  max-us  late max-late missed overruns\r\n");
+
+    for(Index = 0; Index < Profiler_Count; Index++)
+    {
+        portENTER_CRITICAL(&Profiler_Lock);
+        Stats = Profiler_Timers[Index];
+        portEXIT_CRITICAL(&Profiler_Lock);
+
+        //Free slot or a timer which is still being created
+        if(Stats.Handle == NULL)
+        {
+            continue;
+        }
+
+        printf("%-14s %6u %8u %7u %7u %5u %8u %6u %8u\r\n",pcTimerGetName(Stats.Handle),Stats.Calls,Stats.LastUs,
+               (Stats.Calls != 0) ? (uint32_t)(Stats.TotalUs / Stats.Calls) : 0,Stats.MaxUs,Stats.LastLateness,
+               Stats.MaxLateness,Stats.MissedPeriods,Stats.Overruns);
+    }
+
+    portENTER_CRITICAL(&Profiler_Lock);
+    Daemon = Profiler_Daemon;
+    portEXIT_CRITICAL(&Profiler_Lock);
+
+    printf("daemon command queue delay: last %u us max %u us (probes %u, pend failures %u)\r\n",
+           Daemon.LastDelayUs,Daemon.MaxDelayUs,Daemon.Probes,Daemon.PendFailures);
+}
+
+static void Profiler_Task(void* pvParameters)
+{
+    TickType_t LastExecutionTime, LastReportTime;
+
+    LastExecutionTime = xTaskGetTickCount();
+    LastReportTime = LastExecutionTime;
+
+    for(;;)
+    {
+        vTaskDelayUntil(&LastExecutionTime,PROBE_PERIOD);
+
+        //The probe is not waited for, if the command queue is full it is counted as a failure
+        if(xTimerPendFunctionCall(Profiler_Probe,NULL,(uint32_t) esp_timer_get_time(),0) != pdPASS)
+        {
+            portENTER_CRITICAL(&Profiler_Lock);
+            Profiler_Daemon.PendFailures++;
+            portEXIT_CRITICAL(&Profiler_Lock);
+        }
+
+        if((xTaskGetTickCount() - LastReportTime) >= REPORT_PERIOD)
+        {
+            Profiler_Report();
+            LastReportTime = xTaskGetTickCount();
+        }
+    }
+}
+
+/*---------------------------------------------- Example timers ----------------------------------------------*/
+
+TimerHandle_t OneShot_Handle, Periodic_Handle, Backlight_Timer_Handle, Slow_Handle;
+
+static void OneShotCallBack(TimerHandle_t Timer)
+{
+    printf("One shot timer call back routine executing at time %d.\r\n",xTaskGetTickCount());
+}
+
+static void PeriodicCallBack(TimerHandle_t Timer)
+{
+    uint32_t Execution_Count;
+
+    //Timer specific storage is kept in the user ID as the timer ID belongs to the profiler
+    Execution_Count = (uint32_t) ProfiledTimer_GetUserID(Timer);
+    Execution_Count++;
+    ProfiledTimer_SetUserID(Timer,(void*)Execution_Count);
+
+    //Changing the time period after the timer has executed 10 times
+    if(Execution_Count == 10)
+    {
+        xTimerChangePeriod(Timer,(PERIODIC_TIMER_PERIOD / 2),0);
+    }
+}
+
+static void BacklightCallBack(TimerHandle_t Timer)
+{
+    ESP_LOGI(RTOS,"Timer has expired and is reloading..... at %d",xTaskGetTickCount());
+}
+
+/*Simulates a callback which does too much work in the daemon task*/
+static void SlowCallBack(TimerHandle_t Timer)
+{
+    int64_t Start;
+
+    Start = esp_timer_get_time();
+    while((esp_timer_get_time() - Start) < 15000)
+    {
+        //Busy working for 15ms
+    }
+}
+
+static void KeyPad_Task(void* pvParameters)
+{
+    for(;;)
+    {
+        //Resetting the backlight timer on every simulated key press, every reset is one more command for the daemon
+        xTimerReset(Backlight_Timer_Handle,pdMS_TO_TICKS(100));
+        vTaskDelay((rand() % 200) + 1);
+    }
+}
+
+void app_main(void)
+{
+    OneShot_Handle = ProfiledTimer_Create("OneShot",ONE_SHOT_TIMER_PERIOD,pdFALSE,NULL,1000,OneShotCallBack);
+    Periodic_Handle = ProfiledTimer_Create("Periodic",PERIODIC_TIMER_PERIOD,pdTRUE,(void*)0,500,PeriodicCallBack);
+    Backlight_Timer_Handle = ProfiledTimer_Create("Backlight",BACKLIGHT_TIMER_PERIOD,pdTRUE,NULL,2000,BacklightCallBack);
+    Slow_Handle = ProfiledTimer_Create("Slow",SLOW_TIMER_PERIOD,pdTRUE,NULL,5000,SlowCallBack);
+
+    //Validating whether timer's are created or not
+    if((OneShot_Handle != NULL) && (Periodic_Handle != NULL) && (Backlight_Timer_Handle != NULL) && (Slow_Handle != NULL))
+    {
+        xTimerStart(OneShot_Handle,0);
+        xTimerStart(Periodic_Handle,0);
+        xTimerStart(Backlight_Timer_Handle,0);
+        xTimerStart(Slow_Handle,0);
+
+        xTaskCreate(KeyPad_Task,"Keypad",2048,NULL,1,NULL);
+        xTaskCreate(Profiler_Task,"Profiler",3072,NULL,2,NULL);
+    }
+    else
+    {
+        ESP_LOGE(RTOS,"Unable to create the timers\r\n");
+    }
+}
@@ -0,0 +1,412 @@
+/**
+ * @file main.c
+ * @author Tushar Uttekar
+ *
+ * @brief
+ *
+ * This example demonstrates timer slack, delays and software timers which may wake a little later than asked so that the
+ * wake-ups of unrelated tasks and timers fall into the same tick. In example 12 the two senders wake every 100 and 200 ms with
+ * their own phases and the timers of example 13 and 14 expire on their own schedules, every separate tick with a wake-up costs a
+ * context switch and keeps the CPU from staying in light sleep.
+ *
+ * ->Slack_DelayUntil replaces the vTaskDelay of a periodic loop, Slack_Delay a single delay, both take the slack in ticks. The
+ *   wake-up can be anywhere from the nominal tick up to the nominal tick plus the slack.
+ * ->SlackTimer_t is a software timer with a slack, it is re-armed as a one shot timer at the tick picked for it on every expiry.
+ * ->The planner keeps the ticks on which a task or a timer is going to wake. A new wake-up joins the earliest planned tick inside
+ *   its window, that wake-up is saved. When there is none it is put on the coarsest power of two grid which fits into the slack,
+ *   so wake-ups which do not see each other still tend to meet on the same ticks.
+ * ->The nominal tick of a periodic delay or timer keeps moving by exactly one period, the slack adds latency but never drift.
+ * ->Slack_PrintStats prints the wake-ups asked for, the distinct ticks they have been put on, the wake-ups saved and the latency
+ *   added by the slack.
+ *
+ * NOTE : The kernel is not changed, the coalescing is done by picking the tick of the delay or the timer period. With tickless
+ *        idle (CONFIG_PM_ENABLE and CONFIG_FREERTOS_USE_TICKLESS_IDLE) the fewer distinct ticks turn into longer light sleeps.
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/timers.h"
+#include "esp_log.h"
+#include "esp_system.h"
+
+#define RTOS                    "FREERTOS"
+
+#define SLACK_MAX_WAKES         32          //Planned wake ticks which can be joined
+
+typedef struct
+{
+    TickType_t Tick;
+    uint32_t Users;
+}SlackWake_t;
+
+typedef struct
+{
+    uint32_t Requests;
+    uint32_t Joined;                        //Put on a tick which was planned already, one wake-up saved each
+    uint32_t Aligned;                       //Put on the grid
+    uint32_t Exact;                         //No slack
+    uint32_t Untracked;                     //Planner full, the wake-up can not be joined by others
+    uint64_t AddedTicks;
+    TickType_t AddedMax;
+}SlackStats_t;
+
+typedef struct SlackTimer
+{
+    TimerHandle_t Handle;
+    TickType_t Period;
+    TickType_t Slack;
+    TickType_t Nominal;
+    TickType_t Wake;
+    BaseType_t AutoReload;
+    volatile BaseType_t Active;
+    void (*Callback)(struct SlackTimer* Timer);
+    void* Arg;
+}SlackTimer_t;
+
+static SlackWake_t Slack_Wakes[SLACK_MAX_WAKES];
+static SlackStats_t Slack_Stats;
+static portMUX_TYPE Slack_Lock = portMUX_INITIALIZER_UNLOCKED;
+
+/*---------------------------------------------- Slack planner ----------------------------------------------*/
+
+/*Picks the tick of a wake-up which is due somewhere from Earliest to Earliest + Slack*/
+static TickType_t Slack_Plan(TickType_t Earliest, TickType_t Slack)
+{
+    TickType_t Now = xTaskGetTickCount(), Wake, Grid, Distance, Best = portMAX_DELAY;
+    SlackWake_t* Entry = NULL;
+    uint32_t Loop;
+
+    //A nominal tick which has passed already is due on the next tick
+    if((int32_t)(Earliest - Now) <= 0)
+    {
+        Earliest = Now + 1;
+    }
+
+    portENTER_CRITICAL(&Slack_Lock);
+
+    Slack_Stats.Requests++;
+
+    for(Loop = 0; (Loop < SLACK_MAX_WAKES) && (Slack != 0); Loop++)
+    {
+        Distance = Slack_Wakes[Loop].Tick - Earliest;
+
+        if((Slack_Wakes[Loop].Users != 0) && (Distance <= Slack) && (Distance < Best))
+        {
+            Best = Distance;
+            Entry = &Slack_Wakes[Loop];
+        }
+    }
+
+    if(Entry != NULL)
+    {
+        Wake = Entry->Tick;
+        Entry->Users++;
+        Slack_Stats.Joined++;
+    }
+    else
+    {
+        if(Slack == 0)
+        {
+            Wake = Earliest;
+            Slack_Stats.Exact++;
+        }
+        else
+        {
+            //Largest power of two not above Slack + 1, rounding up to it adds at most Slack ticks
+            Grid = 1UL << (31 - __builtin_clz(Slack + 1));
+            Wake = (Earliest + Grid - 1) & ~(Grid - 1);
+            Slack_Stats.Aligned++;
+        }
+
+        for(Loop = 0; (Loop < SLACK_MAX_WAKES) && (Slack_Wakes[Loop].Users != 0); Loop++);
+
+        if(Loop < SLACK_MAX_WAKES)
+        {
+            Slack_Wakes[Loop].Tick = Wake;
+            Slack_Wakes[Loop].Users = 1;
+        }
+        else
+        {
+            Slack_Stats.Untracked++;
+        }
+    }
+
+    Slack_Stats.AddedTicks += Wake - Earliest;
+    Slack_Stats.AddedMax = ((Wake - Earliest) > Slack_Stats.AddedMax) ? (Wake - Earliest) : Slack_Stats.AddedMax;
+
+    portEXIT_CRITICAL(&Slack_Lock);
+
+    return Wake;
+}
+
+/*The wake-up on Wake has happened, the tick can not be joined any more once its last user is gone*/
+static void Slack_Release(TickType_t Wake)
+{
+    uint32_t Loop;
+
+    portENTER_CRITICAL(&Slack_Lock);
+
+    for(Loop = 0; Loop < SLACK_MAX_WAKES; Loop++)
+    {
+        if((Slack_Wakes[Loop].Users != 0) && (Slack_Wakes[Loop].Tick == Wake))
+        {
+            Slack_Wakes[Loop].Users--;
+            break;
+        }
+    }
+
+    portEXIT_CRITICAL(&Slack_Lock);
+}
+
+static void Slack_SleepUntil(TickType_t Wake)
+{
+    TickType_t Now = xTaskGetTickCount();
+
+    //Delay until keeps the wake on the tick even when the task is preempted here
+    if((int32_t)(Wake - Now) > 0)
+    {
+        vTaskDelayUntil(&Now,Wake - Now);
+    }
+
+    Slack_Release(Wake);
+}
+
+/*Periodic delay, *Nominal moves by exactly one Period on every call*/
+static void Slack_DelayUntil(TickType_t* Nominal, TickType_t Period, TickType_t Slack)
+{
+    *Nominal += Period;
+    Slack_SleepUntil(Slack_Plan(*Nominal,Slack));
+}
+
+static void Slack_Delay(TickType_t Ticks, TickType_t Slack)
+{
+    Slack_SleepUntil(Slack_Plan(xTaskGetTickCount() + Ticks,Slack));
+}
+
+static void Slack_PrintStats(void)
+{
+    SlackStats_t Stats;
+    uint32_t Distinct;
+
+    portENTER_CRITICAL(&Slack_Lock);
+    Stats = Slack_Stats;
+    portEXIT_CRITICAL(&Slack_Lock);
+
+    Distinct = Stats.Requests - Stats.Joined;
+
+    printf("Wake-ups %u on %u distinct ticks, saved %u (%u%%), aligned %u, exact %u, untracked %u\r\n",Stats.Requests,
+           Distinct,Stats.Joined,(Stats.Requests != 0) ? (Stats.Joined * 100 / Stats.Requests) : 0,Stats.Aligned,
+           Stats.Exact,Stats.Untracked);
+    printf("Added latency avg %llu us, max %u us\r\n\r\n",
+           (Stats.Requests != 0) ? (Stats.AddedTicks * portTICK_PERIOD_MS * 1000 / Stats.Requests) : 0,
+           Stats.AddedMax * portTICK_PERIOD_MS * 1000);
+}
+
+/*---------------------------------------------- Slack timers ----------------------------------------------*/
+
+static void SlackTimer_Arm(SlackTimer_t* Timer)
+{
+    TickType_t Now;
+
+    Timer->Nominal += Timer->Period;
+    Timer->Wake = Slack_Plan(Timer->Nominal,Timer->Slack);
+    Now = xTaskGetTickCount();
+
+    //Changing the period of a timer also starts it, from the tick the daemon handles the command
+    xTimerChangePeriod(Timer->Handle,((int32_t)(Timer->Wake - Now) > 0) ? (Timer->Wake - Now) : 1,0);
+}
+
+static void SlackTimer_Expired(TimerHandle_t Handle)
+{
+    SlackTimer_t* Timer = (SlackTimer_t*)pvTimerGetTimerID(Handle);
+
+    Slack_Release(Timer->Wake);
+
+    if(Timer->Active == pdFALSE)
+    {
+        return;
+    }
+
+    Timer->Active = Timer->AutoReload;
+    Timer->Callback(Timer);
+
+    //The callback may have stopped the timer
+    if(Timer->Active == pdTRUE)
+    {
+        SlackTimer_Arm(Timer);
+    }
+}
+
+static BaseType_t SlackTimer_Create(SlackTimer_t* Timer, const char* Name, TickType_t Period, TickType_t Slack,
+                                    BaseType_t AutoReload, void (*Callback)(SlackTimer_t* Timer), void* Arg)
+{
+    Timer->Period = Period;
+    Timer->Slack = Slack;
+    Timer->AutoReload = AutoReload;
+    Timer->Active = pdFALSE;
+    Timer->Callback = Callback;
+    Timer->Arg = Arg;
+
+    //One shot in the kernel, the reload is done by SlackTimer_Arm at the tick picked for it
+    Timer->Handle = xTimerCreate(Name,Period,pdFALSE,Timer,SlackTimer_Expired);
+
+    return (Timer->Handle != NULL) ? pdPASS : pdFAIL;
+}
+
+static void SlackTimer_Start(SlackTimer_t* Timer)
+{
+    Timer->Nominal = xTaskGetTickCount();
+    Timer->Active = pdTRUE;
+    SlackTimer_Arm(Timer);
+}
+
+/*From the callback of the timer or from a task*/
+static void SlackTimer_Stop(SlackTimer_t* Timer)
+{
+    if(Timer->Active == pdTRUE)
+    {
+        Timer->Active = pdFALSE;
+
+        if(xTimerIsTimerActive(Timer->Handle) == pdTRUE)
+        {
+            xTimerStop(Timer->Handle,0);
+            Slack_Release(Timer->Wake);
+        }
+    }
+}
+
+/*---------------------------------------------- Examples 12, 13 and 14 ----------------------------------------------*/
+
+static xQueueHandle xQueue1 = NULL, xQueue2 = NULL;
+static xQueueSetHandle xQueueSet = NULL;
+static SlackTimer_t OneShot_Timer, Periodic_Timer, Status_Timer;
+
+static void Sending_Task1(void* pvParameters)
+{
+    const char* const Queue_String = "Sending the string from task1!!!\r\n";
+    TickType_t Nominal;
+
+    //Unrelated phase as in example 12, the slack lets the two senders meet anyway
+    vTaskDelay(rand() % pdMS_TO_TICKS(100));
+    Nominal = xTaskGetTickCount();
+
+    for(;;)
+    {
+        xQueueSendToBack(xQueue1,&Queue_String,0);
+        Slack_DelayUntil(&Nominal,pdMS_TO_TICKS(100),pdMS_TO_TICKS(20));
+    }
+}
+
+static void Sending_Task2(void* pvParameters)
+{
+    const char* const Queue_String = "Sending the string from task2!!!\r\n";
+    TickType_t Nominal;
+
+    vTaskDelay(rand() % pdMS_TO_TICKS(200));
+    Nominal = xTaskGetTickCount();
+
+    for(;;)
+    {
+        xQueueSendToBack(xQueue2,&Queue_String,0);
+        Slack_DelayUntil(&Nominal,pdMS_TO_TICKS(200),pdMS_TO_TICKS(40));
+    }
+}
+
+static void Receiving_Task(void* pvParameters)
+{
+    xQueueHandle xQueue_Data_Receive;
+    char* ReceiveString;
+
+    for(;;)
+    {
+        xQueue_Data_Receive = (xQueueHandle) xQueueSelectFromSet(xQueueSet,pdMS_TO_TICKS(200));
+
+        if(xQueue_Data_Receive != NULL)
+        {
+            xQueueReceive(xQueue_Data_Receive,&ReceiveString,0);
+            printf("%s",ReceiveString);
+        }
+    }
+}
+
+/*Sensor with a period of its own which is not a multiple of the others*/
+static void Sensor_Task(void* pvParameters)
+{
+    uint32_t Samples = 0;
+
+    for(;;)
+    {
+        Slack_Delay(pdMS_TO_TICKS(130),pdMS_TO_TICKS(30));
+
+        if((++Samples % 50) == 0)
+        {
+            ESP_LOGI(RTOS,"Sensor sample %u at time %d.\r\n",Samples,xTaskGetTickCount());
+        }
+    }
+}
+
+static void TimerCallBack(SlackTimer_t* Timer)
+{
+    uint32_t Execution_Count = (uint32_t)Timer->Arg;
+
+    Timer->Arg = (void*)(++Execution_Count);
+
+    if(Timer == &OneShot_Timer)
+    {
+        ESP_LOGI(RTOS,"One shot timer callback routine is executing at time %d.\r\n",xTaskGetTickCount());
+    }
+    else
+    {
+        ESP_LOGI(RTOS,"Periodic timer callback routine is executing at time %d.\r\n",xTaskGetTickCount());
+
+        //Stopping the periodic timer after it has executed 10th time as in example 14
+        if(Execution_Count == 10)
+        {
+            SlackTimer_Stop(Timer);
+        }
+    }
+}
+
+static void StatusCallBack(SlackTimer_t* Timer)
+{
+    Slack_PrintStats();
+}
+
+void app_main(void)
+{
+    xQueue1 = xQueueCreate(1,sizeof(char*));
+    xQueue2 = xQueueCreate(1,sizeof(char*));
+
+    xQueueSet = xQueueCreateSet(1 * 2);
+
+    xQueueAddToSet(xQueue1,xQueueSet);
+    xQueueAddToSet(xQueue2,xQueueSet);
+
+    if((SlackTimer_Create(&OneShot_Timer,"OneShotTimer",pdMS_TO_TICKS(3000),pdMS_TO_TICKS(100),pdFALSE,TimerCallBack,NULL) ==
+        pdFAIL) ||
+       (SlackTimer_Create(&Periodic_Timer,"PeriodicTimer",pdMS_TO_TICKS(500),pdMS_TO_TICKS(50),pdTRUE,TimerCallBack,NULL) ==
+        pdFAIL) ||
+       (SlackTimer_Create(&Status_Timer,"StatusTimer",pdMS_TO_TICKS(10000),pdMS_TO_TICKS(1000),pdTRUE,StatusCallBack,NULL) ==
+        pdFAIL))
+    {
+        ESP_LOGE(RTOS,"Timers could not be created.\r\n");
+        return;
+    }
+
+    xTaskCreate(Sending_Task1,"Sending1",2048,NULL,0,NULL);
+    xTaskCreate(Sending_Task2,"Sending2",2048,NULL,0,NULL);
+    xTaskCreate(Receiving_Task,"Receiving",2048,NULL,1,NULL);
+    xTaskCreate(Sensor_Task,"Sensor",2048,NULL,1,NULL);
+
+    SlackTimer_Start(&OneShot_Timer);
+    SlackTimer_Start(&Periodic_Timer);
+    SlackTimer_Start(&Status_Timer);
+}
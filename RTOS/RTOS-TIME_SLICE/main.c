@@ -0,0 +1,571 @@
+/**
+ * @file main.c
+ * @author Tushar Uttekar
+ *
+ * @brief
+ *
+ * This example demonstrates time slices of a configurable length for tasks of the same priority. In example 1 vTask1 and
+ * vTask2 run at the same priority and the kernel switches between them on every tick, for CPU bound tasks which are only
+ * interested in throughput that is a switch and a cold start of the other task on every tick.
+ *
+ * ->The tasks of a group are pinned to one core and created at the base priority of the group, every task is added with a
+ *   quantum in ticks which can be changed at any time with TimeSlice_SetQuantum.
+ * ->One task of the group, the active one, is raised one priority above the base so the kernel does not slice it with the others.
+ * ->The tick hook counts the ticks the active task has run, when its quantum is used up the slicer task lowers it back to the
+ *   base and raises the next ready task of the group. Ticks taken by higher priority tasks are not counted against the quantum.
+ * ->When the active task blocks, the kernel runs the other tasks of the group at the base priority, on the first tick one of
+ *   them is seen running it is made the active task and gets its full quantum.
+ * ->The tick hook samples the running task of the core on every tick, for every task of the group the ticks it ran, the times it
+ *   was made active and the switches to it (ticks on which it runs after a different task ran on the previous tick) are counted.
+ *
+ * The benchmark runs three CPU bound workers in a group with the slicing of the kernel and with quanta of 1, 5 and 20 ticks and
+ * prints the work done per second and the switches per second. After it vTask1 and vTask2 of example 1 run with quanta of 5
+ * and 20 ticks.
+ *
+ * NOTE : The kernel is not changed, the quanta are made by changing the priority of the active task from the slicer task, which
+ *        runs at the highest priority on the core of the group. No other task on that core may use the priority above the base.
+ *        The switches are sampled on the tick, a task which runs for less than a tick between two others is not counted.
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_freertos_hooks.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "esp_system.h"
+
+#define RTOS                    "FREERTOS"
+
+#define SLICE_MAX_TASKS         8
+#define SLICE_CORE              1           //Core of the group, core 0 keeps the system tasks
+#define SLICE_BASE_PRIORITY     2           //The active task runs at SLICE_BASE_PRIORITY + 1
+#define SLICE_NONE              (-1)
+
+typedef struct
+{
+    TaskHandle_t Task;
+    TickType_t Quantum;
+    uint32_t Ticks;                         //Ticks it was seen running
+    uint32_t Slices;                        //Times it was made the active task
+    uint32_t Switches;                      //Ticks it was seen running after a different task
+}SliceTask_t;
+
+typedef struct
+{
+    portMUX_TYPE Lock;
+    SliceTask_t Tasks[SLICE_MAX_TASKS];
+    volatile int32_t Count;
+    volatile BaseType_t Enabled;
+    volatile int32_t Active;                //Raised task, SLICE_NONE when all are at the base priority
+    volatile int32_t Request;               //Task to make active, SLICE_NONE when there is nothing to do
+    volatile TickType_t Used;               //Ticks of the quantum of the active task
+    TaskHandle_t LastRunning;
+    TaskHandle_t Slicer;
+}SliceGroup_t;
+
+static SliceGroup_t Slice_Group;
+
+/*---------------------------------------------- Time slicer ----------------------------------------------*/
+
+/*Index of the task in the group, SLICE_NONE when it is not a member*/
+static int32_t TimeSlice_Find(TaskHandle_t Task)
+{
+    int32_t Index;
+
+    for(Index = 0; Index < Slice_Group.Count; Index++)
+    {
+        if(Slice_Group.Tasks[Index].Task == Task)
+        {
+            return Index;
+        }
+    }
+
+    return SLICE_NONE;
+}
+
+/*Sets the request and wakes the slicer, called with the lock held*/
+static BaseType_t TimeSlice_Post(int32_t Index)
+{
+    BaseType_t Wake = (Slice_Group.Request == SLICE_NONE) ? pdTRUE : pdFALSE;
+
+    Slice_Group.Request = Index;
+
+    return Wake;
+}
+
+static void TimeSlice_TickHook(void)
+{
+    TaskHandle_t Running = xTaskGetCurrentTaskHandleForCPU(SLICE_CORE);
+    BaseType_t Wake = pdFALSE, Woken = pdFALSE;
+    int32_t Index;
+
+    portENTER_CRITICAL_ISR(&Slice_Group.Lock);
+
+    Index = TimeSlice_Find(Running);
+
+    if(Index != SLICE_NONE)
+    {
+        Slice_Group.Tasks[Index].Ticks++;
+
+        if(Running != Slice_Group.LastRunning)
+        {
+            Slice_Group.Tasks[Index].Switches++;
+        }
+
+        if(Slice_Group.Enabled == pdTRUE)
+        {
+            if(Index == Slice_Group.Active)
+            {
+                if(++Slice_Group.Used >= Slice_Group.Tasks[Index].Quantum)
+                {
+                    Wake = TimeSlice_Post((Index + 1) % Slice_Group.Count);
+                }
+            }
+            else
+            {
+                //The active task blocked and the kernel runs a task of the group at the base priority
+                Wake = TimeSlice_Post(Index);
+            }
+        }
+    }
+
+    Slice_Group.LastRunning = Running;
+
+    portEXIT_CRITICAL_ISR(&Slice_Group.Lock);
+
+    if(Wake == pdTRUE)
+    {
+        vTaskNotifyGiveFromISR(Slice_Group.Slicer,&Woken);
+
+        if(Woken == pdTRUE)
+        {
+            portYIELD_FROM_ISR();
+        }
+    }
+}
+
+/*First task from Index on which is ready to run, SLICE_NONE when all of them are blocked*/
+static int32_t TimeSlice_PickReady(int32_t Index, int32_t Count)
+{
+    int32_t Loop, Pick;
+
+    for(Loop = 0; Loop < Count; Loop++)
+    {
+        Pick = (Index + Loop) % Count;
+
+        //The slicer runs on the core of the group, so none of them can be running right now
+        if(eTaskGetState(Slice_Group.Tasks[Pick].Task) == eReady)
+        {
+            return Pick;
+        }
+    }
+
+    return SLICE_NONE;
+}
+
+static void TimeSlicer_Task(void* pvParameters)
+{
+    int32_t Request, Active, Count, Pick;
+    BaseType_t Enabled;
+
+    for(;;)
+    {
+        ulTaskNotifyTake(pdTRUE,portMAX_DELAY);
+
+        portENTER_CRITICAL(&Slice_Group.Lock);
+        Request = Slice_Group.Request;
+        Slice_Group.Request = SLICE_NONE;
+        Active = Slice_Group.Active;
+        Count = Slice_Group.Count;
+        Enabled = Slice_Group.Enabled;
+        portEXIT_CRITICAL(&Slice_Group.Lock);
+
+        if((Enabled == pdFALSE) || (Count == 0))
+        {
+            Pick = SLICE_NONE;
+        }
+        else
+        {
+            Pick = TimeSlice_PickReady((Request == SLICE_NONE) ? 0 : Request,Count);
+
+            //Nothing else is ready, the active task keeps the core for another quantum
+            if(Pick == SLICE_NONE)
+            {
+                Pick = (Active != SLICE_NONE) ? Active : Request;
+            }
+        }
+
+        //Raise the new task first, the slicer runs above both so the order is not visible to them
+        if(Pick != Active)
+        {
+            if(Pick != SLICE_NONE)
+            {
+                vTaskPrioritySet(Slice_Group.Tasks[Pick].Task,SLICE_BASE_PRIORITY + 1);
+            }
+
+            if(Active != SLICE_NONE)
+            {
+                vTaskPrioritySet(Slice_Group.Tasks[Active].Task,SLICE_BASE_PRIORITY);
+            }
+        }
+
+        portENTER_CRITICAL(&Slice_Group.Lock);
+        Slice_Group.Active = Pick;
+        Slice_Group.Used = 0;
+
+        if(Pick != SLICE_NONE)
+        {
+            Slice_Group.Tasks[Pick].Slices++;
+        }
+        portEXIT_CRITICAL(&Slice_Group.Lock);
+    }
+}
+
+static BaseType_t TimeSlice_Init(void)
+{
+    vPortCPUInitializeMutex(&Slice_Group.Lock);
+    Slice_Group.Count = 0;
+    Slice_Group.Enabled = pdFALSE;
+    Slice_Group.Active = SLICE_NONE;
+    Slice_Group.Request = SLICE_NONE;
+    Slice_Group.Used = 0;
+    Slice_Group.LastRunning = NULL;
+
+    if(xTaskCreatePinnedToCore(TimeSlicer_Task,"Slicer",2048,NULL,configMAX_PRIORITIES - 1,&Slice_Group.Slicer,
+                               SLICE_CORE) != pdPASS)
+    {
+        return pdFAIL;
+    }
+
+    if(esp_register_freertos_tick_hook_for_cpu(TimeSlice_TickHook,SLICE_CORE) != ESP_OK)
+    {
+        vTaskDelete(Slice_Group.Slicer);
+        return pdFAIL;
+    }
+
+    return pdPASS;
+}
+
+/*Adds a task which is pinned to SLICE_CORE and runs at SLICE_BASE_PRIORITY*/
+static BaseType_t TimeSlice_Add(TaskHandle_t Task, TickType_t Quantum)
+{
+    BaseType_t xStatus = pdFAIL;
+
+    if((Task == NULL) || (Quantum == 0))
+    {
+        return pdFAIL;
+    }
+
+    portENTER_CRITICAL(&Slice_Group.Lock);
+
+    if((Slice_Group.Count < SLICE_MAX_TASKS) && (TimeSlice_Find(Task) == SLICE_NONE))
+    {
+        Slice_Group.Tasks[Slice_Group.Count] = (SliceTask_t){ .Task = Task, .Quantum = Quantum };
+        Slice_Group.Count++;
+        xStatus = pdPASS;
+    }
+
+    portEXIT_CRITICAL(&Slice_Group.Lock);
+
+    return xStatus;
+}
+
+static BaseType_t TimeSlice_SetQuantum(TaskHandle_t Task, TickType_t Quantum)
+{
+    BaseType_t xStatus = pdFAIL;
+    int32_t Index;
+
+    if(Quantum == 0)
+    {
+        return pdFAIL;
+    }
+
+    portENTER_CRITICAL(&Slice_Group.Lock);
+
+    Index = TimeSlice_Find(Task);
+
+    if(Index != SLICE_NONE)
+    {
+        Slice_Group.Tasks[Index].Quantum = Quantum;
+        xStatus = pdPASS;
+    }
+
+    portEXIT_CRITICAL(&Slice_Group.Lock);
+
+    return xStatus;
+}
+
+/*With pdFALSE the group is left to the slicing of the kernel, the counters keep running*/
+static void TimeSlice_Enable(BaseType_t Enable)
+{
+    BaseType_t Wake;
+
+    portENTER_CRITICAL(&Slice_Group.Lock);
+    Slice_Group.Enabled = Enable;
+    Wake = TimeSlice_Post((Slice_Group.Active != SLICE_NONE) ? Slice_Group.Active : 0);
+    portEXIT_CRITICAL(&Slice_Group.Lock);
+
+    if(Wake == pdTRUE)
+    {
+        xTaskNotifyGive(Slice_Group.Slicer);
+    }
+}
+
+static BaseType_t TimeSlice_GetStats(TaskHandle_t Task, SliceTask_t* Stats)
+{
+    BaseType_t xStatus = pdFAIL;
+    int32_t Index;
+
+    portENTER_CRITICAL(&Slice_Group.Lock);
+
+    Index = TimeSlice_Find(Task);
+
+    if(Index != SLICE_NONE)
+    {
+        *Stats = Slice_Group.Tasks[Index];
+        xStatus = pdPASS;
+    }
+
+    portEXIT_CRITICAL(&Slice_Group.Lock);
+
+    return xStatus;
+}
+
+static void TimeSlice_ResetStats(void)
+{
+    int32_t Index;
+
+    portENTER_CRITICAL(&Slice_Group.Lock);
+
+    for(Index = 0; Index < Slice_Group.Count; Index++)
+    {
+        Slice_Group.Tasks[Index].Ticks = 0;
+        Slice_Group.Tasks[Index].Slices = 0;
+        Slice_Group.Tasks[Index].Switches = 0;
+    }
+
+    portEXIT_CRITICAL(&Slice_Group.Lock);
+}
+
+static void TimeSlice_PrintStats(TaskHandle_t Task)
+{
+    SliceTask_t Stats;
+
+    if(TimeSlice_GetStats(Task,&Stats) == pdPASS)
+    {
+        printf("%-16s quantum %3u : ticks %7u, slices %6u, switches %6u\r\n",pcTaskGetTaskName(Task),Stats.Quantum,
+               Stats.Ticks,Stats.Slices,Stats.Switches);
+    }
+}
+
+/*---------------------------------------------- Benchmark ----------------------------------------------*/
+
+#define BENCH_WORKERS           3
+#define BENCH_BUFFER_SIZE       8192        //Working set of every worker
+#define BENCH_RUN_MS            2000
+
+static const TickType_t Bench_Quantum[] = {0,1,5,20};     //0 is the slicing of the kernel
+
+static TaskHandle_t Bench_Task[BENCH_WORKERS];
+static volatile uint32_t Bench_Work[BENCH_WORKERS];
+static volatile BaseType_t Bench_Running;
+static SemaphoreHandle_t Bench_Done;
+
+static void BenchWorker_Task(void* pvParameters)
+{
+    uint32_t Worker = (uint32_t) pvParameters, Index, Sum = 0;
+    uint32_t* Buffer;
+
+    Buffer = (uint32_t*) malloc(BENCH_BUFFER_SIZE);
+
+    if(Buffer == NULL)
+    {
+        ESP_LOGE(RTOS,"Worker buffer could not be allocated.\r\n");
+        vTaskDelete(NULL);
+    }
+
+    for(Index = 0; Index < (BENCH_BUFFER_SIZE / sizeof(uint32_t)); Index++)
+    {
+        Buffer[Index] = Index * Worker;
+    }
+
+    for(;;)
+    {
+        ulTaskNotifyTake(pdTRUE,portMAX_DELAY);
+
+        while(Bench_Running == pdTRUE)
+        {
+            //One unit of work is a pass over the working set of the worker
+            for(Index = 0; Index < (BENCH_BUFFER_SIZE / sizeof(uint32_t)); Index++)
+            {
+                Sum += Buffer[Index];
+                Buffer[Index] = Sum;
+            }
+
+            Bench_Work[Worker]++;
+        }
+
+        xSemaphoreGive(Bench_Done);
+    }
+}
+
+static void Benchmark_Run(void)
+{
+    uint32_t Run, Worker, Work, Switches, Min, Max;
+    SliceTask_t Stats;
+
+    printf("%-10s %12s %12s %10s %10s\r\n","Quantum","Work/s","Switches/s","MinWorker","MaxWorker");
+
+    for(Run = 0; Run < (sizeof(Bench_Quantum) / sizeof(Bench_Quantum[0])); Run++)
+    {
+        for(Worker = 0; Worker < BENCH_WORKERS; Worker++)
+        {
+            if(Bench_Quantum[Run] != 0)
+            {
+                TimeSlice_SetQuantum(Bench_Task[Worker],Bench_Quantum[Run]);
+            }
+
+            Bench_Work[Worker] = 0;
+        }
+
+        TimeSlice_Enable((Bench_Quantum[Run] != 0) ? pdTRUE : pdFALSE);
+        TimeSlice_ResetStats();
+
+        Bench_Running = pdTRUE;
+
+        for(Worker = 0; Worker < BENCH_WORKERS; Worker++)
+        {
+            xTaskNotifyGive(Bench_Task[Worker]);
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(BENCH_RUN_MS));
+        Bench_Running = pdFALSE;
+
+        for(Worker = 0; Worker < BENCH_WORKERS; Worker++)
+        {
+            xSemaphoreTake(Bench_Done,portMAX_DELAY);
+        }
+
+        Work = 0;
+        Switches = 0;
+        Min = UINT32_MAX;
+        Max = 0;
+
+        for(Worker = 0; Worker < BENCH_WORKERS; Worker++)
+        {
+            Work += Bench_Work[Worker];
+            Min = (Bench_Work[Worker] < Min) ? Bench_Work[Worker] : Min;
+            Max = (Bench_Work[Worker] > Max) ? Bench_Work[Worker] : Max;
+            TimeSlice_GetStats(Bench_Task[Worker],&Stats);
+            Switches += Stats.Switches;
+        }
+
+        if(Bench_Quantum[Run] == 0)
+        {
+            printf("%-10s","kernel");
+        }
+        else
+        {
+            printf("%-10u",Bench_Quantum[Run]);
+        }
+
+        //The minimum and maximum work of a single worker show how fair the quanta are shared
+        printf(" %12u %12u %10u %10u\r\n",(Work * 1000) / BENCH_RUN_MS,(Switches * 1000) / BENCH_RUN_MS,Min,Max);
+    }
+
+    printf("\r\n");
+}
+
+/*---------------------------------------------- Example 1 ----------------------------------------------*/
+
+/*CPU bound soft delay, the task keeps the core instead of blocking*/
+static void Soft_Delay(uint32_t DelayMs)
+{
+    int64_t Start = esp_timer_get_time();
+
+    while((esp_timer_get_time() - Start) < ((int64_t)DelayMs * 1000));
+}
+
+static void vTask1(void *pvParameters)
+{
+    const char* printstr = "Task 1 is executing....\r\n";
+
+    for(;;)
+    {
+        //Output Statement/String
+        printf(printstr);
+        //Soft Delay
+        Soft_Delay(10);
+    }
+}
+
+static void vTask2(void *pvParameters)
+{
+    const char* printstr = "Task 2 is executing....\r\n";
+
+    for(;;)
+    {
+        //Output Statement/String
+        printf(printstr);
+        //Soft Delay
+        Soft_Delay(10);
+    }
+}
+
+static void Stats_Task(void* pvParameters)
+{
+    TaskHandle_t* Tasks = (TaskHandle_t*) pvParameters;
+
+    for(;;)
+    {
+        vTaskDelay(pdMS_TO_TICKS(5000));
+
+        TimeSlice_PrintStats(Tasks[0]);
+        TimeSlice_PrintStats(Tasks[1]);
+    }
+}
+
+void app_main(void)
+{
+    static TaskHandle_t Example_Task[2];
+    uint32_t Worker;
+
+    Bench_Done = xSemaphoreCreateCounting(BENCH_WORKERS,0);
+
+    if((Bench_Done == NULL) || (TimeSlice_Init() == pdFAIL))
+    {
+        ESP_LOGE(RTOS,"Time slicer could not be created.\r\n");
+        return;
+    }
+
+    //The workers of the benchmark, all at the base priority on the core of the group
+    for(Worker = 0; Worker < BENCH_WORKERS; Worker++)
+    {
+        if((xTaskCreatePinnedToCore(BenchWorker_Task,"Worker",2048,(void*)Worker,SLICE_BASE_PRIORITY,&Bench_Task[Worker],
+                                    SLICE_CORE) != pdPASS) || (TimeSlice_Add(Bench_Task[Worker],1) == pdFAIL))
+        {
+            ESP_LOGE(RTOS,"Benchmark workers could not be created.\r\n");
+            return;
+        }
+    }
+
+    Benchmark_Run();
+
+    //Example 1, the two tasks of the same priority with different quanta, the workers stay blocked in the group
+    xTaskCreatePinnedToCore(vTask1,"TASK1",2048,NULL,SLICE_BASE_PRIORITY,&Example_Task[0],SLICE_CORE);
+    xTaskCreatePinnedToCore(vTask2,"TASK2",2048,NULL,SLICE_BASE_PRIORITY,&Example_Task[1],SLICE_CORE);
+
+    TimeSlice_Add(Example_Task[0],5);
+    TimeSlice_Add(Example_Task[1],20);
+    TimeSlice_Enable(pdTRUE);
+
+    xTaskCreate(Stats_Task,"Stats",2048,(void*)Example_Task,3,NULL);
+}
@@ -0,0 +1,764 @@
+/**
+ * @file main.c
+ * @author Tushar Uttekar
+ *
+ * @brief
+ *
+ * This example demonstrates a TLSF (Two Level Segregated Fit) heap which can be plugged in as the memory source for the
+ * FREERTOS objects instead of the default heap, along with the fragmentation telemetry of the heap.
+ *
+ * The default heap searches the free list for a fitting block, so the time taken by xQueueCreate, xTaskCreate etc. keeps
+ * changing as the heap gets fragmented. In TLSF the free blocks are kept in a two level table of lists:
+ * ->The first level splits the sizes in powers of two and the second level splits every power of two in 16 linear classes.
+ * ->One bitmap for each level tells which lists are non empty, so a fitting list is found with a couple of find-first-set
+ *   instructions and both malloc and free run in constant time irrespective of the number of free blocks.
+ * ->Freed blocks are merged immediately with their free physical neighbours which keeps the fragmentation low.
+ *
+ * The objects are created from the TLSF pool through the static allocation API's, where the control block and the storage of
+ * the object are placed in one TLSF block. Setting USE_TLSF_HEAP to 0 switches the same helper functions back to the default
+ * dynamic API's so both the heaps can be compared on the same application.
+ *
+ * The heap reports the free bytes, the largest free block, a fragmentation index (the percentage of the free memory which can not
+ * be handed out as one block) and the allocated/free block count for every size class.
+ *
+ * At the start the example replays the same create/delete allocation trace on the TLSF pool and on the default heap and prints the
+ * average and the worst case cycles per operation, the failed allocations of both the heaps side by side, and the bytes held and the
+ * drop of the largest free block measured while the blocks of the trace are still allocated.
+ *
+ * NOTE : The helper delete functions rely on the handle returned by the static create API's being the address of the static
+ *        control block which was passed to it, which is how the FREERTOS kernel implements them.
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+#include "xtensa/core-macros.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_system.h"
+
+#define RTOS                    "freertos"
+#define USE_TLSF_HEAP           1
+#define TLSF_POOL_SIZE          (48 * 1024)
+
+/*Block sizes are kept aligned to 8 bytes and the second level splits every power of two in 16 classes*/
+#define TLSF_ALIGN_SHIFT        3
+#define TLSF_ALIGN              (1 << TLSF_ALIGN_SHIFT)
+#define TLSF_SL_LOG2            4
+#define TLSF_SL_COUNT           (1 << TLSF_SL_LOG2)
+#define TLSF_FL_SHIFT           (TLSF_SL_LOG2 + TLSF_ALIGN_SHIFT)
+#define TLSF_FL_MAX             20
+#define TLSF_FL_COUNT           (TLSF_FL_MAX - TLSF_FL_SHIFT + 1)
+#define TLSF_SMALL_BLOCK        (1 << TLSF_FL_SHIFT)
+
+/*The lower two bits of the size field are used as flags since the sizes are always aligned*/
+#define TLSF_BLOCK_FREE         ((size_t)1)
+#define TLSF_BLOCK_PREV_FREE    ((size_t)2)
+#define TLSF_FLAG_MASK          (TLSF_BLOCK_FREE | TLSF_BLOCK_PREV_FREE)
+
+#define TRACE_OPERATIONS        4000
+#define TRACE_SLOTS             16
+#define TRACE_LARGEST_SIZE      (350 + 2048)
+#define STATS_PERIOD            (pdMS_TO_TICKS(5000))
+
+/*Header of every physical block, the free list links are placed in the payload of the free blocks only*/
+typedef struct TlsfBlock
+{
+    struct TlsfBlock* PrevPhys;
+    size_t Size;
+    struct TlsfBlock* NextFree;
+    struct TlsfBlock* PrevFree;
+}TlsfBlock_t;
+
+#define TLSF_HEADER_SIZE        (offsetof(TlsfBlock_t,NextFree))
+#define TLSF_MIN_PAYLOAD        (sizeof(TlsfBlock_t) - TLSF_HEADER_SIZE)
+
+typedef struct
+{
+    size_t FreeBytes;
+    size_t MinimumFreeBytes;
+    size_t UsedBytes;
+    size_t LargestFreeBlock;
+    uint32_t FragmentationIndex;
+    uint32_t FreeBlocks[TLSF_FL_COUNT];
+    uint32_t UsedBlocks[TLSF_FL_COUNT];
+}TlsfStats_t;
+
+typedef struct
+{
+    uint32_t FlBitmap;
+    uint32_t SlBitmap[TLSF_FL_COUNT];
+    TlsfBlock_t* FreeLists[TLSF_FL_COUNT][TLSF_SL_COUNT];
+    size_t FreeBytes;
+    size_t MinimumFreeBytes;
+    uint32_t FreeBlocks[TLSF_FL_COUNT];
+    uint32_t UsedBlocks[TLSF_FL_COUNT];
+}TlsfControl_t;
+
+static uint8_t Tlsf_Pool[TLSF_POOL_SIZE] __attribute__((aligned(TLSF_ALIGN)));
+static TlsfControl_t Tlsf;
+static size_t Tlsf_PoolBytes;
+static portMUX_TYPE Tlsf_Lock = portMUX_INITIALIZER_UNLOCKED;
+
+/*---------------------------------------------- TLSF block helpers ----------------------------------------------*/
+
+static inline uint32_t Tlsf_Fls(size_t Value)
+{
+    return (31 - __builtin_clz((uint32_t)Value));
+}
+
+static inline uint32_t Tlsf_Ffs(uint32_t Value)
+{
+    return __builtin_ctz(Value);
+}
+
+static inline size_t Tlsf_BlockSize(const TlsfBlock_t* Block)
+{
+    return (Block->Size & ~TLSF_FLAG_MASK);
+}
+
+static inline void Tlsf_SetSize(TlsfBlock_t* Block, size_t Size)
+{
+    Block->Size = Size | (Block->Size & TLSF_FLAG_MASK);
+}
+
+static inline TlsfBlock_t* Tlsf_NextPhys(const TlsfBlock_t* Block)
+{
+    return (TlsfBlock_t*)((uint8_t*)Block + TLSF_HEADER_SIZE + Tlsf_BlockSize(Block));
+}
+
+static inline void* Tlsf_BlockToPtr(TlsfBlock_t* Block)
+{
+    return (void*)((uint8_t*)Block + TLSF_HEADER_SIZE);
+}
+
+static inline TlsfBlock_t* Tlsf_PtrToBlock(void* Ptr)
+{
+    return (TlsfBlock_t*)((uint8_t*)Ptr - TLSF_HEADER_SIZE);
+}
+
+/*Marks the block free or used and keeps the prev free flag of the following block in sync*/
+static void Tlsf_MarkFree(TlsfBlock_t* Block)
+{
+    TlsfBlock_t* Next;
+
+    Block->Size |= TLSF_BLOCK_FREE;
+    Next = Tlsf_NextPhys(Block);
+    Next->PrevPhys = Block;
+    Next->Size |= TLSF_BLOCK_PREV_FREE;
+}
+
+static void Tlsf_MarkUsed(TlsfBlock_t* Block)
+{
+    Block->Size &= ~TLSF_BLOCK_FREE;
+    Tlsf_NextPhys(Block)->Size &= ~TLSF_BLOCK_PREV_FREE;
+}
+
+/*Finds the first and second level index of the list which holds the blocks of this size*/
+static void Tlsf_Mapping(size_t Size, uint32_t* Fl, uint32_t* Sl)
+{
+    uint32_t FirstLevel, SecondLevel;
+
+    if(Size < TLSF_SMALL_BLOCK)
+    {
+        FirstLevel = 0;
+        SecondLevel = Size / (TLSF_SMALL_BLOCK / TLSF_SL_COUNT);
+    }
+    else
+    {
+        FirstLevel = Tlsf_Fls(Size);
+        SecondLevel = (Size >> (FirstLevel - TLSF_SL_LOG2)) ^ (1 << TLSF_SL_LOG2);
+        FirstLevel -= (TLSF_FL_SHIFT - 1);
+    }
+
+    *Fl = FirstLevel;
+    *Sl = SecondLevel;
+}
+
+/*Rounds the request up to the next class so that any block of the found list is big enough without searching the list*/
+static void Tlsf_MappingSearch(size_t Size, uint32_t* Fl, uint32_t* Sl)
+{
+    if(Size >= TLSF_SMALL_BLOCK)
+    {
+        Size += (1 << (Tlsf_Fls(Size) - TLSF_SL_LOG2)) - 1;
+    }
+
+    Tlsf_Mapping(Size,Fl,Sl);
+}
+
+static TlsfBlock_t* Tlsf_FindSuitable(uint32_t* Fl, uint32_t* Sl)
+{
+    uint32_t SlMap, FlMap;
+
+    //Checking the lists of the same first level which are equal or bigger than the requested class
+    SlMap = Tlsf.SlBitmap[*Fl] & (~0U << *Sl);
+
+    if(SlMap == 0)
+    {
+        //Moving to the next non empty first level
+        FlMap = (*Fl + 1 < 32) ? (Tlsf.FlBitmap & (~0U << (*Fl + 1))) : 0;
+
+        if(FlMap == 0)
+        {
+            return NULL;
+        }
+
+        *Fl = Tlsf_Ffs(FlMap);
+        SlMap = Tlsf.SlBitmap[*Fl];
+    }
+
+    *Sl = Tlsf_Ffs(SlMap);
+
+    return Tlsf.FreeLists[*Fl][*Sl];
+}
+
+static void Tlsf_InsertFree(TlsfBlock_t* Block)
+{
+    uint32_t Fl, Sl;
+
+    Tlsf_Mapping(Tlsf_BlockSize(Block),&Fl,&Sl);
+
+    Block->PrevFree = NULL;
+    Block->NextFree = Tlsf.FreeLists[Fl][Sl];
+
+    if(Block->NextFree != NULL)
+    {
+        Block->NextFree->PrevFree = Block;
+    }
+
+    Tlsf.FreeLists[Fl][Sl] = Block;
+    Tlsf.FlBitmap |= (1U << Fl);
+    Tlsf.SlBitmap[Fl] |= (1U << Sl);
+    Tlsf.FreeBlocks[Fl]++;
+}
+
+static void Tlsf_RemoveFree(TlsfBlock_t* Block)
+{
+    uint32_t Fl, Sl;
+
+    Tlsf_Mapping(Tlsf_BlockSize(Block),&Fl,&Sl);
+
+    if(Block->PrevFree != NULL)
+    {
+        Block->PrevFree->NextFree = Block->NextFree;
+    }
+    else
+    {
+        Tlsf.FreeLists[Fl][Sl] = Block->NextFree;
+    }
+
+    if(Block->NextFree != NULL)
+    {
+        Block->NextFree->PrevFree = Block->PrevFree;
+    }
+
+    //Clearing the bitmaps when the list has become empty
+    if(Tlsf.FreeLists[Fl][Sl] == NULL)
+    {
+        Tlsf.SlBitmap[Fl] &= ~(1U << Sl);
+
+        if(Tlsf.SlBitmap[Fl] == 0)
+        {
+            Tlsf.FlBitmap &= ~(1U << Fl);
+        }
+    }
+
+    Tlsf.FreeBlocks[Fl]--;
+}
+
+/*---------------------------------------------- TLSF heap API's ----------------------------------------------*/
+
+void TLSF_Init(void* Pool, size_t PoolSize)
+{
+    TlsfBlock_t *First, *Sentinel;
+    size_t Size;
+
+    memset(&Tlsf,0,sizeof(TlsfControl_t));
+
+    //Room is left for the header of the first block and the zero sized sentinel block at the end of the pool
+    Size = (PoolSize - (2 * TLSF_HEADER_SIZE)) & ~((size_t)TLSF_ALIGN - 1);
+
+    First = (TlsfBlock_t*)Pool;
+    First->PrevPhys = NULL;
+    First->Size = Size;
+
+    //The sentinel is a permanently used block which stops the merging at the end of the pool
+    Sentinel = Tlsf_NextPhys(First);
+    Sentinel->Size = 0;
+
+    Tlsf_MarkFree(First);
+    Tlsf_InsertFree(First);
+
+    Tlsf_PoolBytes = Size;
+    Tlsf.FreeBytes = Size;
+    Tlsf.MinimumFreeBytes = Size;
+}
+
+void* TLSF_Malloc(size_t RequestSize)
+{
+    TlsfBlock_t *Block, *Remainder;
+    uint32_t Fl, Sl;
+    size_t Size;
+    void* Ptr = NULL;
+
+    if((RequestSize == 0) || (RequestSize > Tlsf_PoolBytes))
+    {
+        return NULL;
+    }
+
+    Size = (RequestSize + TLSF_ALIGN - 1) & ~((size_t)TLSF_ALIGN - 1);
+    if(Size < TLSF_MIN_PAYLOAD)
+    {
+        Size = TLSF_MIN_PAYLOAD;
+    }
+
+    Tlsf_MappingSearch(Size,&Fl,&Sl);
+
+    portENTER_CRITICAL(&Tlsf_Lock);
+
+    Block = (Fl < TLSF_FL_COUNT) ? Tlsf_FindSuitable(&Fl,&Sl) : NULL;
+
+    if(Block != NULL)
+    {
+        Tlsf_RemoveFree(Block);
+
+        //Splitting the block when the left over part is big enough to hold a block of its own
+        if(Tlsf_BlockSize(Block) >= (Size + TLSF_HEADER_SIZE + TLSF_MIN_PAYLOAD))
+        {
+            Remainder = (TlsfBlock_t*)((uint8_t*)Block + TLSF_HEADER_SIZE + Size);
+            Remainder->Size = Tlsf_BlockSize(Block) - Size - TLSF_HEADER_SIZE;
+            Tlsf_SetSize(Block,Size);
+            Tlsf.FreeBytes -= TLSF_HEADER_SIZE;
+
+            Remainder->PrevPhys = Block;
+            Tlsf_MarkFree(Remainder);
+            Tlsf_InsertFree(Remainder);
+        }
+
+        Tlsf_MarkUsed(Block);
+
+        Tlsf_Mapping(Tlsf_BlockSize(Block),&Fl,&Sl);
+        Tlsf.UsedBlocks[Fl]++;
+        Tlsf.FreeBytes -= Tlsf_BlockSize(Block);
+
+        if(Tlsf.FreeBytes < Tlsf.MinimumFreeBytes)
+        {
+            Tlsf.MinimumFreeBytes = Tlsf.FreeBytes;
+        }
+
+        Ptr = Tlsf_BlockToPtr(Block);
+    }
+
+    portEXIT_CRITICAL(&Tlsf_Lock);
+
+    return Ptr;
+}
+
+void TLSF_Free(void* Ptr)
+{
+    TlsfBlock_t *Block, *Neighbour;
+    uint32_t Fl, Sl;
+
+    if(Ptr == NULL)
+    {
+        return;
+    }
+
+    Block = Tlsf_PtrToBlock(Ptr);
+
+    portENTER_CRITICAL(&Tlsf_Lock);
+
+    Tlsf_Mapping(Tlsf_BlockSize(Block),&Fl,&Sl);
+    Tlsf.UsedBlocks[Fl]--;
+    Tlsf.FreeBytes += Tlsf_BlockSize(Block);
+
+    //Merging with the previous physical block, the header of the freed block becomes a part of the free memory
+    if((Block->Size & TLSF_BLOCK_PREV_FREE) != 0)
+    {
+        Neighbour = Block->PrevPhys;
+        Tlsf_RemoveFree(Neighbour);
+        Tlsf_SetSize(Neighbour,Tlsf_BlockSize(Neighbour) + TLSF_HEADER_SIZE + Tlsf_BlockSize(Block));
+        Tlsf.FreeBytes += TLSF_HEADER_SIZE;
+        Block = Neighbour;
+    }
+
+    //Merging with the next physical block
+    Neighbour = Tlsf_NextPhys(Block);
+    if((Neighbour->Size & TLSF_BLOCK_FREE) != 0)
+    {
+        Tlsf_RemoveFree(Neighbour);
+        Tlsf_SetSize(Block,Tlsf_BlockSize(Block) + TLSF_HEADER_SIZE + Tlsf_BlockSize(Neighbour));
+        Tlsf.FreeBytes += TLSF_HEADER_SIZE;
+    }
+
+    Tlsf_MarkFree(Block);
+    Tlsf_InsertFree(Block);
+
+    portEXIT_CRITICAL(&Tlsf_Lock);
+}
+
+void TLSF_GetStats(TlsfStats_t* Stats)
+{
+    TlsfBlock_t* Block;
+    uint32_t Fl, Sl;
+    size_t Largest = 0;
+
+    portENTER_CRITICAL(&Tlsf_Lock);
+
+    //The largest free block is in the highest non empty list, only that one list has to be walked
+    if(Tlsf.FlBitmap != 0)
+    {
+        Fl = Tlsf_Fls(Tlsf.FlBitmap);
+        Sl = Tlsf_Fls(Tlsf.SlBitmap[Fl]);
+
+        for(Block = Tlsf.FreeLists[Fl][Sl]; Block != NULL; Block = Block->NextFree)
+        {
+            if(Tlsf_BlockSize(Block) > Largest)
+            {
+                Largest = Tlsf_BlockSize(Block);
+            }
+        }
+    }
+
+    Stats->LargestFreeBlock = Largest;
+    memcpy(Stats->FreeBlocks,Tlsf.FreeBlocks,sizeof(Stats->FreeBlocks));
+    memcpy(Stats->UsedBlocks,Tlsf.UsedBlocks,sizeof(Stats->UsedBlocks));
+
+    Stats->FreeBytes = Tlsf.FreeBytes;
+    Stats->MinimumFreeBytes = Tlsf.MinimumFreeBytes;
+
+    portEXIT_CRITICAL(&Tlsf_Lock);
+
+    Stats->UsedBytes = Tlsf_PoolBytes - Stats->FreeBytes;
+
+    //Fragmentation index is the percentage of the free memory which can not be handed out as a single block
+    if(Stats->FreeBytes != 0)
+    {
+        Stats->FragmentationIndex = 100 - ((Stats->LargestFreeBlock * 100) / Stats->FreeBytes);
+    }
+    else
+    {
+        Stats->FragmentationIndex = 0;
+    }
+}
+
+void TLSF_PrintStats(void)
+{
+    TlsfStats_t Stats;
+    uint32_t Fl;
+    size_t ClassSize;
+
+    TLSF_GetStats(&Stats);
+
+    printf("TLSF heap: free %u used %u min-free %u largest %u fragmentation %u%%\r\n",
+           Stats.FreeBytes,Stats.UsedBytes,Stats.MinimumFreeBytes,Stats.LargestFreeBlock,Stats.FragmentationIndex);
+
+    for(Fl = 0; Fl < TLSF_FL_COUNT; Fl++)
+    {
+        if((Stats.FreeBlocks[Fl] != 0) || (Stats.UsedBlocks[Fl] != 0))
+        {
+            //First level zero holds everything below the small block size, the others start at a power of two
+            ClassSize = (Fl == 0) ? 0 : ((size_t)1 << (Fl + TLSF_FL_SHIFT - 1));
+            printf("  class >= %6u : used %4u free %4u\r\n",ClassSize,Stats.UsedBlocks[Fl],Stats.FreeBlocks[Fl]);
+        }
+    }
+}
+
+/*---------------------------------------------- FREERTOS object helpers ----------------------------------------------*/
+
+/*Control block and storage area are placed in one block, the storage starts at the next aligned address*/
+#define TLSF_OBJECT_OFFSET(Type)    ((sizeof(Type) + TLSF_ALIGN - 1) & ~((size_t)TLSF_ALIGN - 1))
+
+QueueHandle_t Heap_QueueCreate(UBaseType_t Length, UBaseType_t ItemSize)
+{
+#if USE_TLSF_HEAP
+    uint8_t* Memory;
+    QueueHandle_t Handle = NULL;
+
+    Memory = TLSF_Malloc(TLSF_OBJECT_OFFSET(StaticQueue_t) + (Length * ItemSize));
+
+    if(Memory != NULL)
+    {
+        Handle = xQueueCreateStatic(Length,ItemSize,(Memory + TLSF_OBJECT_OFFSET(StaticQueue_t)),(StaticQueue_t*)Memory);
+    }
+
+    return Handle;
+#else
+    return xQueueCreate(Length,ItemSize);
+#endif
+}
+
+void Heap_QueueDelete(QueueHandle_t Handle)
+{
+    vQueueDelete(Handle);
+#if USE_TLSF_HEAP
+    TLSF_Free((void*)Handle);
+#endif
+}
+
+EventGroupHandle_t Heap_EventGroupCreate(void)
+{
+#if USE_TLSF_HEAP
+    StaticEventGroup_t* Memory;
+
+    Memory = TLSF_Malloc(sizeof(StaticEventGroup_t));
+
+    return (Memory != NULL) ? xEventGroupCreateStatic(Memory) : NULL;
+#else
+    return xEventGroupCreate();
+#endif
+}
+
+void Heap_EventGroupDelete(EventGroupHandle_t Handle)
+{
+    vEventGroupDelete(Handle);
+#if USE_TLSF_HEAP
+    TLSF_Free((void*)Handle);
+#endif
+}
+
+SemaphoreHandle_t Heap_SemaphoreCreateBinary(void)
+{
+#if USE_TLSF_HEAP
+    StaticSemaphore_t* Memory;
+
+    Memory = TLSF_Malloc(sizeof(StaticSemaphore_t));
+
+    return (Memory != NULL) ? xSemaphoreCreateBinaryStatic(Memory) : NULL;
+#else
+    return xSemaphoreCreateBinary();
+#endif
+}
+
+void Heap_SemaphoreDelete(SemaphoreHandle_t Handle)
+{
+    vSemaphoreDelete(Handle);
+#if USE_TLSF_HEAP
+    TLSF_Free((void*)Handle);
+#endif
+}
+
+/*Tasks created here are never deleted by this example, deleting them needs the idle task to be done with the TCB first*/
+BaseType_t Heap_TaskCreate(TaskFunction_t Function, const char* Name, uint32_t StackDepth, void* Parameters,
+                           UBaseType_t Priority, TaskHandle_t* Handle)
+{
+#if USE_TLSF_HEAP
+    uint8_t* Memory;
+    TaskHandle_t Created = NULL;
+
+    Memory = TLSF_Malloc(TLSF_OBJECT_OFFSET(StaticTask_t) + StackDepth);
+
+    if(Memory != NULL)
+    {
+        Created = xTaskCreateStatic(Function,Name,StackDepth,Parameters,Priority,
+                                    (StackType_t*)(Memory + TLSF_OBJECT_OFFSET(StaticTask_t)),(StaticTask_t*)Memory);
+    }
+
+    if(Handle != NULL)
+    {
+        *Handle = Created;
+    }
+
+    return (Created != NULL) ? pdPASS : pdFAIL;
+#else
+    return xTaskCreate(Function,Name,StackDepth,Parameters,Priority,Handle);
+#endif
+}
+
+/*---------------------------------------------- Allocation trace replay ----------------------------------------------*/
+
+/*Sizes seen when the examples of this repository create their objects (control block plus storage)*/
+static const uint16_t Trace_Sizes[] = {
+                                        84 + (5 * sizeof(int32_t)),     /*Queue of five integers*/
+                                        84 + (3 * 8),                   /*Queue of three structures*/
+                                        84 + (10 * sizeof(char*)),      /*Queue of ten string pointers*/
+                                        84,                             /*Semaphore or mutex*/
+                                        32,                             /*Event group*/
+                                        44,                             /*Software timer*/
+                                        TRACE_LARGEST_SIZE,             /*Task control block plus stack*/
+                                        350 + 1000                      /*Task with the smaller stack*/
+                                      };
+
+/*Every slot holding the largest block (rounded up to the next second level class) has to fit, otherwise TLSF fails where the stock heap does not*/
+_Static_assert((TRACE_SLOTS * (TRACE_LARGEST_SIZE + (TRACE_LARGEST_SIZE / TLSF_SL_COUNT) + TLSF_HEADER_SIZE)) <= TLSF_POOL_SIZE,
+               "Allocation trace does not fit in the TLSF pool");
+
+typedef struct
+{
+    uint32_t Operations;
+    uint32_t Failures;
+    uint32_t TotalCycles;
+    uint32_t WorstCycles;
+}TraceResult_t;
+
+static void* Trace_MallocTlsf(size_t Size)   { return TLSF_Malloc(Size); }
+static void  Trace_FreeTlsf(void* Ptr)       { TLSF_Free(Ptr); }
+static void* Trace_MallocStock(size_t Size)  { return heap_caps_malloc(Size,MALLOC_CAP_8BIT); }
+static void  Trace_FreeStock(void* Ptr)      { heap_caps_free(Ptr); }
+
+/*Replays a pseudo random but repeatable sequence of creates and deletes, so both the heaps see the exact same trace.
+  The blocks which are still held at the end are left in Slots so the heap can be measured before they are released*/
+static void Trace_Replay(void* (*Malloc)(size_t), void (*Free)(void*), void** Slots, TraceResult_t* Result)
+{
+    uint32_t Seed = 0x1234567, Loop, Slot, Start, Cycles;
+
+    memset(Slots,0,(TRACE_SLOTS * sizeof(void*)));
+    memset(Result,0,sizeof(TraceResult_t));
+
+    for(Loop = 0; Loop < TRACE_OPERATIONS; Loop++)
+    {
+        Seed = (Seed * 1103515245) + 12345;
+        Slot = (Seed >> 16) % TRACE_SLOTS;
+
+        Start = XTHAL_GET_CCOUNT();
+
+        if(Slots[Slot] == NULL)
+        {
+            Slots[Slot] = Malloc(Trace_Sizes[(Seed >> 8) % (sizeof(Trace_Sizes) / sizeof(Trace_Sizes[0]))]);
+
+            if(Slots[Slot] == NULL)
+            {
+                Result->Failures++;
+            }
+        }
+        else
+        {
+            Free(Slots[Slot]);
+            Slots[Slot] = NULL;
+        }
+
+        Cycles = XTHAL_GET_CCOUNT() - Start;
+
+        Result->Operations++;
+        Result->TotalCycles += Cycles;
+
+        if(Cycles > Result->WorstCycles)
+        {
+            Result->WorstCycles = Cycles;
+        }
+    }
+}
+
+/*Releasing the blocks which are still held so the trace does not leak into the application*/
+static void Trace_Release(void (*Free)(void*), void** Slots)
+{
+    uint32_t Slot;
+
+    for(Slot = 0; Slot < TRACE_SLOTS; Slot++)
+    {
+        if(Slots[Slot] != NULL)
+        {
+            Free(Slots[Slot]);
+            Slots[Slot] = NULL;
+        }
+    }
+}
+
+static void Trace_Benchmark(void)
+{
+    void* Slots[TRACE_SLOTS];
+    TraceResult_t Tlsf_Result, Stock_Result;
+    TlsfStats_t Before, After;
+    multi_heap_info_t Baseline, Info;
+
+    //Both the heaps are measured while the blocks of the trace are still held, and against the state before the replay
+    TLSF_GetStats(&Before);
+    Trace_Replay(Trace_MallocTlsf,Trace_FreeTlsf,Slots,&Tlsf_Result);
+    TLSF_GetStats(&After);
+    Trace_Release(Trace_FreeTlsf,Slots);
+
+    heap_caps_get_info(&Baseline,MALLOC_CAP_8BIT);
+    Trace_Replay(Trace_MallocStock,Trace_FreeStock,Slots,&Stock_Result);
+    heap_caps_get_info(&Info,MALLOC_CAP_8BIT);
+    Trace_Release(Trace_FreeStock,Slots);
+
+    //Held bytes include the block headers, and the largest block drop shows how much the trace split the biggest free region
+    printf("Trace on TLSF heap : %u ops avg %u cycles worst %u cycles failed %u (stock failed %u)\r\n",
+           Tlsf_Result.Operations,(Tlsf_Result.TotalCycles / Tlsf_Result.Operations),Tlsf_Result.WorstCycles,
+           Tlsf_Result.Failures,Stock_Result.Failures);
+    printf("                     held %u bytes, largest free block shrank by %u, fragmentation %u%%\r\n",
+           (Before.FreeBytes - After.FreeBytes),(Before.LargestFreeBlock - After.LargestFreeBlock),After.FragmentationIndex);
+
+    printf("Trace on stock heap: %u ops avg %u cycles worst %u cycles failed %u (TLSF failed %u)\r\n",
+           Stock_Result.Operations,(Stock_Result.TotalCycles / Stock_Result.Operations),Stock_Result.WorstCycles,
+           Stock_Result.Failures,Tlsf_Result.Failures);
+    printf("                     held %u bytes, largest free block shrank by %u\r\n",
+           (Baseline.total_free_bytes - Info.total_free_bytes),(Baseline.largest_free_block - Info.largest_free_block));
+}
+
+/*---------------------------------------------- Example tasks ----------------------------------------------*/
+
+static void Churn_Task(void* pvParameters)
+{
+    QueueHandle_t Queue;
+    EventGroupHandle_t EventGroup;
+    SemaphoreHandle_t Semaphore;
+    int32_t Value = 0;
+
+    for(;;)
+    {
+        //Creating and deleting the objects repeatedly the way short lived objects are handled in an application
+        Queue = Heap_QueueCreate(((rand() % 8) + 1),sizeof(int32_t));
+        EventGroup = Heap_EventGroupCreate();
+        Semaphore = Heap_SemaphoreCreateBinary();
+
+        if((Queue != NULL) && (EventGroup != NULL) && (Semaphore != NULL))
+        {
+            xQueueSendToBack(Queue,&Value,0);
+            xEventGroupSetBits(EventGroup,(1 << 0));
+            xSemaphoreGive(Semaphore);
+            Value++;
+        }
+        else
+        {
+            ESP_LOGE(RTOS,"Object creation failed!\r\n");
+        }
+
+        if(Queue != NULL)
+        {
+            Heap_QueueDelete(Queue);
+        }
+        if(EventGroup != NULL)
+        {
+            Heap_EventGroupDelete(EventGroup);
+        }
+        if(Semaphore != NULL)
+        {
+            Heap_SemaphoreDelete(Semaphore);
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+}
+
+static void Stats_Task(void* pvParameters)
+{
+    for(;;)
+    {
+        vTaskDelay(STATS_PERIOD);
+        TLSF_PrintStats();
+    }
+}
+
+void app_main(void)
+{
+    TLSF_Init(Tlsf_Pool,sizeof(Tlsf_Pool));
+
+    //Both the heaps are measured with the same trace before the application tasks start using them
+    Trace_Benchmark();
+    TLSF_PrintStats();
+
+    Heap_TaskCreate(Churn_Task,"Churn",2048,NULL,1,NULL);
+    Heap_TaskCreate(Stats_Task,"Stats",2048,NULL,2,NULL);
+}
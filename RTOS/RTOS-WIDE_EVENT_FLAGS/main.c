@@ -0,0 +1,543 @@
+/**
+ * @file main.c
+ * @author Tushar Uttekar
+ *
+ * @brief
+ *
+ * This example demonstrates a wide event flag object which can be used in place of the EventGroup when more than 24 events
+ * have to be coordinated, as in example 22 and example 23 the event group is limited to 24 usable bits.
+ *
+ * The width of the object is set with WIDE_FLAG_BITS (128 bits here) and it supports the same operations as the event group:
+ * ->Waiting for any (OR) or all (AND) of the requested bits with a timeout.
+ * ->Clearing the waited bits when the wait is satisfied (clear on exit).
+ * ->Setting the bits from a task as well as from an ISR.
+ *
+ * The difference from xEventGroupSetBits is how the waiting task's are found on a set. The event group walks every waiting task
+ * to test its condition, here the bits are divided in buckets of 8 bits and every waiting task is linked only in the buckets in
+ * which it is waiting for a bit. So a set only visits the waiting task's of the buckets it touches and the other waiters are
+ * never looked at, which keeps the set cost independent of the total number of waiting task's.
+ *
+ * The waiting task blocks on its own task notification, which is given by the setter once its condition is satisfied.
+ *
+ * In the example 100 subsystem task's report their bit, a supervisor waits for all of them, an ISR sets an alarm bit above the
+ * 24 bit limit and a monitor waits for either the alarm bit or the supervisor's cycle bit.
+ *
+ * NOTE : The waiting task's notification value is used for blocking, so it should not be used for any other purpose by a task
+ *        which waits on a wide event flag object.
+ *
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/portmacro.h"
+#include "freertos/xtensa_api.h"
+#include "xtensa/core-macros.h"
+#include "esp_intr_alloc.h"
+#include "esp_log.h"
+#include "esp_system.h"
+
+#define RTOS                    "freertos"
+#define SW_ISR_LEVEL_3          29
+
+#define WIDE_FLAG_BITS          128
+#define WIDE_FLAG_WORDS         (WIDE_FLAG_BITS / 32)
+#define WIDE_FLAG_BUCKET_BITS   8
+#define WIDE_FLAG_BUCKET_MASK   ((1U << WIDE_FLAG_BUCKET_BITS) - 1)
+#define WIDE_FLAG_BUCKETS       (WIDE_FLAG_BITS / WIDE_FLAG_BUCKET_BITS)
+#define WIDE_FLAG_PER_WORD      (32 / WIDE_FLAG_BUCKET_BITS)
+#define WIDE_FLAG_MAX_WAITERS   16
+
+#define SUBSYSTEM_COUNT         100
+#define ALARM_BIT               100
+#define CYCLE_BIT               101
+
+typedef struct
+{
+    uint32_t Word[WIDE_FLAG_WORDS];
+}WideBits_t;
+
+struct WideWaiter;
+
+/*One node for every bucket so that a waiter can be linked in all the buckets it is waiting on at the same time*/
+typedef struct WideNode
+{
+    struct WideNode* Next;
+    struct WideNode* Prev;
+    struct WideWaiter* Waiter;
+}WideNode_t;
+
+/*Waiter lives on the stack of the waiting task for the duration of the wait*/
+typedef struct WideWaiter
+{
+    TaskHandle_t Task;
+    WideBits_t Mask;
+    WideBits_t Result;
+    BaseType_t WaitForAll;
+    BaseType_t ClearOnExit;
+    volatile BaseType_t Satisfied;
+    WideNode_t Nodes[WIDE_FLAG_BUCKETS];
+}WideWaiter_t;
+
+typedef struct
+{
+    WideBits_t Bits;
+    WideNode_t* Buckets[WIDE_FLAG_BUCKETS];
+    UBaseType_t Waiters;
+    uint32_t Sets;
+    uint32_t WaitersChecked;
+    portMUX_TYPE Lock;
+}WideFlags_t;
+
+/*---------------------------------------------- Bit helpers ----------------------------------------------*/
+
+void WideBits_Zero(WideBits_t* Bits)
+{
+    memset(Bits,0,sizeof(WideBits_t));
+}
+
+void WideBits_Add(WideBits_t* Bits, uint32_t Bit)
+{
+    Bits->Word[Bit / 32] |= (1U << (Bit % 32));
+}
+
+BaseType_t WideBits_Test(const WideBits_t* Bits, uint32_t Bit)
+{
+    return ((Bits->Word[Bit / 32] & (1U << (Bit % 32))) != 0) ? pdTRUE : pdFALSE;
+}
+
+static inline uint32_t WideBits_Bucket(const WideBits_t* Bits, uint32_t Bucket)
+{
+    return (Bits->Word[Bucket / WIDE_FLAG_PER_WORD] >> ((Bucket % WIDE_FLAG_PER_WORD) * WIDE_FLAG_BUCKET_BITS)) & WIDE_FLAG_BUCKET_MASK;
+}
+
+/*---------------------------------------------- Wide event flags ----------------------------------------------*/
+
+void WideFlags_Init(WideFlags_t* Flags)
+{
+    memset(Flags,0,sizeof(WideFlags_t));
+    vPortCPUInitializeMutex(&Flags->Lock);
+}
+
+static BaseType_t WideFlags_ConditionMet(const WideFlags_t* Flags, const WideWaiter_t* Waiter)
+{
+    uint32_t Word, Match = 0, Missing = 0;
+
+    for(Word = 0; Word < WIDE_FLAG_WORDS; Word++)
+    {
+        Match |= (Flags->Bits.Word[Word] & Waiter->Mask.Word[Word]);
+        Missing |= (Waiter->Mask.Word[Word] & ~Flags->Bits.Word[Word]);
+    }
+
+    if(Waiter->WaitForAll == pdTRUE)
+    {
+        return (Missing == 0) ? pdTRUE : pdFALSE;
+    }
+
+    return (Match != 0) ? pdTRUE : pdFALSE;
+}
+
+static void WideFlags_Link(WideFlags_t* Flags, WideWaiter_t* Waiter)
+{
+    uint32_t Bucket;
+    WideNode_t* Node;
+
+    for(Bucket = 0; Bucket < WIDE_FLAG_BUCKETS; Bucket++)
+    {
+        Node = &Waiter->Nodes[Bucket];
+        Node->Waiter = Waiter;
+        Node->Prev = NULL;
+        Node->Next = NULL;
+
+        //Linking only in the buckets where the waiter is waiting on at least one bit
+        if(WideBits_Bucket(&Waiter->Mask,Bucket) != 0)
+        {
+            Node->Next = Flags->Buckets[Bucket];
+            if(Node->Next != NULL)
+            {
+                Node->Next->Prev = Node;
+            }
+            Flags->Buckets[Bucket] = Node;
+        }
+    }
+}
+
+static void WideFlags_Unlink(WideFlags_t* Flags, WideWaiter_t* Waiter)
+{
+    uint32_t Bucket;
+    WideNode_t* Node;
+
+    for(Bucket = 0; Bucket < WIDE_FLAG_BUCKETS; Bucket++)
+    {
+        if(WideBits_Bucket(&Waiter->Mask,Bucket) != 0)
+        {
+            Node = &Waiter->Nodes[Bucket];
+
+            if(Node->Prev != NULL)
+            {
+                Node->Prev->Next = Node->Next;
+            }
+            else
+            {
+                Flags->Buckets[Bucket] = Node->Next;
+            }
+
+            if(Node->Next != NULL)
+            {
+                Node->Next->Prev = Node->Prev;
+            }
+        }
+    }
+}
+
+/*Sets the bits and collects the task's whose condition is met, has to be called with the lock of the object taken*/
+static UBaseType_t WideFlags_SetLocked(WideFlags_t* Flags, const WideBits_t* SetBits, TaskHandle_t* Wake)
+{
+    WideBits_t ClearBits;
+    WideNode_t *Node, *Next;
+    WideWaiter_t* Waiter;
+    uint32_t Word, Bucket, Touched;
+    UBaseType_t WakeCount = 0;
+
+    WideBits_Zero(&ClearBits);
+
+    for(Word = 0; Word < WIDE_FLAG_WORDS; Word++)
+    {
+        Flags->Bits.Word[Word] |= SetBits->Word[Word];
+    }
+
+    Flags->Sets++;
+
+    for(Bucket = 0; Bucket < WIDE_FLAG_BUCKETS; Bucket++)
+    {
+        Touched = WideBits_Bucket(SetBits,Bucket);
+
+        //Buckets which are not touched by this set are skipped along with all the waiters linked in them
+        if(Touched == 0)
+        {
+            continue;
+        }
+
+        for(Node = Flags->Buckets[Bucket]; Node != NULL; Node = Next)
+        {
+            Next = Node->Next;
+            Waiter = Node->Waiter;
+
+            //Waiters of the same bucket but waiting on other bits of it are not evaluated
+            if((WideBits_Bucket(&Waiter->Mask,Bucket) & Touched) == 0)
+            {
+                continue;
+            }
+
+            Flags->WaitersChecked++;
+
+            if(WideFlags_ConditionMet(Flags,Waiter) == pdTRUE)
+            {
+                for(Word = 0; Word < WIDE_FLAG_WORDS; Word++)
+                {
+                    Waiter->Result.Word[Word] = Flags->Bits.Word[Word] & Waiter->Mask.Word[Word];
+
+                    if(Waiter->ClearOnExit == pdTRUE)
+                    {
+                        ClearBits.Word[Word] |= Waiter->Mask.Word[Word];
+                    }
+                }
+
+                //Unlinking from all the buckets, the next node is of another waiter so it stays valid
+                WideFlags_Unlink(Flags,Waiter);
+                Flags->Waiters--;
+
+                Wake[WakeCount++] = Waiter->Task;
+                Waiter->Satisfied = pdTRUE;
+            }
+        }
+    }
+
+    //Clearing is done once all the waiters have been evaluated so that every waiter sees the same set of bits
+    for(Word = 0; Word < WIDE_FLAG_WORDS; Word++)
+    {
+        Flags->Bits.Word[Word] &= ~ClearBits.Word[Word];
+    }
+
+    return WakeCount;
+}
+
+void WideFlags_Set(WideFlags_t* Flags, const WideBits_t* SetBits)
+{
+    TaskHandle_t Wake[WIDE_FLAG_MAX_WAITERS];
+    UBaseType_t WakeCount, Index;
+
+    portENTER_CRITICAL(&Flags->Lock);
+    WakeCount = WideFlags_SetLocked(Flags,SetBits,Wake);
+    portEXIT_CRITICAL(&Flags->Lock);
+
+    //Notifications are given outside the lock, the copied handles stay valid even if a waiter has already returned
+    for(Index = 0; Index < WakeCount; Index++)
+    {
+        xTaskNotifyGive(Wake[Index]);
+    }
+}
+
+/*Bounded by WIDE_FLAG_MAX_WAITERS, so the time spent in the interrupt does not depend on the application*/
+void WideFlags_SetFromISR(WideFlags_t* Flags, const WideBits_t* SetBits, BaseType_t* pxHigherPriorityTaskWoken)
+{
+    TaskHandle_t Wake[WIDE_FLAG_MAX_WAITERS];
+    UBaseType_t WakeCount, Index;
+
+    portENTER_CRITICAL_ISR(&Flags->Lock);
+    WakeCount = WideFlags_SetLocked(Flags,SetBits,Wake);
+    portEXIT_CRITICAL_ISR(&Flags->Lock);
+
+    for(Index = 0; Index < WakeCount; Index++)
+    {
+        vTaskNotifyGiveFromISR(Wake[Index],pxHigherPriorityTaskWoken);
+    }
+}
+
+void WideFlags_Clear(WideFlags_t* Flags, const WideBits_t* ClearBits)
+{
+    uint32_t Word;
+
+    portENTER_CRITICAL(&Flags->Lock);
+
+    for(Word = 0; Word < WIDE_FLAG_WORDS; Word++)
+    {
+        Flags->Bits.Word[Word] &= ~ClearBits->Word[Word];
+    }
+
+    portEXIT_CRITICAL(&Flags->Lock);
+}
+
+void WideFlags_Get(WideFlags_t* Flags, WideBits_t* Bits)
+{
+    portENTER_CRITICAL(&Flags->Lock);
+    *Bits = Flags->Bits;
+    portEXIT_CRITICAL(&Flags->Lock);
+}
+
+/**
+ * Waits for any or all of the bits in Mask to be set, Result receives the waited bits as they were when the condition was met.
+ * Returns pdPASS when the condition was met and pdFAIL on timeout or when too many task's are already waiting.
+ */
+BaseType_t WideFlags_Wait(WideFlags_t* Flags, const WideBits_t* Mask, BaseType_t ClearOnExit, BaseType_t WaitForAll,
+                          WideBits_t* Result, TickType_t Timeout)
+{
+    WideWaiter_t Waiter;
+    TimeOut_t TimeOut;
+    uint32_t Word;
+    BaseType_t xStatus = pdFAIL;
+
+    Waiter.Task = xTaskGetCurrentTaskHandle();
+    Waiter.Mask = *Mask;
+    Waiter.WaitForAll = WaitForAll;
+    Waiter.ClearOnExit = ClearOnExit;
+    Waiter.Satisfied = pdFALSE;
+
+    //Clearing a notification left over from an earlier wait so that it does not cut this wait short
+    ulTaskNotifyTake(pdTRUE,0);
+
+    portENTER_CRITICAL(&Flags->Lock);
+
+    //Checking whether the condition is already met before blocking
+    if(WideFlags_ConditionMet(Flags,&Waiter) == pdTRUE)
+    {
+        for(Word = 0; Word < WIDE_FLAG_WORDS; Word++)
+        {
+            Result->Word[Word] = Flags->Bits.Word[Word] & Mask->Word[Word];
+
+            if(ClearOnExit == pdTRUE)
+            {
+                Flags->Bits.Word[Word] &= ~Mask->Word[Word];
+            }
+        }
+
+        portEXIT_CRITICAL(&Flags->Lock);
+        return pdPASS;
+    }
+
+    if((Timeout == 0) || (Flags->Waiters >= WIDE_FLAG_MAX_WAITERS))
+    {
+        for(Word = 0; Word < WIDE_FLAG_WORDS; Word++)
+        {
+            Result->Word[Word] = Flags->Bits.Word[Word] & Mask->Word[Word];
+        }
+
+        portEXIT_CRITICAL(&Flags->Lock);
+        return pdFAIL;
+    }
+
+    WideFlags_Link(Flags,&Waiter);
+    Flags->Waiters++;
+
+    portEXIT_CRITICAL(&Flags->Lock);
+
+    vTaskSetTimeOutState(&TimeOut);
+
+    for(;;)
+    {
+        ulTaskNotifyTake(pdTRUE,Timeout);
+
+        portENTER_CRITICAL(&Flags->Lock);
+
+        if(Waiter.Satisfied == pdTRUE)
+        {
+            *Result = Waiter.Result;
+            xStatus = pdPASS;
+            portEXIT_CRITICAL(&Flags->Lock);
+            break;
+        }
+
+        //Timed out without the condition being met, the waiter is removed before its stack frame goes away
+        if(xTaskCheckForTimeOut(&TimeOut,&Timeout) == pdTRUE)
+        {
+            WideFlags_Unlink(Flags,&Waiter);
+            Flags->Waiters--;
+
+            for(Word = 0; Word < WIDE_FLAG_WORDS; Word++)
+            {
+                Result->Word[Word] = Flags->Bits.Word[Word] & Mask->Word[Word];
+            }
+
+            portEXIT_CRITICAL(&Flags->Lock);
+            break;
+        }
+
+        portEXIT_CRITICAL(&Flags->Lock);
+    }
+
+    return xStatus;
+}
+
+/*---------------------------------------------- Example tasks ----------------------------------------------*/
+
+WideFlags_t SystemFlags;
+
+static void Subsystem_Task(void* pvParameters)
+{
+    uint32_t FirstBit, Bit;
+    WideBits_t Report;
+
+    //Every task instance reports for ten subsystems so that the example does not need 100 stacks
+    FirstBit = (uint32_t) pvParameters;
+
+    for(;;)
+    {
+        for(Bit = FirstBit; Bit < (FirstBit + 10); Bit++)
+        {
+            vTaskDelay((rand() % 0x10) + 1);
+
+            WideBits_Zero(&Report);
+            WideBits_Add(&Report,Bit);
+            WideFlags_Set(&SystemFlags,&Report);
+        }
+    }
+}
+
+static void Supervisor_Task(void* pvParameters)
+{
+    WideBits_t AllSubsystems, Cycle, Result;
+    uint32_t Bit, CycleCount = 0;
+
+    WideBits_Zero(&AllSubsystems);
+    for(Bit = 0; Bit < SUBSYSTEM_COUNT; Bit++)
+    {
+        WideBits_Add(&AllSubsystems,Bit);
+    }
+
+    WideBits_Zero(&Cycle);
+    WideBits_Add(&Cycle,CYCLE_BIT);
+
+    for(;;)
+    {
+        //Waiting for all the subsystems to report and clearing their bits for the next cycle
+        if(WideFlags_Wait(&SystemFlags,&AllSubsystems,pdTRUE,pdTRUE,&Result,pdMS_TO_TICKS(2000)) == pdPASS)
+        {
+            CycleCount++;
+            ESP_LOGI(RTOS,"All %d subsystems reported, cycle %u (sets %u waiters checked %u)\r\n",
+                     SUBSYSTEM_COUNT,CycleCount,SystemFlags.Sets,SystemFlags.WaitersChecked);
+
+            WideFlags_Set(&SystemFlags,&Cycle);
+        }
+        else
+        {
+            ESP_LOGW(RTOS,"Subsystems did not report in time!\r\n");
+        }
+    }
+}
+
+static void Monitor_Task(void* pvParameters)
+{
+    WideBits_t Mask, Result;
+
+    WideBits_Zero(&Mask);
+    WideBits_Add(&Mask,ALARM_BIT);
+    WideBits_Add(&Mask,CYCLE_BIT);
+
+    for(;;)
+    {
+        //Waiting for either of the bits which are above the 24 bit limit of the event group
+        WideFlags_Wait(&SystemFlags,&Mask,pdTRUE,pdFALSE,&Result,portMAX_DELAY);
+
+        if(WideBits_Test(&Result,ALARM_BIT) == pdTRUE)
+        {
+            printf("Alarm bit was set-\t From the ISR routine.\r\n");
+        }
+        if(WideBits_Test(&Result,CYCLE_BIT) == pdTRUE)
+        {
+            printf("Cycle bit was set-\t From the supervisor task.\r\n");
+        }
+    }
+}
+
+static void Interrupt_Generator(void* pvParameters)
+{
+    for(;;)
+    {
+        vTaskDelay(pdMS_TO_TICKS(700));
+        xt_set_intset(1 << SW_ISR_LEVEL_3);
+    }
+}
+
+static void Interrupt_Handler(void* arg)
+{
+    BaseType_t xHigherPriorityTaskWoken;
+    WideBits_t Alarm;
+
+    xt_set_intclear(1 << SW_ISR_LEVEL_3);
+
+    //Setting the variable to FALSE for the first time when interrupt occurs as it will TRUE if context switch is required
+    xHigherPriorityTaskWoken = pdFALSE;
+
+    WideBits_Zero(&Alarm);
+    WideBits_Add(&Alarm,ALARM_BIT);
+    WideFlags_SetFromISR(&SystemFlags,&Alarm,&xHigherPriorityTaskWoken);
+
+    //To Switch context to the higher priority task for deferring work to be done
+    portYIELD_FROM_ISR();
+}
+
+void app_main(void)
+{
+    uint32_t FirstBit;
+
+    WideFlags_Init(&SystemFlags);
+
+    xTaskCreate(Supervisor_Task,"Supervisor",3072,NULL,3,NULL);
+    xTaskCreate(Monitor_Task,"Monitor",3072,NULL,2,NULL);
+
+    for(FirstBit = 0; FirstBit < SUBSYSTEM_COUNT; FirstBit += 10)
+    {
+        xTaskCreate(Subsystem_Task,"Subsystem",2048,(void*)FirstBit,1,NULL);
+    }
+
+    xTaskCreate(Interrupt_Generator,"Interrupt_Trigger",2048,NULL,4,NULL);
+
+    //Setting up interrupt handler based on the xtensa port function
+    esp_intr_alloc(ETS_INTERNAL_SW1_INTR_SOURCE,0,Interrupt_Handler,NULL,NULL);
+}